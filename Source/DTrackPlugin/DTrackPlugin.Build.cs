@@ -62,7 +62,10 @@ namespace UnrealBuildTool.Rules
 			PrivateDependencyModuleNames.AddRange(
 				new string[]
 				{
-					"InputCore"
+					"InputCore",
+					"Json",
+					"Sockets",
+					"Networking"
 					// ... add private dependencies that you statically link with here ...
 				}
 				);
@@ -81,6 +84,9 @@ namespace UnrealBuildTool.Rules
         {
             bool isLibrarySupported = false;
 
+            // Include path, needed on every platform the module builds for
+            PublicIncludePaths.Add(Path.Combine(ThirdPartyPath, "DTrackSDK", "Include"));
+
             if ((Target.Platform == UnrealTargetPlatform.Win64)) // only 64bit is supported
             {
                 isLibrarySupported = true;
@@ -89,11 +95,22 @@ namespace UnrealBuildTool.Rules
 
                 PublicAdditionalLibraries.Add(Path.Combine(LibrariesPath, "dtrack_sdk.lib"));          
             }
-
-            if (isLibrarySupported)
+            else if (Target.Platform == UnrealTargetPlatform.Linux)
             {
-                // Include path
-                PublicIncludePaths.Add(Path.Combine(ThirdPartyPath, "DTrackSDK", "Include"));
+                // The SDK only ships for Windows. For headless replays on Linux, 
+                // build it from source and put the static library here.
+                string LinuxLibrary = Path.Combine(ThirdPartyPath, "DTrackSDK", "Lib", "Linux", "libdtrack_sdk.a");
+
+                if (File.Exists(LinuxLibrary))
+                {
+                    isLibrarySupported = true;
+                    PublicAdditionalLibraries.Add(LinuxLibrary);
+                }
+                else
+                {
+                    throw new BuildException("DTrack SDK for Linux not found at " + LinuxLibrary + 
+                        ". Build the SDK from source and put the static library there.");
+                }
             }
 
             return isLibrarySupported;
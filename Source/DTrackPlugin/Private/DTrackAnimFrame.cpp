@@ -0,0 +1,93 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackAnimFrame.h"
+#include "Misc/ScopeLock.h"
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+// all channels there are, by endpoint
+static FCriticalSection s_channels_mutex;
+static TMap< FString, TSharedRef<FDTrackAnimChannel, ESPMode::ThreadSafe> > s_channels;
+
+TSharedRef<FDTrackAnimChannel, ESPMode::ThreadSafe> FDTrackAnimChannel::get(const FString &n_endpoint) {
+
+	FScopeLock lock(&s_channels_mutex);
+	TSharedRef<FDTrackAnimChannel, ESPMode::ThreadSafe> *ret = s_channels.Find(n_endpoint);
+	if (ret) {
+		return *ret;
+	}
+
+	TSharedRef<FDTrackAnimChannel, ESPMode::ThreadSafe> channel = MakeShareable(new FDTrackAnimChannel());
+	channel->m_default = n_endpoint.IsEmpty();
+	s_channels.Add(n_endpoint, channel);
+	return channel;
+}
+
+void FDTrackAnimChannel::reset_all() {
+
+	FScopeLock lock(&s_channels_mutex);
+	s_channels.Empty();
+}
+
+TSharedPtr<const FDTrackAnimFrame, ESPMode::ThreadSafe> FDTrackAnimChannel::latest() const {
+
+	m_last_read = FPlatformTime::Seconds();
+
+	FScopeLock lock(&m_mutex);
+	return m_latest;
+}
+
+bool FDTrackAnimChannel::wanted() const {
+
+	const double last_read = m_last_read;
+	return (last_read >= 0.0) && ((FPlatformTime::Seconds() - last_read) < 1.0);
+}
+
+void FDTrackAnimChannel::publish(const FString &n_endpoint, const TSharedRef<const FDTrackAnimFrame, ESPMode::ThreadSafe> &n_frame) {
+
+	FScopeLock lock(&m_mutex);
+	if (m_default) {
+		if (m_owner.IsEmpty()) {
+			m_owner = n_endpoint;
+		} else if (m_owner != n_endpoint) {
+			return;
+		}
+	}
+
+	m_latest = n_frame;
+}
+
+void FDTrackAnimChannel::release(const FString &n_endpoint) {
+
+	FScopeLock lock(&m_mutex);
+	if (!m_default || (m_owner == n_endpoint)) {
+		m_owner.Empty();
+		m_latest.Reset();
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
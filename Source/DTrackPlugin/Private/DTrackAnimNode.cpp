@@ -0,0 +1,260 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackAnimNode.h"
+#include "IDTrackPlugin.h"
+#include "Animation/AnimInstanceProxy.h"
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+void FAnimNode_DTrackHuman::Initialize_AnyThread(const FAnimationInitializeContext &Context) {
+
+	FAnimNode_Base::Initialize_AnyThread(Context);
+	m_source.Initialize(Context);
+
+	m_channel = FDTrackAnimChannel::get(m_endpoint);
+	m_frame.Reset();
+}
+
+void FAnimNode_DTrackHuman::CacheBones_AnyThread(const FAnimationCacheBonesContext &Context) {
+
+	m_source.CacheBones(Context);
+
+	const FBoneContainer &required_bones = Context.AnimInstanceProxy->GetRequiredBones();
+
+	m_resolved.Reset();
+	int32 max_joint_id = INDEX_NONE;
+	for (FDTrackJointBinding &binding : m_joints) {
+		binding.m_bone.Initialize(required_bones);
+		if (!binding.m_bone.IsValidToEvaluate(required_bones) || (binding.m_joint_id < 0)) {
+			continue;
+		}
+
+		Resolved resolved;
+		resolved.m_bone = binding.m_bone.GetCompactPoseIndex(required_bones);
+		resolved.m_joint = binding.m_joint_id;
+		resolved.m_offset = binding.m_rotation_offset.Quaternion();
+		resolved.m_apply_location = binding.m_apply_location;
+
+		// one joint may drive several bones, but a bone takes one joint
+		const Resolved *bound = m_resolved.FindByPredicate([&resolved](const Resolved &n_other) {
+			return n_other.m_bone == resolved.m_bone;
+		});
+		if (bound) {
+			UE_LOG(DTrackPluginLog, Warning, TEXT("DTrack human model node binds bone %s to joints %d and %d. Only joint %d drives it"),
+				*binding.m_bone.BoneName.ToString(), bound->m_joint, binding.m_joint_id, bound->m_joint);
+			continue;
+		}
+
+		m_resolved.Add(resolved);
+		max_joint_id = FMath::Max(max_joint_id, binding.m_joint_id);
+	}
+
+	// parents before children, as component space poses want them
+	m_resolved.Sort([](const Resolved &n_a, const Resolved &n_b) {
+		return n_a.m_bone < n_b.m_bone;
+	});
+
+	m_slot_by_joint.Init(INDEX_NONE, max_joint_id + 1);
+	m_bone_transforms.Reset(m_resolved.Num());
+}
+
+void FAnimNode_DTrackHuman::Update_AnyThread(const FAnimationUpdateContext &Context) {
+
+	m_source.Update(Context);
+	EvaluateGraphExposedInputs.Execute(Context);
+
+	// the newest there is, evaluate uses the same one
+	if (m_channel.IsValid()) {
+		m_frame = m_channel->latest();
+	}
+}
+
+void FAnimNode_DTrackHuman::Evaluate_AnyThread(FPoseContext &Output) {
+
+	m_source.Evaluate(Output);
+
+	if (!m_frame.IsValid() || !m_resolved.Num() || (m_human_id < 0) || (m_human_id >= m_frame->num_humans())) {
+		return;
+	}
+
+	// where in the frame each bound joint is
+	for (int32 &slot : m_slot_by_joint) {
+		slot = INDEX_NONE;
+	}
+
+	const int32 first = m_frame->m_human_first_joint[m_human_id];
+	const int32 last = m_frame->m_human_first_joint[m_human_id + 1];
+	for (int32 j = first; j < last; j++) {
+		const int32 joint_id = m_frame->m_joint_ids[j];
+		if (m_slot_by_joint.IsValidIndex(joint_id)) {
+			m_slot_by_joint[joint_id] = j;
+		}
+	}
+
+	FCSPose<FCompactPose> component_pose;
+	component_pose.InitPose(Output.Pose);
+
+	m_bone_transforms.Reset();
+	const FQuat tracking_rotation = m_tracking_to_component.GetRotation();
+	for (const Resolved &resolved : m_resolved) {
+		const int32 slot = m_slot_by_joint[resolved.m_joint];
+		if (slot == INDEX_NONE) {
+			continue;
+		}
+
+		FTransform transform = component_pose.GetComponentSpaceTransform(resolved.m_bone);
+		transform.SetRotation(tracking_rotation * m_frame->m_joint_rotations[slot] * resolved.m_offset);
+		if (resolved.m_apply_location) {
+			transform.SetLocation(m_tracking_to_component.TransformPosition(m_frame->m_joint_locations[slot]));
+		}
+
+		m_bone_transforms.Add(FBoneTransform(resolved.m_bone, transform));
+	}
+
+	if (m_bone_transforms.Num()) {
+		component_pose.SafeSetCSBoneTransforms(m_bone_transforms);
+		FCSPose<FCompactPose>::ConvertComponentPosesToLocalPoses(component_pose, Output.Pose);
+	}
+}
+
+void FAnimNode_DTrackHuman::GatherDebugData(FNodeDebugData &DebugData) {
+
+	FString debug_line = DebugData.GetNodeName(this);
+	debug_line += FString::Printf(TEXT("(Human: %d, Frame: %u)"), m_human_id, m_frame.IsValid() ? m_frame->m_frame_counter : 0u);
+	DebugData.AddDebugItem(debug_line);
+
+	m_source.GatherDebugData(DebugData);
+}
+
+void FAnimNode_DTrackHand::Initialize_AnyThread(const FAnimationInitializeContext &Context) {
+
+	FAnimNode_Base::Initialize_AnyThread(Context);
+	m_source.Initialize(Context);
+
+	m_channel = FDTrackAnimChannel::get(m_endpoint);
+	m_frame.Reset();
+}
+
+void FAnimNode_DTrackHand::CacheBones_AnyThread(const FAnimationCacheBonesContext &Context) {
+
+	m_source.CacheBones(Context);
+
+	const FBoneContainer &required_bones = Context.AnimInstanceProxy->GetRequiredBones();
+
+	m_resolved.Reset();
+	auto add = [&](FBoneReference &n_bone, const int32 n_joint, const FRotator &n_offset, const bool n_apply_location) {
+		n_bone.Initialize(required_bones);
+		if (n_bone.IsValidToEvaluate(required_bones)) {
+			Resolved resolved;
+			resolved.m_bone = n_bone.GetCompactPoseIndex(required_bones);
+			resolved.m_joint = n_joint;
+			resolved.m_offset = n_offset.Quaternion();
+			resolved.m_apply_location = n_apply_location;
+			m_resolved.Add(resolved);
+		}
+	};
+
+	add(m_wrist, INDEX_NONE, m_wrist_rotation_offset, m_apply_wrist_location);
+	for (FDTrackFingerBinding &finger : m_fingers) {
+		// each bone turns at the joint its phalanx starts from
+		const int32 first = static_cast<int32>(finger.m_finger) * FDTrackAnimFrame::JointsPerFinger;
+		add(finger.m_inner, first, finger.m_rotation_offset, m_apply_finger_locations);
+		add(finger.m_middle, first + 1, finger.m_rotation_offset, m_apply_finger_locations);
+		add(finger.m_outer, first + 2, finger.m_rotation_offset, m_apply_finger_locations);
+	}
+
+	// parents before children, as component space poses want them
+	m_resolved.Sort([](const Resolved &n_a, const Resolved &n_b) {
+		return n_a.m_bone < n_b.m_bone;
+	});
+
+	m_bone_transforms.Reset(m_resolved.Num());
+}
+
+void FAnimNode_DTrackHand::Update_AnyThread(const FAnimationUpdateContext &Context) {
+
+	m_source.Update(Context);
+	EvaluateGraphExposedInputs.Execute(Context);
+
+	if (m_channel.IsValid()) {
+		m_frame = m_channel->latest();
+	}
+}
+
+void FAnimNode_DTrackHand::Evaluate_AnyThread(FPoseContext &Output) {
+
+	m_source.Evaluate(Output);
+
+	if (!m_frame.IsValid() || !m_resolved.Num() || (m_hand_id < 0) || (m_hand_id >= m_frame->num_hands())) {
+		return;
+	}
+
+	// lost hands keep the source pose
+	const int32 num_fingers = m_frame->m_hand_fingers[m_hand_id];
+	if (!num_fingers) {
+		return;
+	}
+
+	const FTransform hand = m_frame->m_hand_transforms[m_hand_id] * m_tracking_to_component;
+	const int32 first_joint = m_hand_id * FDTrackAnimFrame::FingersPerHand * FDTrackAnimFrame::JointsPerFinger;
+
+	FCSPose<FCompactPose> component_pose;
+	component_pose.InitPose(Output.Pose);
+
+	m_bone_transforms.Reset();
+	for (const Resolved &resolved : m_resolved) {
+		if ((resolved.m_joint != INDEX_NONE) && ((resolved.m_joint / FDTrackAnimFrame::JointsPerFinger) >= num_fingers)) {
+			continue;
+		}
+
+		const FTransform joint = (resolved.m_joint == INDEX_NONE) ? hand : (m_frame->m_finger_joints[first_joint + resolved.m_joint] * hand);
+
+		FTransform transform = component_pose.GetComponentSpaceTransform(resolved.m_bone);
+		transform.SetRotation(joint.GetRotation() * resolved.m_offset);
+		if (resolved.m_apply_location) {
+			transform.SetLocation(joint.GetLocation());
+		}
+
+		m_bone_transforms.Add(FBoneTransform(resolved.m_bone, transform));
+	}
+
+	if (m_bone_transforms.Num()) {
+		component_pose.SafeSetCSBoneTransforms(m_bone_transforms);
+		FCSPose<FCompactPose>::ConvertComponentPosesToLocalPoses(component_pose, Output.Pose);
+	}
+}
+
+void FAnimNode_DTrackHand::GatherDebugData(FNodeDebugData &DebugData) {
+
+	FString debug_line = DebugData.GetNodeName(this);
+	debug_line += FString::Printf(TEXT("(Hand: %d, Frame: %u)"), m_hand_id, m_frame.IsValid() ? m_frame->m_frame_counter : 0u);
+	DebugData.AddDebugItem(debug_line);
+
+	m_source.GatherDebugData(DebugData);
+}
+
+#undef LOCTEXT_NAMESPACE
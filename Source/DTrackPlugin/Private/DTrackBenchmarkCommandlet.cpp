@@ -0,0 +1,496 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackBenchmarkCommandlet.h"
+
+#include "FDTrackPlugin.h"
+#include "DTrackSession.h"
+#include "DTrackPollThread.h"
+#include "DTrackDataSource.h"
+#include "DTrackComponent.h"
+
+#include "HAL/PlatformProcess.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Misc/Parse.h"
+#include "Misc/FileHelper.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+#include "UObject/Package.h"
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+namespace {
+
+/** @brief counts allocations, forwarding everything to the real allocator
+ *
+ *	Installed once when the benchmark starts and left in place for the rest of the 
+ *	process. Threads that still went through the allocator it wraps end up in the same 
+ *	allocator, so installing it while workers run is safe, taking it out again wouldn't be. 
+ *	The count is shared by all threads, so allocations of ParallelFor and the sink's 
+ *	graph tasks are counted along with the benchmark thread's.
+ */
+class FDTrackCountingMalloc : public FMalloc {
+
+	public:
+		explicit FDTrackCountingMalloc(FMalloc *n_inner)
+				: m_inner(n_inner) {
+		}
+
+		void *Malloc(SIZE_T n_size, uint32 n_alignment) override {
+
+			m_count.Increment();
+			return m_inner->Malloc(n_size, n_alignment);
+		}
+
+		void *Realloc(void *n_original, SIZE_T n_size, uint32 n_alignment) override {
+
+			// shrinking to nothing is a free
+			if (n_size) {
+				m_count.Increment();
+			}
+			return m_inner->Realloc(n_original, n_size, n_alignment);
+		}
+
+		void Free(void *n_original) override {
+
+			m_inner->Free(n_original);
+		}
+
+		SIZE_T QuantizeSize(SIZE_T n_size, uint32 n_alignment) override {
+
+			return m_inner->QuantizeSize(n_size, n_alignment);
+		}
+
+		bool GetAllocationSize(void *n_original, SIZE_T &n_size) override {
+
+			return m_inner->GetAllocationSize(n_original, n_size);
+		}
+
+		void Trim(bool n_trim_thread_caches) override {
+
+			m_inner->Trim(n_trim_thread_caches);
+		}
+
+		void SetupTLSCachesOnCurrentThread() override {
+
+			m_inner->SetupTLSCachesOnCurrentThread();
+		}
+
+		void ClearAndDisableTLSCachesOnCurrentThread() override {
+
+			m_inner->ClearAndDisableTLSCachesOnCurrentThread();
+		}
+
+		bool IsInternallyThreadSafe() const override {
+
+			return m_inner->IsInternallyThreadSafe();
+		}
+
+		bool ValidateHeap() override {
+
+			return m_inner->ValidateHeap();
+		}
+
+		const TCHAR *GetDescriptiveName() override {
+
+			return TEXT("DTrackCountingMalloc");
+		}
+
+		/// allocations on any thread since the last call
+		uint64 take() {
+
+			return static_cast<uint64>(m_count.Set(0));
+		}
+
+		/// wrap GMalloc unless that was done already. Never uninstalled
+		static FDTrackCountingMalloc &install() {
+
+			static FDTrackCountingMalloc *installed = nullptr;
+			if (!installed) {
+				installed = new FDTrackCountingMalloc(GMalloc);
+				GMalloc = installed;
+			}
+
+			return *installed;
+		}
+
+	private:
+		FMalloc              *m_inner;
+		FThreadSafeCounter64  m_count;
+};
+
+/// a workload and what we measured running it
+struct FDTrackBenchmarkResult {
+	FString         m_name;
+	FDTrackWorkload m_workload;
+	FString         m_filter;
+	int32           m_frames = 0;
+	double          m_datagram_bytes = 0.0;    //!< average per frame
+	double          m_parse_ns = 0.0;          //!< average per frame, all of them
+	double          m_convert_ns = 0.0;
+	double          m_publish_ns = 0.0;
+	double          m_dispatch_ns = 0.0;
+	double          m_total_ns = 0.0;
+	double          m_poll_allocations = 0.0;
+	double          m_dispatch_allocations = 0.0;
+	double          m_events = 0.0;            //!< interface calls per frame
+	bool            m_ok = false;
+};
+
+double cycles_to_ns(const uint64 n_cycles) {
+
+	return FPlatformTime::ToSeconds64(n_cycles) * 1000000000.0;
+}
+
+FString workload_name(const FDTrackWorkload &n_workload) {
+
+	return FString::Printf(TEXT("b%d_f%d_h%d_m%dx%d"), n_workload.m_bodies, n_workload.m_flysticks, 
+			n_workload.m_hands, n_workload.m_humans, n_workload.m_joints);
+}
+
+/// the smoothing filters we can benchmark, by the name they have on the command line
+struct FDTrackBenchmarkFilter {
+	const TCHAR      *m_name;
+	EDTrackSmoothing  m_type;
+};
+
+const FDTrackBenchmarkFilter BenchmarkFilters[] = {
+	{ TEXT("none"),    EDTrackSmoothing::SM_None },
+	{ TEXT("oneeuro"), EDTrackSmoothing::SM_OneEuro },
+	{ TEXT("kalman"),  EDTrackSmoothing::SM_Kalman }
+};
+
+/// filter all bodies, flysticks and hands the same way
+void set_filter(UDTrackComponent *n_component, const FDTrackBenchmarkFilter &n_filter) {
+
+	n_component->m_body_filter.m_type = n_filter.m_type;
+	n_component->m_flystick_filter.m_type = n_filter.m_type;
+	n_component->m_hand_filter.m_type = n_filter.m_type;
+}
+
+/// run one workload through the entire pipeline
+FDTrackBenchmarkResult run_workload(FDTrackPlugin &n_plugin, UDTrackComponent *n_component, ADTrackBenchmarkSink *n_sink,
+		const FDTrackWorkload &n_workload, const FDTrackBenchmarkFilter &n_filter, const int32 n_frames, const int32 n_warmup, 
+		FDTrackCountingMalloc &n_counting) {
+
+	FDTrackBenchmarkResult result;
+	result.m_name = workload_name(n_workload);
+	result.m_workload = n_workload;
+	result.m_filter = n_filter.m_name;
+
+	if (n_filter.m_type != EDTrackSmoothing::SM_None) {
+		result.m_name += TEXT("_");
+		result.m_name += n_filter.m_name;
+	}
+
+	set_filter(n_component, n_filter);
+
+	FDTrackSyntheticSource *source = new FDTrackSyntheticSource(n_workload);
+	result.m_datagram_bytes = source->average_size();
+
+	FDTrackSession *session = n_plugin.start_inline(n_component, source);
+	if (!session) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("DTrack benchmark cannot run while tracking is running"));
+		return result;
+	}
+
+	FDTrackPollThread *poll = session->poll_thread();
+
+	if (!poll->begin()) {
+		n_plugin.remove(n_component);
+		return result;
+	}
+
+	// let buffers grow to their size before measuring
+	const float delta_time = 1.0f / 60.0f;
+	for (int32 i = 0; i < n_warmup; i++) {
+		poll->poll();
+		n_plugin.tick(delta_time, n_component);
+	}
+
+	n_counting.take();
+	n_sink->m_events = 0;
+
+	uint64 parse = 0;
+	uint64 convert = 0;
+	uint64 publish = 0;
+	uint64 dispatch = 0;
+	uint64 poll_allocations = 0;
+	uint64 dispatch_allocations = 0;
+	int32 frames = 0;
+
+	const uint64 start = FPlatformTime::Cycles64();
+	for (int32 i = 0; i < n_frames; i++) {
+		if (!poll->poll()) {
+			break;
+		}
+		poll_allocations += n_counting.take();
+
+		const uint64 tick_start = FPlatformTime::Cycles64();
+		n_plugin.tick(delta_time, n_component);
+		dispatch += FPlatformTime::Cycles64() - tick_start;
+		dispatch_allocations += n_counting.take();
+
+		const FDTrackFrameStamps stamps = session->published_stamps();
+		parse += stamps.m_parsed - stamps.m_received;
+		convert += stamps.m_converted - stamps.m_parsed;
+		publish += stamps.m_published - stamps.m_converted;
+		frames++;
+	}
+	const uint64 total = FPlatformTime::Cycles64() - start;
+
+	poll->end();
+	n_plugin.remove(n_component);
+
+	if (frames) {
+		result.m_frames = frames;
+		result.m_parse_ns = cycles_to_ns(parse) / frames;
+		result.m_convert_ns = cycles_to_ns(convert) / frames;
+		result.m_publish_ns = cycles_to_ns(publish) / frames;
+		result.m_dispatch_ns = cycles_to_ns(dispatch) / frames;
+		result.m_total_ns = cycles_to_ns(total) / frames;
+		result.m_poll_allocations = static_cast<double>(poll_allocations) / frames;
+		result.m_dispatch_allocations = static_cast<double>(dispatch_allocations) / frames;
+		result.m_events = static_cast<double>(n_sink->m_events) / frames;
+		result.m_ok = (frames == n_frames);
+	}
+
+	return result;
+}
+
+TSharedRef<FJsonObject> to_json(const FDTrackBenchmarkResult &n_result) {
+
+	TSharedRef<FJsonObject> workload = MakeShared<FJsonObject>();
+	workload->SetNumberField(TEXT("bodies"), n_result.m_workload.m_bodies);
+	workload->SetNumberField(TEXT("flysticks"), n_result.m_workload.m_flysticks);
+	workload->SetNumberField(TEXT("hands"), n_result.m_workload.m_hands);
+	workload->SetNumberField(TEXT("humans"), n_result.m_workload.m_humans);
+	workload->SetNumberField(TEXT("joints"), n_result.m_workload.m_joints);
+
+	TSharedRef<FJsonObject> ns = MakeShared<FJsonObject>();
+	ns->SetNumberField(TEXT("parse"), n_result.m_parse_ns);
+	ns->SetNumberField(TEXT("convert"), n_result.m_convert_ns);
+	ns->SetNumberField(TEXT("publish"), n_result.m_publish_ns);
+	ns->SetNumberField(TEXT("dispatch"), n_result.m_dispatch_ns);
+	ns->SetNumberField(TEXT("total"), n_result.m_total_ns);
+
+	// counted on all threads while the poll or the dispatch stage ran, same run as the times
+	TSharedRef<FJsonObject> allocations = MakeShared<FJsonObject>();
+	allocations->SetNumberField(TEXT("poll"), n_result.m_poll_allocations);
+	allocations->SetNumberField(TEXT("dispatch"), n_result.m_dispatch_allocations);
+
+	TSharedRef<FJsonObject> ret = MakeShared<FJsonObject>();
+	ret->SetStringField(TEXT("name"), n_result.m_name);
+	ret->SetBoolField(TEXT("ok"), n_result.m_ok);
+	ret->SetObjectField(TEXT("workload"), workload);
+	ret->SetStringField(TEXT("filter"), n_result.m_filter);
+	ret->SetNumberField(TEXT("frames"), n_result.m_frames);
+	ret->SetNumberField(TEXT("datagram_bytes"), n_result.m_datagram_bytes);
+	ret->SetObjectField(TEXT("ns_per_frame"), ns);
+	ret->SetObjectField(TEXT("allocations_per_frame"), allocations);
+	ret->SetNumberField(TEXT("events_per_frame"), n_result.m_events);
+	ret->SetNumberField(TEXT("frames_per_second"), (n_result.m_total_ns > 0.0) ? 1000000000.0 / n_result.m_total_ns : 0.0);
+	ret->SetNumberField(TEXT("megabytes_per_second"), (n_result.m_total_ns > 0.0) ? n_result.m_datagram_bytes * 1000.0 / n_result.m_total_ns : 0.0);
+	return ret;
+}
+
+/// the standard suite, from a single body up to everything at once
+TArray<FDTrackWorkload> standard_workloads() {
+
+	TArray<FDTrackWorkload> ret;
+	auto add = [&ret](const int32 n_bodies, const int32 n_flysticks, const int32 n_hands, const int32 n_humans) {
+		FDTrackWorkload w;
+		w.m_bodies = n_bodies;
+		w.m_flysticks = n_flysticks;
+		w.m_hands = n_hands;
+		w.m_humans = n_humans;
+		ret.Add(w);
+	};
+
+	add(1, 0, 0, 0);
+	add(10, 0, 0, 0);
+	add(100, 0, 0, 0);
+	add(1000, 0, 0, 0);
+	add(10, 2, 2, 0);
+	add(10, 0, 0, 1);
+	add(10, 0, 0, 5);
+	add(0, 0, 0, 20);
+	add(100, 4, 4, 10);
+	add(1000, 4, 4, 20);
+	return ret;
+}
+
+}
+
+UDTrackBenchmarkCommandlet::UDTrackBenchmarkCommandlet() {
+
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UDTrackBenchmarkCommandlet::Main(const FString &n_params) {
+
+	// before the benchmark starts anything, see FDTrackCountingMalloc
+	FDTrackCountingMalloc &counting = FDTrackCountingMalloc::install();
+
+	if (!FDTrackPlugin::IsAvailable()) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("DTrack plugin not loaded"));
+		return 1;
+	}
+
+	FDTrackPlugin &plugin = static_cast<FDTrackPlugin &>(FDTrackPlugin::Get());
+
+	int32 frames = 5000;
+	int32 warmup = 500;
+	FParse::Value(*n_params, TEXT("frames="), frames);
+	FParse::Value(*n_params, TEXT("warmup="), warmup);
+
+	FString output;
+	FParse::Value(*n_params, TEXT("output="), output);
+
+	TArray<FDTrackWorkload> workloads;
+	FDTrackWorkload custom;
+	bool has_custom = FParse::Value(*n_params, TEXT("bodies="), custom.m_bodies);
+	has_custom |= FParse::Value(*n_params, TEXT("flysticks="), custom.m_flysticks);
+	has_custom |= FParse::Value(*n_params, TEXT("hands="), custom.m_hands);
+	has_custom |= FParse::Value(*n_params, TEXT("humans="), custom.m_humans);
+	FParse::Value(*n_params, TEXT("joints="), custom.m_joints);
+
+	if (has_custom) {
+		workloads.Add(custom);
+	} else {
+		workloads = standard_workloads();
+	}
+
+	// none unless asked for, all runs every workload once with each
+	FString filter_name = TEXT("none");
+	FParse::Value(*n_params, TEXT("filter="), filter_name);
+
+	TArray<FDTrackBenchmarkFilter> filters;
+	for (const FDTrackBenchmarkFilter &filter : BenchmarkFilters) {
+		if ((filter_name == TEXT("all")) || (filter_name == filter.m_name)) {
+			filters.Add(filter);
+		}
+	}
+
+	if (filters.Num() == 0) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("Unknown DTrack benchmark filter %s, use none, oneeuro, kalman or all"), *filter_name);
+		return 1;
+	}
+
+	// The sink only needs to be an actor owning the component, it doesn't need a world
+	ADTrackBenchmarkSink *sink = NewObject<ADTrackBenchmarkSink>(GetTransientPackage());
+	sink->AddToRoot();
+	UDTrackComponent *component = NewObject<UDTrackComponent>(sink);
+
+	TArray< TSharedPtr<FJsonValue> > results;
+	bool ok = true;
+
+	UE_LOG(DTrackPluginLog, Display, TEXT("%-24s %10s %10s %10s %10s %10s %10s %8s"), 
+			TEXT("workload"), TEXT("parse ns"), TEXT("convert"), TEXT("publish"), TEXT("dispatch"), TEXT("total"), TEXT("frames/s"), TEXT("allocs"));
+
+	for (const FDTrackBenchmarkFilter &filter : filters) {
+		for (const FDTrackWorkload &workload : workloads) {
+			const FDTrackBenchmarkResult result = run_workload(plugin, component, sink, workload, filter, frames, warmup, counting);
+			ok &= result.m_ok;
+
+			const FString allocations = FString::Printf(TEXT("%.2f"), result.m_poll_allocations + result.m_dispatch_allocations);
+
+			UE_LOG(DTrackPluginLog, Display, TEXT("%-24s %10.0f %10.0f %10.0f %10.0f %10.0f %10.0f %8s%s"), 
+					*result.m_name, result.m_parse_ns, result.m_convert_ns, result.m_publish_ns, result.m_dispatch_ns,
+					result.m_total_ns, (result.m_total_ns > 0.0) ? 1000000000.0 / result.m_total_ns : 0.0,
+					*allocations, result.m_ok ? TEXT("") : TEXT(" FAILED"));
+
+			results.Add(MakeShared<FJsonValueObject>(to_json(result)));
+		}
+	}
+
+	sink->RemoveFromRoot();
+
+	if (!output.IsEmpty()) {
+		TSharedRef<FJsonObject> root = MakeShared<FJsonObject>();
+		root->SetStringField(TEXT("plugin_version"), TEXT(PLUGIN_VERSION));
+		root->SetStringField(TEXT("date"), FDateTime::UtcNow().ToIso8601());
+		root->SetStringField(TEXT("platform"), ANSI_TO_TCHAR(FPlatformProperties::PlatformName()));
+		root->SetStringField(TEXT("cpu"), FPlatformMisc::GetCPUBrand());
+		root->SetNumberField(TEXT("frames"), frames);
+		root->SetNumberField(TEXT("warmup"), warmup);
+		root->SetArrayField(TEXT("results"), results);
+
+		FString json;
+		const TSharedRef< TJsonWriter<> > writer = TJsonWriterFactory<>::Create(&json);
+		FJsonSerializer::Serialize(root, writer);
+
+		if (!FFileHelper::SaveStringToFile(json, *output)) {
+			UE_LOG(DTrackPluginLog, Error, TEXT("Cannot write DTrack benchmark results to %s"), *output);
+			return 1;
+		}
+
+		UE_LOG(DTrackPluginLog, Display, TEXT("DTrack benchmark results written to %s"), *FPaths::ConvertRelativePathToFull(output));
+	}
+
+	return ok ? 0 : 1;
+}
+
+/************************************************************************/
+/* Sink                                                                 */
+/************************************************************************/
+void ADTrackBenchmarkSink::OnBodyData_Implementation(const int32 BodyID, const FVector &Position, const FRotator &Rotation) {
+
+	m_events++;
+}
+
+void ADTrackBenchmarkSink::OnFlystickData_Implementation(const int32 FlystickID, const FVector &Position, const FRotator &Rotation) {
+
+	m_events++;
+}
+
+void ADTrackBenchmarkSink::OnFlystickButton_Implementation(const int32 FlystickID, const int32 &ButtonIndex, const bool Pressed) {
+
+	m_events++;
+}
+
+void ADTrackBenchmarkSink::OnFlystickJoystick_Implementation(const int32 FlystickID, const TArray<float> &JoystickValues) {
+
+	m_events++;
+}
+
+void ADTrackBenchmarkSink::OnHandTracking_Implementation(const int32 HandID, const bool Right, const FVector &Translation, const FRotator &Rotation, const TArray<FDTrackFinger> &Fingers) {
+
+	m_events++;
+}
+
+void ADTrackBenchmarkSink::OnHumanModel_Implementation(const int32 ModelID, const TArray<FDTrackJoint> &Joints) {
+
+	m_events++;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,75 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "GameFramework/Actor.h"
+#include "DTrackInterface.h"
+
+#include "DTrackBenchmarkCommandlet.generated.h"
+
+/** @brief measures the tracking pipeline from datagram to interface call
+ *
+ *	Synthetic frames are parsed, converted, published and dispatched to a sink actor,
+ *	all on the calling thread so the numbers are free of thread handover and network.
+ *	Run headless like this:
+ *
+ *	UE4Editor-Cmd MyProject.uproject -run=DTrackBenchmark -output=dtrack_benchmark.json
+ *
+ *	Without further arguments a standard suite of workloads is run. -bodies=, -flysticks=,
+ *	-hands=, -humans= and -joints= run just the one given. -frames= and -warmup= set the 
+ *	number of frames measured and run before measuring.
+ */
+UCLASS()
+class UDTrackBenchmarkCommandlet : public UCommandlet {
+
+	GENERATED_BODY()
+
+	public:
+		UDTrackBenchmarkCommandlet();
+
+		int32 Main(const FString &n_params) override;
+};
+
+/** @brief receives benchmark frames and only counts them
+ */
+UCLASS(NotPlaceable, Transient)
+class ADTrackBenchmarkSink : public AActor, public IDTrackInterface {
+
+	GENERATED_BODY()
+
+	public:
+		void OnBodyData_Implementation(const int32 BodyID, const FVector &Position, const FRotator &Rotation) override;
+		void OnFlystickData_Implementation(const int32 FlystickID, const FVector &Position, const FRotator &Rotation) override;
+		void OnFlystickButton_Implementation(const int32 FlystickID, const int32 &ButtonIndex, const bool Pressed) override;
+		void OnFlystickJoystick_Implementation(const int32 FlystickID, const TArray<float> &JoystickValues) override;
+		void OnHandTracking_Implementation(const int32 HandID, const bool Right, const FVector &Translation, const FRotator &Rotation, const TArray<FDTrackFinger> &Fingers) override;
+		void OnHumanModel_Implementation(const int32 ModelID, const TArray<FDTrackJoint> &Joints) override;
+
+		uint64 m_events = 0;    //!< interface calls received
+};
@@ -0,0 +1,366 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackCapture.h"
+#include "IDTrackPlugin.h"
+
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/RunnableThread.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+
+using namespace DTrackCapture;
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+/************************************************************************/
+/* Writer                                                               */
+/************************************************************************/
+FDTrackCaptureWriter::FDTrackCaptureWriter(const FString &n_file_name)
+		: m_file_name(n_file_name)
+		, m_free(SlotCount + 1)
+		, m_filled(SlotCount + 1)
+		, m_stop_counter(0) {
+
+	FMemory::Memzero(m_header);
+	m_header.m_magic = Magic;
+	m_header.m_version = Version;
+	m_header.m_start_time = FDateTime::UtcNow().GetTicks();
+	
+	IPlatformFile &platform_file = FPlatformFileManager::Get().GetPlatformFile();
+	platform_file.CreateDirectoryTree(*FPaths::GetPath(m_file_name));
+
+	m_file.reset(platform_file.OpenWrite(*m_file_name));
+	if (!m_file) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("Could not open capture file '%s'"), *m_file_name);
+		return;
+	}
+
+	// header gets written again with the index offset when we're done
+	m_file->Write(reinterpret_cast<const uint8 *>(&m_header), sizeof(m_header));
+	m_write_offset = sizeof(m_header);
+	m_padding.SetNumZeroed(8);
+
+	// all the slots are allocated now so record() never has to
+	m_slots.resize(SlotCount);
+	for (Slot &slot : m_slots) {
+		slot.m_data.Reserve(SlotReserve);
+		m_free.Enqueue(&slot);
+	}
+
+	m_start_cycles = FPlatformTime::Cycles64();
+	m_thread = FRunnableThread::Create(this, TEXT("FDTrackCaptureWriter"), 0, TPri_BelowNormal);
+
+	UE_LOG(DTrackPluginLog, Display, TEXT("Recording DTrack capture to '%s'"), *m_file_name);
+}
+
+FDTrackCaptureWriter::~FDTrackCaptureWriter() {
+
+	if (m_thread) {
+		Stop();
+		m_thread->WaitForCompletion();
+		delete m_thread;
+		m_thread = nullptr;
+	}
+
+	if (m_dropped.GetValue()) {
+		UE_LOG(DTrackPluginLog, Warning, TEXT("DTrack capture dropped %i datagrams, writer could not keep up"), m_dropped.GetValue());
+	}
+}
+
+bool FDTrackCaptureWriter::is_open() const {
+
+	return m_thread != nullptr;
+}
+
+void FDTrackCaptureWriter::record(const char *n_data, const int32 n_size, const uint64 n_receive_cycles, const uint32 n_frame_counter) {
+
+	Slot *slot = nullptr;
+	if (!m_free.Dequeue(slot)) {
+		m_dropped.Increment();
+		return;
+	}
+
+	slot->m_receive_cycles = n_receive_cycles;
+	slot->m_frame_counter = n_frame_counter;
+	
+	// only allocates for datagrams larger than anything seen before
+	slot->m_data.SetNumUninitialized(n_size, false);
+	FMemory::Memcpy(slot->m_data.GetData(), n_data, n_size);
+
+	// cannot fail, there's more room in there than we have slots
+	m_filled.Enqueue(slot);
+}
+
+int32 FDTrackCaptureWriter::dropped() const {
+
+	return m_dropped.GetValue();
+}
+
+uint32 FDTrackCaptureWriter::Run() {
+
+	while (!m_stop_counter.GetValue()) {
+		if (!drain()) {
+			// Nothing there. I don't want the poll thread to signal us for every 
+			// datagram so I just look again in a bit. Slots are plenty for that.
+			FPlatformProcess::Sleep(0.002f);
+		}
+	}
+
+	// whatever came in after the stop request
+	drain();
+	finish();
+
+	return 1;
+}
+
+void FDTrackCaptureWriter::Stop() {
+
+	m_stop_counter.Set(1);
+}
+
+bool FDTrackCaptureWriter::drain() {
+
+	bool wrote = false;
+	Slot *slot = nullptr;
+	
+	while (m_filled.Dequeue(slot)) {
+		write(*slot);
+		m_free.Enqueue(slot);
+		wrote = true;
+	}
+
+	return wrote;
+}
+
+void FDTrackCaptureWriter::write(const Slot &n_slot) {
+
+	FDTrackCaptureRecordHeader record;
+	record.m_receive_time_us = static_cast<uint64>(
+			FPlatformTime::ToMilliseconds64(n_slot.m_receive_cycles - m_start_cycles) * 1000.0);
+	record.m_frame_counter = n_slot.m_frame_counter;
+	record.m_size = n_slot.m_data.Num();
+
+	FDTrackCaptureIndexEntry entry;
+	entry.m_receive_time_us = record.m_receive_time_us;
+	entry.m_offset = m_write_offset;
+	entry.m_frame_counter = record.m_frame_counter;
+	entry.m_size = record.m_size;
+	m_index.Add(entry);
+
+	const uint64 padding = padded_size(record.m_size) - record.m_size;
+	m_file->Write(reinterpret_cast<const uint8 *>(&record), sizeof(record));
+	m_file->Write(n_slot.m_data.GetData(), record.m_size);
+	if (padding) {
+		m_file->Write(m_padding.GetData(), padding);
+	}
+
+	m_write_offset += sizeof(record) + record.m_size + padding;
+}
+
+void FDTrackCaptureWriter::finish() {
+
+	m_header.m_index_offset = m_write_offset;
+	m_header.m_record_count = m_index.Num();
+
+	m_file->Write(reinterpret_cast<const uint8 *>(m_index.GetData()), m_index.Num() * sizeof(FDTrackCaptureIndexEntry));
+	m_file->Seek(0);
+	m_file->Write(reinterpret_cast<const uint8 *>(&m_header), sizeof(m_header));
+	m_file->Flush();
+	m_file.reset();
+
+	UE_LOG(DTrackPluginLog, Display, TEXT("DTrack capture '%s' closed with %i records"), *m_file_name, m_index.Num());
+}
+
+/************************************************************************/
+/* Reader                                                               */
+/************************************************************************/
+FDTrackCaptureReader::FDTrackCaptureReader() {
+
+}
+
+FDTrackCaptureReader::~FDTrackCaptureReader() {
+
+	// region must go before the handle it was mapped from
+	m_region.reset();
+	m_handle.reset();
+}
+
+bool FDTrackCaptureReader::open(const FString &n_file_name) {
+
+	m_handle.reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*n_file_name));
+	if (!m_handle) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("Could not map capture file '%s'"), *n_file_name);
+		return false;
+	}
+
+	m_region.reset(m_handle->MapRegion(0, m_handle->GetFileSize()));
+	if (!m_region) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("Could not map capture file '%s'"), *n_file_name);
+		return false;
+	}
+
+	m_data = m_region->GetMappedPtr();
+	m_size = m_region->GetMappedSize();
+
+	if (m_size < static_cast<int64>(sizeof(FDTrackCaptureHeader))) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("Capture file '%s' is too small"), *n_file_name);
+		return false;
+	}
+
+	const FDTrackCaptureHeader *header = reinterpret_cast<const FDTrackCaptureHeader *>(m_data);
+	if ((header->m_magic != Magic) || (header->m_version != Version)) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("'%s' is not a DTrack capture or has an unknown version"), *n_file_name);
+		return false;
+	}
+
+	m_start_time = header->m_start_time;
+
+	const uint64 index_end = header->m_index_offset + header->m_record_count * sizeof(FDTrackCaptureIndexEntry);
+	if (header->m_index_offset && (index_end <= static_cast<uint64>(m_size))) {
+		m_index = reinterpret_cast<const FDTrackCaptureIndexEntry *>(m_data + header->m_index_offset);
+		m_index_count = header->m_record_count;
+	} else {
+		UE_LOG(DTrackPluginLog, Warning, TEXT("Capture '%s' was not closed properly, rebuilding index"), *n_file_name);
+		rebuild_index();
+	}
+
+	return true;
+}
+
+int64 FDTrackCaptureReader::num_records() const {
+
+	return m_index_count;
+}
+
+FDateTime FDTrackCaptureReader::start_time() const {
+
+	return FDateTime(m_start_time);
+}
+
+bool FDTrackCaptureReader::record(const int64 n_index, FDTrackCaptureRecord &n_record) const {
+
+	if ((n_index < 0) || (n_index >= m_index_count)) {
+		return false;
+	}
+
+	const FDTrackCaptureIndexEntry &entry = m_index[n_index];
+	n_record.m_receive_time_us = entry.m_receive_time_us;
+	n_record.m_frame_counter = entry.m_frame_counter;
+	n_record.m_data = reinterpret_cast<const char *>(m_data + entry.m_offset + sizeof(FDTrackCaptureRecordHeader));
+	n_record.m_size = entry.m_size;
+	return true;
+}
+
+int64 FDTrackCaptureReader::find(const uint64 n_receive_time_us) const {
+
+	// lower bound on the receive times which are monotonic as recorded
+	int64 first = 0;
+	int64 count = m_index_count;
+	while (count > 0) {
+		const int64 step = count / 2;
+		if (m_index[first + step].m_receive_time_us < n_receive_time_us) {
+			first += step + 1;
+			count -= step + 1;
+		} else {
+			count = step;
+		}
+	}
+
+	return first;
+}
+
+bool FDTrackCaptureReader::validate(FString &n_error) const {
+
+	uint64 expected_offset = sizeof(FDTrackCaptureHeader);
+	uint64 last_time = 0;
+
+	for (int64 i = 0; i < m_index_count; i++) {
+		const FDTrackCaptureIndexEntry &entry = m_index[i];
+
+		// records are written back to back so each must start where the last one ended
+		if (entry.m_offset != expected_offset) {
+			n_error = FString::Printf(TEXT("record %lld at offset %llu, expected %llu"), i, entry.m_offset, expected_offset);
+			return false;
+		}
+
+		const uint64 record_end = entry.m_offset + sizeof(FDTrackCaptureRecordHeader) + padded_size(entry.m_size);
+		if (record_end > static_cast<uint64>(m_size)) {
+			n_error = FString::Printf(TEXT("record %lld exceeds file size"), i);
+			return false;
+		}
+
+		const FDTrackCaptureRecordHeader *record = reinterpret_cast<const FDTrackCaptureRecordHeader *>(m_data + entry.m_offset);
+		if ((record->m_receive_time_us != entry.m_receive_time_us) 
+				|| (record->m_frame_counter != entry.m_frame_counter)
+				|| (record->m_size != entry.m_size)) {
+			n_error = FString::Printf(TEXT("record %lld does not match its index entry"), i);
+			return false;
+		}
+
+		if (entry.m_receive_time_us < last_time) {
+			n_error = FString::Printf(TEXT("record %lld goes back in time"), i);
+			return false;
+		}
+
+		last_time = entry.m_receive_time_us;
+		expected_offset = record_end;
+	}
+
+	return true;
+}
+
+void FDTrackCaptureReader::rebuild_index() {
+
+	m_rebuilt_index.Reset();
+
+	uint64 offset = sizeof(FDTrackCaptureHeader);
+	while (offset + sizeof(FDTrackCaptureRecordHeader) <= static_cast<uint64>(m_size)) {
+		const FDTrackCaptureRecordHeader *record = reinterpret_cast<const FDTrackCaptureRecordHeader *>(m_data + offset);
+		const uint64 record_end = offset + sizeof(FDTrackCaptureRecordHeader) + padded_size(record->m_size);
+		
+		// the last record may have been cut off when the process died
+		if (record_end > static_cast<uint64>(m_size)) {
+			break;
+		}
+
+		FDTrackCaptureIndexEntry entry;
+		entry.m_receive_time_us = record->m_receive_time_us;
+		entry.m_offset = offset;
+		entry.m_frame_counter = record->m_frame_counter;
+		entry.m_size = record->m_size;
+		m_rebuilt_index.Add(entry);
+
+		offset = record_end;
+	}
+
+	m_index = m_rebuilt_index.GetData();
+	m_index_count = m_rebuilt_index.Num();
+}
+
+#undef LOCTEXT_NAMESPACE
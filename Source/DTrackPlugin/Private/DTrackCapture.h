@@ -0,0 +1,204 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Containers/CircularQueue.h"
+
+#include <memory>
+#include <vector>
+
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Capture file layout. Everything is little endian and 8 byte aligned so 
+ * a mapped file can be read in place:
+ *
+ *	FDTrackCaptureHeader
+ *	FDTrackCaptureRecordHeader, datagram bytes, padding to 8   (repeated)
+ *	FDTrackCaptureIndexEntry                                   (one per record)
+ *
+ * The index is appended when the capture is closed and the header is patched 
+ * with its offset. A capture that was not closed properly has an index offset 
+ * of 0 and the reader will scan the records to rebuild it.
+ */
+namespace DTrackCapture {
+
+	static const uint32 Magic   = 0x43525444;   // "DTRC"
+	static const uint32 Version = 1;
+
+	struct FDTrackCaptureHeader {
+		uint32 m_magic;
+		uint32 m_version;
+		int64  m_start_time;        //!< UTC ticks (FDateTime) when the capture was started
+		uint64 m_index_offset;      //!< file offset of the index, 0 if not written
+		uint64 m_record_count;      //!< number of index entries
+	};
+
+	struct FDTrackCaptureRecordHeader {
+		uint64 m_receive_time_us;   //!< arrival time in microseconds since capture start
+		uint32 m_frame_counter;     //!< DTrack frame counter as parsed
+		uint32 m_size;              //!< datagram size in bytes, excluding padding
+	};
+
+	struct FDTrackCaptureIndexEntry {
+		uint64 m_receive_time_us;
+		uint64 m_offset;            //!< file offset of the record header
+		uint32 m_frame_counter;
+		uint32 m_size;
+	};
+
+	/// records are padded so the next record header is aligned again
+	inline uint64 padded_size(const uint64 n_size) {
+
+		return (n_size + 7) & ~uint64(7);
+	}
+}
+
+/** @brief records raw datagrams into a capture file on a thread of its own
+ *
+ *	The poll thread calls record() for every datagram. This only copies the datagram 
+ *	into a preallocated slot and hands the slot over through a lock-free queue. 
+ *	Writing to disk happens in the writer thread which gives the slot back when done.
+ *	If the writer can't keep up, datagrams are dropped and counted rather than 
+ *	stalling the receive loop.
+ */
+class FDTrackCaptureWriter : public FRunnable {
+
+	public:
+		/// open the file and start the writer thread. Check is_open() afterwards
+		FDTrackCaptureWriter(const FString &n_file_name);
+		~FDTrackCaptureWriter();
+
+		bool is_open() const;
+
+		/// hand over a datagram. Call from the poll thread only
+		void record(const char *n_data, const int32 n_size, const uint64 n_receive_cycles, const uint32 n_frame_counter);
+
+		/// number of datagrams that could not be recorded because no slot was free
+		int32 dropped() const;
+
+		/// runs in writer thread
+		uint32 Run() override;
+		void Stop() override;
+
+	private:
+
+		/// one datagram in transit between poll and writer thread
+		struct Slot {
+			uint64        m_receive_cycles = 0;
+			uint32        m_frame_counter = 0;
+			TArray<uint8> m_data;
+		};
+
+		/// write everything that's queued. Returns false if nothing was
+		bool drain();
+
+		/// write one slot to disk and remember its index entry
+		void write(const Slot &n_slot);
+
+		/// append index and patch header
+		void finish();
+
+		static const uint32 SlotCount = 256;
+		static const int32  SlotReserve = 4096;
+
+		FString                     m_file_name;
+		std::unique_ptr<IFileHandle> m_file;
+		DTrackCapture::FDTrackCaptureHeader m_header;
+		uint64                      m_start_cycles = 0;
+		uint64                      m_write_offset = 0;
+
+		std::vector<Slot>           m_slots;
+		TCircularQueue<Slot *>      m_free;       //!< writer -> poll thread
+		TCircularQueue<Slot *>      m_filled;     //!< poll thread -> writer
+
+		TArray<DTrackCapture::FDTrackCaptureIndexEntry> m_index;   //!< only touched by writer thread
+		TArray<uint8>               m_padding;
+
+		FThreadSafeCounter          m_dropped;
+		FThreadSafeCounter          m_stop_counter;
+		FRunnableThread            *m_thread = nullptr;
+};
+
+/// one record as it sits in a mapped capture
+struct FDTrackCaptureRecord {
+	uint64      m_receive_time_us = 0;
+	uint32      m_frame_counter = 0;
+	const char *m_data = nullptr;
+	int32       m_size = 0;
+};
+
+/** @brief read-only access to a capture through a memory mapping
+ *
+ *	Records are located via the index so any of them can be accessed in constant time
+ *	and time based seeks are a binary search.
+ */
+class FDTrackCaptureReader {
+
+	public:
+		FDTrackCaptureReader();
+		~FDTrackCaptureReader();
+
+		/// map the file and load or rebuild the index. Logs and returns false on error
+		bool open(const FString &n_file_name);
+
+		int64 num_records() const;
+
+		/// UTC time the capture was started
+		FDateTime start_time() const;
+
+		/// get a record. The data pointer stays valid as long as the reader lives
+		bool record(const int64 n_index, FDTrackCaptureRecord &n_record) const;
+
+		/// first record received at or after the given time, num_records() if none
+		int64 find(const uint64 n_receive_time_us) const;
+
+		/// check the index against the records it points to. 
+		/// Returns false and a description of the first problem found
+		bool validate(FString &n_error) const;
+
+	private:
+		/// scan records from the beginning to build an index, used when none was written
+		void rebuild_index();
+
+		std::unique_ptr<IMappedFileHandle> m_handle;
+		std::unique_ptr<IMappedFileRegion> m_region;
+		const uint8  *m_data = nullptr;
+		int64         m_size = 0;
+		int64         m_start_time = 0;
+
+		const DTrackCapture::FDTrackCaptureIndexEntry *m_index = nullptr;
+		int64         m_index_count = 0;
+
+		/// only used when the index had to be rebuilt
+		TArray<DTrackCapture::FDTrackCaptureIndexEntry> m_rebuilt_index;
+};
@@ -0,0 +1,117 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackChangeDetector.h"
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+void FDTrackChangeDetector::set_thresholds(const float n_distance, const float n_angle) {
+
+	m_distance = FMath::Max(n_distance, 0.0f);
+	m_cos_half_angle = FMath::Cos(FMath::DegreesToRadians(FMath::Max(n_angle, 0.0f)) * 0.5f);
+}
+
+bool FDTrackChangeDetector::beyond(const Pose &n_pose, const FVector &n_location, const FQuat &n_rotation) const {
+
+	if (FVector::DistSquared(n_pose.m_location, n_location) > m_distance * m_distance) {
+		return true;
+	}
+
+	// |dot| of two unit quaternions is the cosine of half the angle between them. 
+	// With no threshold any difference at all counts
+	const float dot = FMath::Abs(n_pose.m_rotation | n_rotation);
+	return (m_cos_half_angle < 1.0f) ? (dot < m_cos_half_angle) : !n_pose.m_rotation.Equals(n_rotation, 0.0f);
+}
+
+bool FDTrackChangeDetector::changed(const EDTrackTargetType n_type, const int32 n_id, const FVector &n_location, const FRotator &n_rotation, const bool n_valid) {
+
+	if (n_id < 0) {
+		return false;
+	}
+
+	TArray<Pose> &poses = m_poses[static_cast<int32>(n_type)];
+	if (poses.Num() <= n_id) {
+		poses.SetNum(n_id + 1);
+	}
+
+	Pose &pose = poses[n_id];
+	const FQuat rotation = n_rotation.Quaternion();
+	if (pose.m_seen && (pose.m_valid == n_valid) && !beyond(pose, n_location, rotation)) {
+		return false;
+	}
+
+	pose.m_location = n_location;
+	pose.m_rotation = rotation;
+	pose.m_valid = n_valid;
+	pose.m_seen = true;
+	return true;
+}
+
+bool FDTrackChangeDetector::fingers_changed(const int32 n_hand_id, const TArray<FDTrackFinger> &n_fingers) {
+
+	if (n_hand_id < 0) {
+		return false;
+	}
+
+	if (m_fingers.Num() <= n_hand_id) {
+		m_fingers.SetNum(n_hand_id + 1);
+	}
+
+	TArray<Pose> &fingers = m_fingers[n_hand_id];
+	bool ret = (fingers.Num() != n_fingers.Num());
+	if (ret) {
+		fingers.SetNum(n_fingers.Num());
+	}
+
+	// once one finger moved, all are remembered
+	for (int32 f = 0; (f < n_fingers.Num()) && !ret; f++) {
+		ret = beyond(fingers[f], n_fingers[f].m_location, n_fingers[f].m_rotation.Quaternion());
+	}
+
+	if (ret) {
+		for (int32 f = 0; f < n_fingers.Num(); f++) {
+			fingers[f].m_location = n_fingers[f].m_location;
+			fingers[f].m_rotation = n_fingers[f].m_rotation.Quaternion();
+			fingers[f].m_valid = true;
+			fingers[f].m_seen = true;
+		}
+	}
+
+	return ret;
+}
+
+void FDTrackChangeDetector::reset() {
+
+	for (TArray<Pose> &poses : m_poses) {
+		for (Pose &pose : poses) {
+			pose.m_seen = false;
+		}
+	}
+
+	m_fingers.Reset();
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,71 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IDTrackPlugin.h"
+#include "DTrackInterface.h"
+
+/** @brief tells whether a pose is different enough from the one reported last
+ *
+ *	Remembers the pose of each target at the time it was last reported as changed. 
+ *	A new pose counts as changed if it moved or turned further than the thresholds 
+ *	from that, became valid or invalid, or the target is new. Small movements don't 
+ *	add up unnoticed that way. Memory per target is allocated the first time it's seen.
+ */
+class FDTrackChangeDetector {
+
+	public:
+		/// n_distance in cm, n_angle in degrees. 0 means any change at all
+		void set_thresholds(const float n_distance, const float n_angle);
+
+		/// true if it's to be remembered and reported as changed
+		bool changed(const EDTrackTargetType n_type, const int32 n_id, const FVector &n_location, const FRotator &n_rotation, const bool n_valid);
+
+		/// the same for the fingers of a hand
+		bool fingers_changed(const int32 n_hand_id, const TArray<FDTrackFinger> &n_fingers);
+
+		/// forget all poses, everything is new again
+		void reset();
+
+	private:
+		struct Pose {
+			FVector m_location = FVector::ZeroVector;
+			FQuat   m_rotation = FQuat::Identity;
+			bool    m_valid = false;
+			bool    m_seen = false;
+		};
+
+		/// true if n_location and n_rotation are beyond the thresholds from n_pose
+		bool beyond(const Pose &n_pose, const FVector &n_location, const FQuat &n_rotation) const;
+
+		float                    m_distance = 0.0f;
+		float                    m_cos_half_angle = 1.0f;     //!< of the angle threshold, to compare quaternion dot products
+
+		TArray<Pose>             m_poses[static_cast<int32>(EDTrackTargetType::Count)];
+		TArray< TArray<Pose> >   m_fingers;                    //!< by hand id
+};
@@ -0,0 +1,476 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackCluster.h"
+#include "IDTrackPlugin.h"
+
+#include "Common/UdpSocketBuilder.h"
+#include "SocketSubsystem.h"
+#include "Sockets.h"
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+namespace {
+
+// the smallest three quaternion components are within +-1/sqrt(2)
+const float QuatRange = 0.70710678f;
+
+// Fewest bytes each element takes on the wire, with all its own lists empty. Counts 
+// are checked against these before anything is sized, so a broken packet can't make us allocate
+const int32 StatusSize = 10;
+const int32 PoseSize = 19;
+const int32 BodySize = StatusSize + PoseSize;
+const int32 FlystickSize = StatusSize + PoseSize + 1 + 4 + 1;
+const int32 HandSize = 1 + StatusSize + PoseSize + 1;
+const int32 FingerSize = 1 + PoseSize + 6 * 4;
+const int32 HumanSize = StatusSize + 2;
+const int32 JointSize = 4 + PoseSize + 1;
+
+/// appends values to a packet. Assumes a little endian host like all our targets are
+class FPacketWriter {
+
+	public:
+		explicit FPacketWriter(TArray<uint8> &n_packet)
+				: m_packet(n_packet) {
+
+			m_packet.Reset();
+		}
+
+		template <typename T>
+		void put(const T n_value) {
+
+			const int32 at = m_packet.AddUninitialized(sizeof(T));
+			FMemory::Memcpy(m_packet.GetData() + at, &n_value, sizeof(T));
+		}
+
+		void pose(const FVector &n_location, const FRotator &n_rotation) {
+
+			put<int32>(quantize(n_location.X));
+			put<int32>(quantize(n_location.Y));
+			put<int32>(quantize(n_location.Z));
+
+			FQuat q = n_rotation.Quaternion();
+			q.Normalize();
+			const float c[4] = { q.X, q.Y, q.Z, q.W };
+
+			uint8 largest = 0;
+			for (uint8 i = 1; i < 4; i++) {
+				if (FMath::Abs(c[i]) > FMath::Abs(c[largest])) {
+					largest = i;
+				}
+			}
+
+			// q and -q are the same rotation, so the left out one can always be positive
+			const float sign = (c[largest] < 0.0f) ? -1.0f : 1.0f;
+			put<uint8>(largest);
+			for (uint8 i = 0; i < 4; i++) {
+				if (i != largest) {
+					put<int16>(static_cast<int16>(FMath::Clamp(FMath::RoundToInt(c[i] * sign * 32767.0f / QuatRange), -32767, 32767)));
+				}
+			}
+		}
+
+		/// the measurement's time goes as age, the secondary's clock is another
+		template <typename TTarget>
+		void status(const TTarget &n_target, const double n_arrival) {
+
+			put<uint8>(static_cast<uint8>(n_target.m_state));
+			put<uint8>(static_cast<uint8>(FMath::RoundToInt(FMath::Clamp(n_target.m_quality, 0.0f, 1.0f) * 255.0f)));
+			put<int32>(n_target.m_measured_frame);
+			put<float>((n_target.m_measured_time > 0.0) ? static_cast<float>(FMath::Max(n_arrival - n_target.m_measured_time, 0.0)) : -1.0f);
+		}
+
+	private:
+		static int32 quantize(const float n_cm) {
+
+			return static_cast<int32>(FMath::Clamp<double>(FMath::RoundToDouble(n_cm * 1000.0), MIN_int32, MAX_int32));
+		}
+
+		TArray<uint8> &m_packet;
+};
+
+/// reads values from a packet, remembering if it ever ran out
+class FPacketReader {
+
+	public:
+		FPacketReader(const uint8 *n_data, const int32 n_size)
+				: m_data(n_data)
+				, m_size(n_size) {
+		}
+
+		template <typename T>
+		T get() {
+
+			T ret = T();
+			if (m_position + static_cast<int32>(sizeof(T)) > m_size) {
+				m_ok = false;
+				return ret;
+			}
+
+			FMemory::Memcpy(&ret, m_data + m_position, sizeof(T));
+			m_position += sizeof(T);
+			return ret;
+		}
+
+		void pose(FVector &n_location, FRotator &n_rotation) {
+
+			n_location.X = get<int32>() / 1000.0f;
+			n_location.Y = get<int32>() / 1000.0f;
+			n_location.Z = get<int32>() / 1000.0f;
+
+			const uint8 largest = get<uint8>();
+			if (largest > 3) {
+				m_ok = false;
+				return;
+			}
+
+			float c[4];
+			float sum = 0.0f;
+			for (uint8 i = 0; i < 4; i++) {
+				if (i != largest) {
+					c[i] = get<int16>() * QuatRange / 32767.0f;
+					sum += c[i] * c[i];
+				}
+			}
+			c[largest] = FMath::Sqrt(FMath::Max(0.0f, 1.0f - sum));
+
+			n_rotation = FQuat(c[0], c[1], c[2], c[3]).Rotator();
+		}
+
+		/// measured time comes out relative to the frame's arrival, see FDTrackClusterFrame
+		template <typename TTarget>
+		void status(TTarget &n_target) {
+
+			const uint8 state = get<uint8>();
+			if (state > static_cast<uint8>(EDTrackTrackingState::TS_Coasted)) {
+				m_ok = false;
+			}
+
+			n_target.m_state = m_ok ? static_cast<EDTrackTrackingState>(state) : EDTrackTrackingState::TS_Lost;
+			n_target.m_valid = (n_target.m_state != EDTrackTrackingState::TS_Lost);
+			n_target.m_quality = get<uint8>() / 255.0f;
+			n_target.m_measured_frame = get<int32>();
+			const float age = get<float>();
+			n_target.m_measured_time = (age >= 0.0f) ? -age : 1.0;
+		}
+
+		/// read a count of elements taking at least n_element_size bytes each. 
+		/// 0 and not ok if there aren't that many bytes left
+		template <typename T>
+		int32 count(const int32 n_element_size) {
+
+			const int32 ret = get<T>();
+			if (ret * n_element_size > remaining()) {
+				m_ok = false;
+				return 0;
+			}
+
+			return ret;
+		}
+
+		int32 remaining() const {
+
+			return m_size - m_position;
+		}
+
+		bool ok() const {
+
+			return m_ok;
+		}
+
+	private:
+		const uint8 *m_data;
+		const int32  m_size;
+		int32        m_position = 0;
+		bool         m_ok = true;
+};
+
+}
+
+void FDTrackClusterCodec::encode(const uint32 n_frame_counter, const double n_timestamp, const double n_arrival,
+		const TArray<FDTrackBody> &n_bodies, const TArray<FDTrackFlystick> &n_flysticks,
+		const TArray<FDTrackHand> &n_hands, const TArray<FDTrackHuman> &n_humans,
+		TArray<uint8> &n_packet) {
+
+	FPacketWriter w(n_packet);
+
+	w.put<uint32>(DTrackCluster::Magic);
+	w.put<uint16>(DTrackCluster::Version);
+	w.put<uint32>(n_frame_counter);
+	w.put<double>(n_timestamp);
+	w.put<uint16>(n_bodies.Num());
+	w.put<uint16>(n_flysticks.Num());
+	w.put<uint16>(n_hands.Num());
+	w.put<uint16>(n_humans.Num());
+
+	for (const FDTrackBody &body : n_bodies) {
+		w.status(body, n_arrival);
+		w.pose(body.m_location, body.m_rotation);
+	}
+
+	for (const FDTrackFlystick &flystick : n_flysticks) {
+		w.status(flystick, n_arrival);
+		w.pose(flystick.m_location, flystick.m_rotation);
+
+		uint32 buttons = 0;
+		for (int32 b = 0; b < FMath::Min(flystick.m_button_states.Num(), 32); b++) {
+			if (flystick.m_button_states[b]) {
+				buttons |= 1u << b;
+			}
+		}
+		w.put<uint8>(FMath::Min(flystick.m_button_states.Num(), 32));
+		w.put<uint32>(buttons);
+
+		w.put<uint8>(flystick.m_joystick_states.Num());
+		for (const float joystick : flystick.m_joystick_states) {
+			w.put<int16>(static_cast<int16>(FMath::RoundToInt(FMath::Clamp(joystick, -1.0f, 1.0f) * 32767.0f)));
+		}
+	}
+
+	for (const FDTrackHand &hand : n_hands) {
+		w.put<uint8>(hand.m_right ? 1 : 0);
+		w.status(hand, n_arrival);
+		w.pose(hand.m_location, hand.m_rotation);
+		w.put<uint8>(hand.m_fingers.Num());
+		for (const FDTrackFinger &finger : hand.m_fingers) {
+			w.put<uint8>(static_cast<uint8>(finger.m_type));
+			w.pose(finger.m_location, finger.m_rotation);
+			w.put<float>(finger.m_tip_radius);
+			w.put<float>(finger.m_inner_phalanx_length);
+			w.put<float>(finger.m_middle_phalanx_length);
+			w.put<float>(finger.m_outer_phalanx_length);
+			w.put<float>(finger.m_inner_middle_phalanx_angle);
+			w.put<float>(finger.m_middle_outer_phalanx_angle);
+		}
+	}
+
+	for (const FDTrackHuman &human : n_humans) {
+		w.status(human, n_arrival);
+		w.put<uint16>(human.m_joints.Num());
+		for (const FDTrackJoint &joint : human.m_joints) {
+			w.put<int32>(joint.m_id);
+			w.pose(joint.m_location, joint.m_rotation);
+			w.put<uint8>(joint.m_angles.Num());
+			for (const float angle : joint.m_angles) {
+				w.put<float>(angle);
+			}
+		}
+	}
+}
+
+bool FDTrackClusterCodec::decode(const uint8 *n_data, const int32 n_size, FDTrackClusterFrame &n_frame) {
+
+	FPacketReader r(n_data, n_size);
+
+	if ((r.get<uint32>() != DTrackCluster::Magic) || (r.get<uint16>() != DTrackCluster::Version)) {
+		return false;
+	}
+
+	n_frame.m_frame_counter = r.get<uint32>();
+	n_frame.m_timestamp = r.get<double>();
+
+	const int32 num_bodies = r.get<uint16>();
+	const int32 num_flysticks = r.get<uint16>();
+	const int32 num_hands = r.get<uint16>();
+	const int32 num_humans = r.get<uint16>();
+	const int32 least = num_bodies * BodySize + num_flysticks * FlystickSize + num_hands * HandSize + num_humans * HumanSize;
+	if (!r.ok() || (least > r.remaining())) {
+		return false;
+	}
+
+	// SetNum keeps what's allocated, so a steady stream doesn't allocate
+	n_frame.m_bodies.SetNum(num_bodies, false);
+	n_frame.m_flysticks.SetNum(num_flysticks, false);
+	n_frame.m_hands.SetNum(num_hands, false);
+	n_frame.m_humans.SetNum(num_humans, false);
+
+	for (FDTrackBody &body : n_frame.m_bodies) {
+		r.status(body);
+		r.pose(body.m_location, body.m_rotation);
+		if (!r.ok()) {
+			return false;
+		}
+	}
+
+	for (FDTrackFlystick &flystick : n_frame.m_flysticks) {
+		r.status(flystick);
+		r.pose(flystick.m_location, flystick.m_rotation);
+
+		// all buttons are in one uint32
+		const uint8 num_buttons = r.get<uint8>();
+		const uint32 buttons = r.get<uint32>();
+		if (!r.ok() || (num_buttons > 32)) {
+			return false;
+		}
+
+		flystick.m_button_states.SetNum(num_buttons, false);
+		for (int32 b = 0; b < flystick.m_button_states.Num(); b++) {
+			flystick.m_button_states[b] = (buttons >> b) & 1;
+		}
+
+		flystick.m_joystick_states.SetNum(r.count<uint8>(sizeof(int16)), false);
+		for (float &joystick : flystick.m_joystick_states) {
+			joystick = r.get<int16>() / 32767.0f;
+		}
+
+		if (!r.ok()) {
+			return false;
+		}
+	}
+
+	for (FDTrackHand &hand : n_frame.m_hands) {
+		hand.m_right = (r.get<uint8>() != 0);
+		r.status(hand);
+		r.pose(hand.m_location, hand.m_rotation);
+		hand.m_fingers.SetNum(r.count<uint8>(FingerSize), false);
+		for (FDTrackFinger &finger : hand.m_fingers) {
+			finger.m_type = static_cast<EDTrackFingerType>(FMath::Min<uint8>(r.get<uint8>(), static_cast<uint8>(EDTrackFingerType::FT_Pinky)));
+			r.pose(finger.m_location, finger.m_rotation);
+			finger.m_tip_radius = r.get<float>();
+			finger.m_inner_phalanx_length = r.get<float>();
+			finger.m_middle_phalanx_length = r.get<float>();
+			finger.m_outer_phalanx_length = r.get<float>();
+			finger.m_inner_middle_phalanx_angle = r.get<float>();
+			finger.m_middle_outer_phalanx_angle = r.get<float>();
+		}
+
+		if (!r.ok()) {
+			return false;
+		}
+	}
+
+	for (FDTrackHuman &human : n_frame.m_humans) {
+		r.status(human);
+		human.m_joints.SetNum(r.count<uint16>(JointSize), false);
+		for (FDTrackJoint &joint : human.m_joints) {
+			joint.m_id = r.get<int32>();
+			r.pose(joint.m_location, joint.m_rotation);
+			joint.m_angles.SetNum(r.count<uint8>(sizeof(float)), false);
+			for (float &angle : joint.m_angles) {
+				angle = r.get<float>();
+			}
+
+			if (!r.ok()) {
+				return false;
+			}
+		}
+
+		if (!r.ok()) {
+			return false;
+		}
+	}
+
+	return r.ok();
+}
+
+void FDTrackClusterCodec::encode_sync(const uint32 n_frame_counter, const double n_timestamp, TArray<uint8> &n_packet) {
+
+	FPacketWriter w(n_packet);
+
+	w.put<uint32>(DTrackCluster::SyncMagic);
+	w.put<uint16>(DTrackCluster::Version);
+	w.put<uint32>(n_frame_counter);
+	w.put<double>(n_timestamp);
+}
+
+bool FDTrackClusterCodec::decode_sync(const uint8 *n_data, const int32 n_size, uint32 &n_frame_counter, double &n_timestamp) {
+
+	FPacketReader r(n_data, n_size);
+
+	if ((r.get<uint32>() != DTrackCluster::SyncMagic) || (r.get<uint16>() != DTrackCluster::Version)) {
+		return false;
+	}
+
+	n_frame_counter = r.get<uint32>();
+	n_timestamp = r.get<double>();
+
+	return r.ok();
+}
+
+/************************************************************************/
+/* Sender                                                               */
+/************************************************************************/
+FDTrackClusterSender::FDTrackClusterSender(const FString &n_address, const uint32 n_port) {
+
+	FIPv4Address address;
+	if (!FIPv4Address::Parse(n_address, address)) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("'%s' is not a valid DTrack cluster address"), *n_address);
+		return;
+	}
+
+	// TTL 1 keeps multicast within the cluster's subnet
+	m_socket = FUdpSocketBuilder(TEXT("DTrackClusterSend"))
+			.AsNonBlocking()
+			.AsReusable()
+			.WithBroadcast()
+			.WithMulticastTTL(1)
+			.WithMulticastLoopback()
+			.WithSendBufferSize(1024 * 1024)
+			.Build();
+
+	if (!m_socket) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("Could not open DTrack cluster socket"));
+		return;
+	}
+
+	m_target = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+	m_target->SetIp(address.Value);
+	m_target->SetPort(n_port);
+
+	UE_LOG(DTrackPluginLog, Display, TEXT("Rebroadcasting DTrack frames to %s:%u"), *n_address, n_port);
+}
+
+FDTrackClusterSender::~FDTrackClusterSender() {
+
+	if (m_socket) {
+		m_socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(m_socket);
+		m_socket = nullptr;
+	}
+}
+
+bool FDTrackClusterSender::is_open() const {
+
+	return m_socket != nullptr;
+}
+
+void FDTrackClusterSender::send(const TArray<uint8> &n_packet) {
+
+	if (n_packet.Num() > DTrackCluster::MaxPacketSize) {
+		if (!m_warned_size) {
+			UE_LOG(DTrackPluginLog, Warning, TEXT("DTrack frame of %d bytes too large to rebroadcast"), n_packet.Num());
+			m_warned_size = true;
+		}
+		return;
+	}
+
+	// if the send buffer is full we lose the frame, which is what UDP does anyway
+	FScopeLock lock(&m_mutex);
+	int32 sent = 0;
+	m_socket->SendTo(n_packet.GetData(), n_packet.Num(), sent, *m_target);
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,118 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DTrackInterface.h"
+#include "Interfaces/IPv4/IPv4Address.h"
+
+/** 
+ * A primary node rebroadcasts each converted frame in this format so secondary 
+ * nodes of a cluster don't have to parse and convert themselves and all apply 
+ * the very same frame. All values are little endian.
+ *
+ *	header:   magic, version, frame counter, DTrack timestamp, 
+ *	          number of bodies, flysticks, hands, humans
+ *	pose:     location as int32 in 1/1000 cm, rotation as quaternion with the 
+ *	          largest component left out and the others as int16 (7 bytes)
+ *	status:   state, quality as uint8 in 1/255, frame counter of the last measurement, 
+ *	          seconds since then as float, -1 if never measured
+ *	body:     status, pose
+ *	flystick: status, pose, number of buttons, button bits, number of joysticks, int16 each
+ *	hand:     right, status, pose, number of fingers, each pose and 6 floats
+ *	human:    number of joints, each id, pose and number of angles, float each
+ *
+ * Targets are sent in the same dense order the plug-in publishes them in,
+ * so their index is their id. Everything goes into one datagram.
+ *
+ * In frame lock mode the primary also sends a sync packet each engine frame 
+ * telling everyone which DTrack frame to show:
+ *
+ *	sync:     sync magic, version, frame counter, DTrack timestamp
+ */
+namespace DTrackCluster {
+	static const uint32 Magic = 0x4C435444;      // "DTCL"
+	static const uint32 SyncMagic = 0x53435444;  // "DTCS"
+	static const uint16 Version = 4;
+
+	/// what fits into a single UDP datagram
+	static const int32 MaxPacketSize = 65507;
+}
+
+/// one frame as it goes over the wire. Measured times of targets are relative to the frame's arrival, 
+/// 0 or less, and positive for targets never measured
+struct FDTrackClusterFrame {
+	uint32                  m_frame_counter = 0;
+	double                  m_timestamp = -1.0;
+	TArray<FDTrackBody>     m_bodies;
+	TArray<FDTrackFlystick> m_flysticks;
+	TArray<FDTrackHand>     m_hands;
+	TArray<FDTrackHuman>    m_humans;
+};
+
+/** @brief turns frames into packets and back
+ */
+class FDTrackClusterCodec {
+
+	public:
+		/// write a packet into n_packet, which keeps its allocation between calls
+		static void encode(const uint32 n_frame_counter, const double n_timestamp, const double n_arrival,
+				const TArray<FDTrackBody> &n_bodies, const TArray<FDTrackFlystick> &n_flysticks,
+				const TArray<FDTrackHand> &n_hands, const TArray<FDTrackHuman> &n_humans, 
+				TArray<uint8> &n_packet);
+
+		/// read a packet. False if it's not one of ours or broken
+		static bool decode(const uint8 *n_data, const int32 n_size, FDTrackClusterFrame &n_frame);
+
+		/// write a sync packet naming the frame to show
+		static void encode_sync(const uint32 n_frame_counter, const double n_timestamp, TArray<uint8> &n_packet);
+
+		/// read a sync packet. False if it's not one
+		static bool decode_sync(const uint8 *n_data, const int32 n_size, uint32 &n_frame_counter, double &n_timestamp);
+};
+
+/** @brief sends packets to the secondary nodes
+ *
+ *	The address may be a multicast group, a broadcast address or a single host.
+ */
+class FDTrackClusterSender {
+
+	public:
+		FDTrackClusterSender(const FString &n_address, const uint32 n_port);
+		~FDTrackClusterSender();
+
+		bool is_open() const;
+
+		/// send one packet, never blocks. Poll and game thread both do this
+		void send(const TArray<uint8> &n_packet);
+
+	private:
+		FCriticalSection                m_mutex;
+		class FSocket                  *m_socket = nullptr;
+		TSharedPtr<class FInternetAddr> m_target;
+		bool                            m_warned_size = false;
+};
@@ -0,0 +1,102 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackCoasting.h"
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+FDTrackCoaster::FDTrackCoaster(const double n_window, const double n_decay)
+		: m_window(n_window)
+		, m_decay(FMath::Max(n_decay, 0.001)) {
+}
+
+void FDTrackCoaster::measured(const EDTrackTargetType n_type, const int32 n_id, const double n_time, const FVector &n_location, const FRotator &n_rotation) {
+
+	if (n_id < 0) {
+		return;
+	}
+
+	TArray<Target> &targets = m_targets[static_cast<int32>(n_type)];
+	if (targets.Num() <= n_id) {
+		targets.SetNum(n_id + 1);
+	}
+
+	Target &target = targets[n_id];
+	FQuat rotation = n_rotation.Quaternion();
+	const double dt = n_time - target.m_time;
+
+	if (target.m_seen && (dt > 0.0) && (dt <= MaxGap)) {
+		// the same rotation either way, but the shorter way round is the one it turned
+		if ((target.m_rotation | rotation) < 0.0f) {
+			rotation = rotation * -1.0f;
+		}
+
+		FVector axis;
+		float angle;
+		(rotation * target.m_rotation.Inverse()).ToAxisAndAngle(axis, angle);
+
+		// a little averaging, single frames are noisy
+		const float rate = static_cast<float>(1.0 / dt);
+		target.m_velocity = FMath::Lerp(target.m_velocity, (n_location - target.m_location) * rate, 0.5f);
+		target.m_angular_velocity = FMath::Lerp(target.m_angular_velocity, axis * angle * rate, 0.5f);
+	} else if (dt > 0.0) {
+		target.m_velocity = FVector::ZeroVector;
+		target.m_angular_velocity = FVector::ZeroVector;
+	}
+
+	target.m_seen = true;
+	target.m_time = n_time;
+	target.m_location = n_location;
+	target.m_rotation = rotation;
+}
+
+EDTrackTrackingState FDTrackCoaster::occluded(const EDTrackTargetType n_type, const int32 n_id, const double n_time, FVector &n_location, FRotator &n_rotation) const {
+
+	const TArray<Target> &targets = m_targets[static_cast<int32>(n_type)];
+	if (!targets.IsValidIndex(n_id) || !targets[n_id].m_seen) {
+		n_location = FVector::ZeroVector;
+		n_rotation = FRotator::ZeroRotator;
+		return EDTrackTrackingState::TS_Lost;
+	}
+
+	const Target &target = targets[n_id];
+	const double elapsed = FMath::Max(n_time - target.m_time, 0.0);
+	const double coasted = FMath::Min(elapsed, m_window);
+
+	// speed decays as exp(-t / decay), so the way gone is its integral. 
+	// Once the window is over this stays where it got to
+	const float distance = static_cast<float>(m_decay * (1.0 - FMath::Exp(-coasted / m_decay)));
+	n_location = target.m_location + target.m_velocity * distance;
+
+	const FVector turn = target.m_angular_velocity * distance;
+	const float angle = turn.Size();
+	const FQuat rotation = (angle > KINDA_SMALL_NUMBER) ? FQuat(turn / angle, angle) * target.m_rotation : target.m_rotation;
+	n_rotation = rotation.Rotator();
+
+	return ((m_window > 0.0) && (elapsed <= m_window)) ? EDTrackTrackingState::TS_Coasted : EDTrackTrackingState::TS_Lost;
+}
+
+#undef LOCTEXT_NAMESPACE
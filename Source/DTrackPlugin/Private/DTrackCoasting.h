@@ -0,0 +1,72 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IDTrackPlugin.h"
+#include "DTrackInterface.h"
+
+/** @brief carries targets through short occlusions
+ *
+ *	Remembers each target's last measured pose and how it moved. When DTrack 
+ *	loses sight of a target, its pose continues along that motion, slowing down 
+ *	exponentially, for a while. After that it stays put and counts as lost.
+ *	Poll thread only. Memory per target is allocated the first time it's seen.
+ */
+class FDTrackCoaster {
+
+	public:
+		/// coast for n_window seconds at most, speed falling by 1/e every n_decay seconds
+		FDTrackCoaster(const double n_window, const double n_decay);
+
+		/// a target was measured at n_time
+		void measured(const EDTrackTargetType n_type, const int32 n_id, const double n_time, const FVector &n_location, const FRotator &n_rotation);
+
+		/** 
+		 * A target was not seen at n_time. Sets the pose it is to have now and tells 
+		 * whether that's coasted or lost. Targets never measured are lost at the origin.
+		 */
+		EDTrackTrackingState occluded(const EDTrackTargetType n_type, const int32 n_id, const double n_time, FVector &n_location, FRotator &n_rotation) const;
+
+	private:
+		struct Target {
+			bool    m_seen = false;
+			double  m_time = 0.0;                               //!< of the last measurement
+			FVector m_location = FVector::ZeroVector;
+			FQuat   m_rotation = FQuat::Identity;
+			FVector m_velocity = FVector::ZeroVector;           //!< cm/s
+			FVector m_angular_velocity = FVector::ZeroVector;   //!< rotation vector per second, radians
+		};
+
+		/// measurements further apart than this don't tell the speed anymore
+		static constexpr double MaxGap = 0.1;
+
+		const double          m_window;
+		const double          m_decay;
+
+		TArray<Target>        m_targets[static_cast<int32>(EDTrackTargetType::Count)];
+};
@@ -79,7 +79,7 @@ void UDTrackComponent::TickComponent(float n_delta_time, enum ELevelTick n_tick_
 
 	// Forward the component tick to the plugin
 	if (m_plugin) {
-		m_plugin->tick(n_delta_time, this);
+		m_plugin->tick(n_delta_time, this, n_this_tick_function ? n_this_tick_function->GetCompletionHandle() : FGraphEventRef());
 	}
 }
 
@@ -131,3 +131,32 @@ void UDTrackComponent::human_model(const int32 n_human_id, const TArray<FDTrackJ
 		IDTrackInterface::Execute_OnHumanModel(GetOwner(), n_human_id, n_joints);
 	}
 }
+
+void UDTrackComponent::target_state_changed(const EDTrackTargetType n_type, const int32 n_id, const EDTrackTrackingState n_state) {
+
+	if (GetOwner()->GetClass()->ImplementsInterface(UDTrackInterface::StaticClass())) {
+		switch (n_type) {
+			case EDTrackTargetType::Body:
+				IDTrackInterface::Execute_OnBodyStateChanged(GetOwner(), n_id, n_state);
+				break;
+			case EDTrackTargetType::Flystick:
+				IDTrackInterface::Execute_OnFlystickStateChanged(GetOwner(), n_id, n_state);
+				break;
+			case EDTrackTargetType::Hand:
+				IDTrackInterface::Execute_OnHandStateChanged(GetOwner(), n_id, n_state);
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+void UDTrackComponent::stream_state_changed(const EDTrackStreamState n_state) {
+
+	if (GetOwner()->GetClass()->ImplementsInterface(UDTrackInterface::StaticClass())) {
+		IDTrackInterface::Execute_OnStreamStateChanged(GetOwner(), n_state);
+		if (n_state == EDTrackStreamState::SS_Stalled) {
+			IDTrackInterface::Execute_DeviceDisabled(GetOwner());
+		}
+	}
+}
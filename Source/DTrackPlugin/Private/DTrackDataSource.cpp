@@ -0,0 +1,773 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackDataSource.h"
+#include "IDTrackPlugin.h"
+
+#include "DTrackParse.hpp"
+
+#include "Common/UdpSocketBuilder.h"
+#include "SocketSubsystem.h"
+#include "Sockets.h"
+
+#include <cstdio>
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+namespace {
+
+/// open a shared UDP port for receiving, joined to a multicast group unless that's Any
+FSocket *open_receive_socket(const TCHAR *n_name, const FIPv4Address &n_group, const FIPv4Address &n_interface, const uint32 n_port) {
+
+	FUdpSocketBuilder builder(n_name);
+	builder.AsBlocking()
+			.AsReusable()
+			.BoundToAddress(FIPv4Address::Any)
+			.BoundToPort(n_port)
+			.WithReceiveBufferSize(1024 * 1024);
+
+	if (n_group != FIPv4Address::Any) {
+		builder.JoinedToGroup(n_group, n_interface)
+				.WithMulticastLoopback();
+	}
+
+	return builder.Build();
+}
+
+/// leave the group if we joined one and get rid of the socket
+void close_receive_socket(FSocket *&n_socket, const FIPv4Address &n_group, const FIPv4Address &n_interface) {
+
+	if (!n_socket) {
+		return;
+	}
+
+	ISocketSubsystem *sockets = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+
+	if (n_group != FIPv4Address::Any) {
+		TSharedRef<FInternetAddr> group = sockets->CreateInternetAddr();
+		group->SetIp(n_group.Value);
+		TSharedRef<FInternetAddr> local = sockets->CreateInternetAddr();
+		local->SetIp(n_interface.Value);
+		n_socket->LeaveMulticastGroup(*group, *local);
+	}
+
+	n_socket->Close();
+	sockets->DestroySocket(n_socket);
+	n_socket = nullptr;
+}
+
+/// wait for a datagram as long as the SDK does by default, which is 1 s
+bool receive_datagram(FSocket *n_socket, uint8 *n_buffer, const int32 n_buffer_size, int32 &n_size) {
+
+	if (!n_socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromSeconds(1.0))) {
+		return false;
+	}
+
+	TSharedRef<FInternetAddr> sender = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+	return n_socket->RecvFrom(n_buffer, n_buffer_size, n_size, *sender) && (n_size > 0);
+}
+
+}
+
+/************************************************************************/
+/* Any source                                                           */
+/************************************************************************/
+uint32 FDTrackDataSource::frame_counter() const {
+
+	return parser().getFrameCounter();
+}
+
+double FDTrackDataSource::timestamp() const {
+
+	return parser().getTimeStamp();
+}
+
+const FDTrackClusterFrame *FDTrackDataSource::converted() const {
+
+	return nullptr;
+}
+
+/************************************************************************/
+/* Live source                                                          */
+/************************************************************************/
+FDTrackLiveSource::FDTrackLiveSource(const bool n_dtrack2, const std::string &n_server_ip, const uint32 n_server_port)
+		: m_dtrack2(n_dtrack2)
+		, m_server_ip(n_server_ip)
+		, m_server_port(n_server_port) {
+
+}
+
+bool FDTrackLiveSource::start() {
+
+	// what the short constructors do, only with a buffer for any datagram
+	if (m_dtrack2) {
+		m_dtrack.reset(new FDTrackLiveSDK(m_server_ip, 50105, m_server_port, DTrackSDK::SYS_DTRACK_2, FDTrackLiveSDK::DatagramBufferSize));
+	} else {
+		m_dtrack.reset(new FDTrackLiveSDK(std::string(), 0, m_server_port, DTrackSDK::SYS_DTRACK_UNKNOWN, FDTrackLiveSDK::DatagramBufferSize));
+	}
+
+	// I don't know when this can occur but I guess it's client
+	// port collision with fixed UDP ports
+	if (!m_dtrack->isLocalDataPortValid()) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("Could not open DTrack data port %u"), m_server_port);
+		m_dtrack.reset();
+		return false;
+	}
+
+	// start the tracking via tcp route if applicable
+	if (m_dtrack2) {
+		if (!m_dtrack->startMeasurement()) {
+			if (m_dtrack->getLastServerError() == DTrackSDK::ERR_TIMEOUT) {
+				UE_LOG(DTrackPluginLog, Error, TEXT("Could not start tracking, timeout"));
+			} else if (m_dtrack->getLastServerError() == DTrackSDK::ERR_NET) {
+				UE_LOG(DTrackPluginLog, Error, TEXT("Could not start tracking, network error"));
+			} else {
+				UE_LOG(DTrackPluginLog, Error, TEXT("Could not start tracking"));
+			}
+			m_dtrack.reset();
+			return false;
+		} 
+	} 
+
+	return true;
+}
+
+bool FDTrackLiveSource::receive() {
+
+	return m_dtrack->receive();
+}
+
+void FDTrackLiveSource::stop() {
+
+	if (m_dtrack && m_dtrack2) {
+		UE_LOG(DTrackPluginLog, Display, TEXT("Stopping DTrack2 measurement."));
+		m_dtrack->stopMeasurement();
+	}
+
+	m_dtrack.reset();
+}
+
+bool FDTrackLiveSource::parse_error() const {
+
+	return m_dtrack->getLastDataError() == DTrackSDK::ERR_PARSE;
+}
+
+const DTrackParser &FDTrackLiveSource::parser() const {
+
+	return *m_dtrack;
+}
+
+const char *FDTrackLiveSource::datagram() const {
+
+	return m_dtrack->datagram();
+}
+
+int32 FDTrackLiveSource::datagram_size() const {
+
+	return m_dtrack->datagram_size();
+}
+
+uint64 FDTrackLiveSource::receive_cycles() const {
+
+	return m_dtrack->receive_cycles();
+}
+
+/************************************************************************/
+/* Replay parser                                                        */
+/************************************************************************/
+FDTrackReplayParser::FDTrackReplayParser() {
+
+	// same as the live source's receive buffer
+	m_buffer.Reserve(FDTrackLiveSDK::DatagramBufferSize);
+}
+
+bool FDTrackReplayParser::parse(const char *n_data, const int32 n_size) {
+
+	m_buffer.SetNumUninitialized(n_size + 1, false);
+	FMemory::Memcpy(m_buffer.GetData(), n_data, n_size);
+	m_buffer[n_size] = '\0';
+
+	// This is what DTrackSDK::receive() does after the datagram came in
+	char *line = m_buffer.GetData();
+	startFrame();
+	do {
+		if (!parseLine(&line)) {
+			return false;
+		}
+	} while ((line = DTrackSDK_Parse::string_nextline(m_buffer.GetData(), line, m_buffer.Num())) != nullptr);
+	endFrame();
+
+	return true;
+}
+
+/************************************************************************/
+/* Multicast source                                                     */
+/************************************************************************/
+FDTrackMulticastSource::FDTrackMulticastSource(const FString &n_group, const FString &n_interface, const uint32 n_port)
+		: m_group_name(n_group)
+		, m_interface_name(n_interface)
+		, m_port(n_port)
+		, m_interface(FIPv4Address::Any) {
+
+	// same as the live source's receive buffer
+	m_buffer.SetNumUninitialized(FDTrackLiveSDK::DatagramBufferSize);
+}
+
+FDTrackMulticastSource::~FDTrackMulticastSource() {
+
+	stop();
+}
+
+bool FDTrackMulticastSource::start() {
+
+	if (!FIPv4Address::Parse(m_group_name, m_group) || !m_group.IsMulticastAddress()) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("'%s' is not a multicast group address"), *m_group_name);
+		return false;
+	}
+
+	if (!m_interface_name.IsEmpty() && !FIPv4Address::Parse(m_interface_name, m_interface)) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("'%s' is not an interface address"), *m_interface_name);
+		return false;
+	}
+
+	m_socket = open_receive_socket(TEXT("DTrackMulticast"), m_group, m_interface, m_port);
+
+	if (!m_socket) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("Could not join DTrack multicast group %s on port %u"), *m_group_name, m_port);
+		return false;
+	}
+
+	UE_LOG(DTrackPluginLog, Display, TEXT("Receiving DTrack multicast group %s on port %u"), *m_group_name, m_port);
+	return true;
+}
+
+bool FDTrackMulticastSource::receive() {
+
+	// timeouts aren't parse errors, whatever the last datagram was
+	m_parse_error = false;
+
+	int32 size = 0;
+	if (!receive_datagram(m_socket, reinterpret_cast<uint8 *>(m_buffer.GetData()), m_buffer.Num() - 1, size)) {
+		return false;
+	}
+
+	m_receive_cycles = FPlatformTime::Cycles64();
+	m_size = size;
+	m_parse_error = !m_parser.parse(m_buffer.GetData(), m_size);
+
+	return !m_parse_error;
+}
+
+void FDTrackMulticastSource::stop() {
+
+	close_receive_socket(m_socket, m_group, m_interface);
+}
+
+bool FDTrackMulticastSource::parse_error() const {
+
+	return m_parse_error;
+}
+
+const DTrackParser &FDTrackMulticastSource::parser() const {
+
+	return m_parser;
+}
+
+const char *FDTrackMulticastSource::datagram() const {
+
+	return m_buffer.GetData();
+}
+
+int32 FDTrackMulticastSource::datagram_size() const {
+
+	return m_size;
+}
+
+uint64 FDTrackMulticastSource::receive_cycles() const {
+
+	return m_receive_cycles;
+}
+
+/************************************************************************/
+/* Cluster source                                                       */
+/************************************************************************/
+FDTrackClusterSource::FDTrackClusterSource(const FString &n_group, const FString &n_interface, const uint32 n_port)
+		: m_group_name(n_group)
+		, m_interface_name(n_interface)
+		, m_port(n_port)
+		, m_group(FIPv4Address::Any)
+		, m_interface(FIPv4Address::Any) {
+
+	m_buffer.SetNumUninitialized(DTrackCluster::MaxPacketSize);
+}
+
+FDTrackClusterSource::~FDTrackClusterSource() {
+
+	stop();
+}
+
+bool FDTrackClusterSource::start() {
+
+	if (!m_group_name.IsEmpty() && (!FIPv4Address::Parse(m_group_name, m_group) || !m_group.IsMulticastAddress())) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("'%s' is not a multicast group address"), *m_group_name);
+		return false;
+	}
+
+	if (!m_interface_name.IsEmpty() && !FIPv4Address::Parse(m_interface_name, m_interface)) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("'%s' is not an interface address"), *m_interface_name);
+		return false;
+	}
+
+	m_socket = open_receive_socket(TEXT("DTrackCluster"), m_group, m_interface, m_port);
+	if (!m_socket) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("Could not open DTrack cluster port %u"), m_port);
+		return false;
+	}
+
+	UE_LOG(DTrackPluginLog, Display, TEXT("Receiving DTrack frames from the cluster primary on port %u"), m_port);
+	return true;
+}
+
+bool FDTrackClusterSource::receive() {
+
+	// a bad frame before must not make sync packets or timeouts look bad too
+	m_decode_error = false;
+
+	int32 size = 0;
+	if (!receive_datagram(m_socket, m_buffer.GetData(), m_buffer.Num(), size)) {
+		return false;
+	}
+
+	// sync packets come in between frames in frame lock mode. They're no frame themselves
+	if (FDTrackClusterCodec::decode_sync(m_buffer.GetData(), size, m_sync_frame_counter, m_sync_timestamp)) {
+		m_has_sync = true;
+		return false;
+	}
+
+	m_receive_cycles = FPlatformTime::Cycles64();
+	m_size = size;
+	m_decode_error = !FDTrackClusterCodec::decode(m_buffer.GetData(), m_size, m_frame);
+
+	return !m_decode_error;
+}
+
+void FDTrackClusterSource::stop() {
+
+	close_receive_socket(m_socket, m_group, m_interface);
+}
+
+bool FDTrackClusterSource::parse_error() const {
+
+	return m_decode_error;
+}
+
+const DTrackParser &FDTrackClusterSource::parser() const {
+
+	return m_parser;
+}
+
+const char *FDTrackClusterSource::datagram() const {
+
+	return reinterpret_cast<const char *>(m_buffer.GetData());
+}
+
+int32 FDTrackClusterSource::datagram_size() const {
+
+	return m_size;
+}
+
+uint64 FDTrackClusterSource::receive_cycles() const {
+
+	return m_receive_cycles;
+}
+
+uint32 FDTrackClusterSource::frame_counter() const {
+
+	return m_frame.m_frame_counter;
+}
+
+double FDTrackClusterSource::timestamp() const {
+
+	return m_frame.m_timestamp;
+}
+
+const FDTrackClusterFrame *FDTrackClusterSource::converted() const {
+
+	return &m_frame;
+}
+
+bool FDTrackClusterSource::take_sync(uint32 &n_frame_counter, double &n_timestamp) {
+
+	if (!m_has_sync) {
+		return false;
+	}
+
+	n_frame_counter = m_sync_frame_counter;
+	n_timestamp = m_sync_timestamp;
+	m_has_sync = false;
+	return true;
+}
+
+/************************************************************************/
+/* Replay source                                                        */
+/************************************************************************/
+FDTrackReplaySource::FDTrackReplaySource(const FString &n_file_name, const float n_speed, const bool n_stepped, const bool n_loop)
+		: m_file_name(n_file_name)
+		, m_loop(n_loop)
+		, m_seek_ms(-1) {
+
+	set_speed(n_speed);
+	set_stepped(n_stepped);
+}
+
+bool FDTrackReplaySource::start() {
+
+	if (!m_reader.open(m_file_name)) {
+		return false;
+	}
+
+	if (!m_reader.num_records()) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("Capture '%s' is empty"), *m_file_name);
+		return false;
+	}
+
+	UE_LOG(DTrackPluginLog, Display, TEXT("Replaying DTrack capture '%s' recorded %s, %lld frames"), 
+			*m_file_name, *m_reader.start_time().ToString(), m_reader.num_records());
+
+	m_next = 0;
+	m_position_us.Set(0);
+	resync();
+	return true;
+}
+
+bool FDTrackReplaySource::receive() {
+
+	// waiting for a step or the delivery time is no parse error
+	m_parse_error = false;
+
+	const int32 seek_ms = m_seek_ms.Set(-1);
+	if (seek_ms >= 0) {
+		m_next = m_reader.find(static_cast<uint64>(seek_ms) * 1000);
+		resync();
+	}
+
+	if (m_next >= m_reader.num_records()) {
+		if (!m_loop) {
+			// Nothing more to come. Behave like a live source that times out
+			FPlatformProcess::Sleep(0.1f);
+			return false;
+		}
+
+		m_next = 0;
+		resync();
+	}
+
+	FDTrackCaptureRecord record;
+	m_reader.record(m_next, record);
+
+	if (!wait_for_delivery(record)) {
+		return false;
+	}
+
+	m_next++;
+	m_current = record;
+	m_position_us.Set(static_cast<int64>(record.m_receive_time_us));
+	m_receive_cycles = FPlatformTime::Cycles64();
+	m_parse_error = !m_parser.parse(record.m_data, record.m_size);
+
+	return !m_parse_error;
+}
+
+void FDTrackReplaySource::stop() {
+
+}
+
+bool FDTrackReplaySource::parse_error() const {
+
+	return m_parse_error;
+}
+
+const DTrackParser &FDTrackReplaySource::parser() const {
+
+	return m_parser;
+}
+
+const char *FDTrackReplaySource::datagram() const {
+
+	return m_current.m_data;
+}
+
+int32 FDTrackReplaySource::datagram_size() const {
+
+	return m_current.m_size;
+}
+
+uint64 FDTrackReplaySource::receive_cycles() const {
+
+	return m_receive_cycles;
+}
+
+void FDTrackReplaySource::set_speed(const float n_speed) {
+
+	m_speed_permille.Set(FMath::Max(0, FMath::RoundToInt(n_speed * 1000.0f)));
+}
+
+void FDTrackReplaySource::set_stepped(const bool n_stepped) {
+
+	m_stepped.Set(n_stepped ? 1 : 0);
+}
+
+bool FDTrackReplaySource::stepped() const {
+
+	return m_stepped.GetValue() != 0;
+}
+
+void FDTrackReplaySource::step(const int32 n_frames) {
+
+	m_steps.Add(n_frames);
+}
+
+void FDTrackReplaySource::seek(const double n_seconds) {
+
+	m_seek_ms.Set(FMath::Max(0, FMath::RoundToInt(n_seconds * 1000.0)));
+}
+
+double FDTrackReplaySource::position() const {
+
+	return m_position_us.GetValue() / 1000000.0;
+}
+
+void FDTrackReplaySource::resync() {
+
+	FDTrackCaptureRecord record;
+	m_reader.record(m_next, record);
+
+	m_sync_cycles = FPlatformTime::Cycles64();
+	m_sync_time_us = record.m_receive_time_us;
+	m_resync_speed = m_speed_permille.GetValue();
+}
+
+bool FDTrackReplaySource::wait_for_delivery(const FDTrackCaptureRecord &n_record) {
+
+	// same timeout as the SDK's default so the poll thread checks its stop condition as often
+	const double timeout = FPlatformTime::Seconds() + 1.0;
+
+	if (m_stepped.GetValue()) {
+		while (m_steps.GetValue() <= 0) {
+			if (FPlatformTime::Seconds() > timeout) {
+				return false;
+			}
+			FPlatformProcess::Sleep(0.001f);
+		}
+		
+		m_steps.Decrement();
+		
+		// when stepping ends, real time continues from where we are
+		m_resync_speed = -1;
+		return true;
+	}
+
+	const int32 speed = m_speed_permille.GetValue();
+	if (speed == 0) {
+		return true;
+	}
+
+	// speed changes and stepping restart the clock from here
+	if (speed != m_resync_speed) {
+		resync();
+	}
+
+	const double delay_seconds = ((static_cast<double>(n_record.m_receive_time_us) - m_sync_time_us) / 1000000.0) / (speed / 1000.0);
+	const uint64 due_cycles = m_sync_cycles + static_cast<uint64>(FMath::Max(0.0, delay_seconds) / FPlatformTime::GetSecondsPerCycle64());
+
+	while (true) {
+		const uint64 now = FPlatformTime::Cycles64();
+		if (now >= due_cycles) {
+			return true;
+		}
+
+		if (FPlatformTime::Seconds() > timeout) {
+			return false;
+		}
+
+		// sleep coarse while far away, then spin the last bit for accuracy
+		const double remaining = FPlatformTime::ToSeconds64(due_cycles - now);
+		if (remaining > 0.002) {
+			FPlatformProcess::Sleep(static_cast<float>(remaining - 0.001));
+		} else {
+			FPlatformProcess::YieldThread();
+		}
+	}
+}
+
+/************************************************************************/
+/* Synthetic source                                                     */
+/************************************************************************/
+FDTrackSyntheticSource::FDTrackSyntheticSource(const FDTrackWorkload &n_workload, const int32 n_frames) {
+
+	m_frames.reserve(n_frames);
+	for (int32 i = 0; i < n_frames; i++) {
+		m_frames.push_back(format_frame(n_workload, i));
+	}
+}
+
+bool FDTrackSyntheticSource::start() {
+
+	m_next = 0;
+	return !m_frames.empty();
+}
+
+bool FDTrackSyntheticSource::receive() {
+
+	const std::string &frame = m_frames[m_next];
+	m_next = (m_next + 1) % m_frames.size();
+
+	m_receive_cycles = FPlatformTime::Cycles64();
+	m_parse_error = !m_parser.parse(frame.data(), frame.size());
+
+	return !m_parse_error;
+}
+
+void FDTrackSyntheticSource::stop() {
+
+}
+
+bool FDTrackSyntheticSource::parse_error() const {
+
+	return m_parse_error;
+}
+
+const DTrackParser &FDTrackSyntheticSource::parser() const {
+
+	return m_parser;
+}
+
+const char *FDTrackSyntheticSource::datagram() const {
+
+	// m_next already points to the one after
+	return m_frames[(m_next + m_frames.size() - 1) % m_frames.size()].data();
+}
+
+int32 FDTrackSyntheticSource::datagram_size() const {
+
+	return m_frames[(m_next + m_frames.size() - 1) % m_frames.size()].size();
+}
+
+uint64 FDTrackSyntheticSource::receive_cycles() const {
+
+	return m_receive_cycles;
+}
+
+double FDTrackSyntheticSource::average_size() const {
+
+	double size = 0.0;
+	for (const std::string &frame : m_frames) {
+		size += frame.size();
+	}
+
+	return m_frames.empty() ? 0.0 : size / m_frames.size();
+}
+
+std::string FDTrackSyntheticSource::format_frame(const FDTrackWorkload &n_workload, const uint32 n_frame_counter) {
+
+	std::string frame;
+	char line[256];
+
+	auto append = [&](const int n_length) {
+		frame.append(line, FMath::Clamp<int>(n_length, 0, sizeof(line) - 1));
+	};
+
+	// every target gets a slightly different pose that changes each frame.
+	// Bodies and joints have euler angles after the location, which the plug-in doesn't read
+	int32 index = 0;
+	auto pose = [&](const bool n_angles) {
+		const double a = n_frame_counter * 0.01 + index * 0.1;
+		const double c = FMath::Cos(a);
+		const double s = FMath::Sin(a);
+		index++;
+
+		if (n_angles) {
+			append(FCStringAnsi::Snprintf(line, sizeof(line), "[%.3f %.3f %.3f 0.0000 0.0000 %.4f]", 1000.0 * c, 1000.0 * s, 1200.0 + index, FMath::RadiansToDegrees(a)));
+		} else {
+			append(FCStringAnsi::Snprintf(line, sizeof(line), "[%.3f %.3f %.3f]", 1000.0 * c, 1000.0 * s, 1200.0 + index));
+		}
+		
+		// rotation around z, column wise like DTrack has it
+		append(FCStringAnsi::Snprintf(line, sizeof(line), "[%.6f %.6f %.6f %.6f %.6f %.6f %.6f %.6f %.6f]", 
+				c, s, 0.0, -s, c, 0.0, 0.0, 0.0, 1.0));
+	};
+
+	append(FCStringAnsi::Snprintf(line, sizeof(line), "fr %u\r\nts %.6f\r\n", n_frame_counter, n_frame_counter / 60.0));
+
+	if (n_workload.m_bodies) {
+		append(FCStringAnsi::Snprintf(line, sizeof(line), "6dcal %d\r\n6d %d", n_workload.m_bodies, n_workload.m_bodies));
+		for (int32 id = 0; id < n_workload.m_bodies; id++) {
+			append(FCStringAnsi::Snprintf(line, sizeof(line), " [%d 1.000]", id));
+			pose(true);
+		}
+		frame.append("\r\n");
+	}
+
+	if (n_workload.m_flysticks) {
+		append(FCStringAnsi::Snprintf(line, sizeof(line), "6df2 %d %d", n_workload.m_flysticks, n_workload.m_flysticks));
+		for (int32 id = 0; id < n_workload.m_flysticks; id++) {
+			append(FCStringAnsi::Snprintf(line, sizeof(line), " [%d 1.000 6 2]", id));
+			pose(false);
+			append(FCStringAnsi::Snprintf(line, sizeof(line), "[%d %.3f %.3f]", 1 << ((n_frame_counter / 60) % 6), 0.5, -0.5));
+		}
+		frame.append("\r\n");
+	}
+
+	if (n_workload.m_hands) {
+		append(FCStringAnsi::Snprintf(line, sizeof(line), "glcal %d\r\ngl %d", n_workload.m_hands, n_workload.m_hands));
+		for (int32 id = 0; id < n_workload.m_hands; id++) {
+			append(FCStringAnsi::Snprintf(line, sizeof(line), " [%d 1.000 %d 5]", id, id % 2));
+			pose(false);
+			for (int32 f = 0; f < 5; f++) {
+				frame.append(" ");
+				pose(false);
+				append(FCStringAnsi::Snprintf(line, sizeof(line), "[8.000 22.000 %.3f 28.000 %.3f 45.000]", 30.0, 30.0));
+			}
+		}
+		frame.append("\r\n");
+	}
+
+	if (n_workload.m_humans) {
+		append(FCStringAnsi::Snprintf(line, sizeof(line), "6dj %d %d", n_workload.m_humans, n_workload.m_humans));
+		for (int32 id = 0; id < n_workload.m_humans; id++) {
+			append(FCStringAnsi::Snprintf(line, sizeof(line), " [%d %d]", id, n_workload.m_joints));
+			for (int32 j = 0; j < n_workload.m_joints; j++) {
+				append(FCStringAnsi::Snprintf(line, sizeof(line), "[%d 1.000]", j));
+				pose(true);
+			}
+		}
+		frame.append("\r\n");
+	}
+
+	return frame;
+}
+
+#undef LOCTEXT_NAMESPACE
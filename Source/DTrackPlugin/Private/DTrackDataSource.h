@@ -0,0 +1,314 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Interfaces/IPv4/IPv4Address.h"
+#include "DTrackLiveSDK.h"
+#include "DTrackCapture.h"
+#include "DTrackCluster.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/** @brief where the poll thread gets its tracking frames from
+ *
+ *	All methods are called in the poll thread. After a successful receive()
+ *	parser() holds the frame's content just like the SDK does after its receive().
+ */
+class FDTrackDataSource {
+
+	public:
+		virtual ~FDTrackDataSource() {}
+
+		/// connect and start measurement or whatever else is needed. Logs and returns false on error
+		virtual bool start() = 0;
+
+		/// wait for the next frame and parse it. False on timeout or error
+		virtual bool receive() = 0;
+
+		/// counterpart to start()
+		virtual void stop() = 0;
+
+		/// true if the last receive() got a datagram but could not parse it
+		virtual bool parse_error() const = 0;
+
+		/// the parsed content of the last frame
+		virtual const DTrackParser &parser() const = 0;
+
+		/// the last datagram as it came in, for recording
+		virtual const char *datagram() const = 0;
+		virtual int32 datagram_size() const = 0;
+
+		/// cycle count when the last datagram arrived
+		virtual uint64 receive_cycles() const = 0;
+
+		/// frame counter and DTrack timestamp of the last frame
+		virtual uint32 frame_counter() const;
+		virtual double timestamp() const;
+
+		/// the last frame, if this source delivers converted frames rather than datagrams to parse
+		virtual const FDTrackClusterFrame *converted() const;
+};
+
+/** @brief the real thing, receiving from a DTrack system via the SDK
+ */
+class FDTrackLiveSource : public FDTrackDataSource {
+
+	public:
+		FDTrackLiveSource(const bool n_dtrack2, const std::string &n_server_ip, const uint32 n_server_port);
+
+		bool start() override;
+		bool receive() override;
+		void stop() override;
+		bool parse_error() const override;
+		const DTrackParser &parser() const override;
+		const char *datagram() const override;
+		int32 datagram_size() const override;
+		uint64 receive_cycles() const override;
+
+	private:
+		const bool         m_dtrack2;
+		const std::string  m_server_ip;
+		const uint32       m_server_port;
+
+		std::unique_ptr< FDTrackLiveSDK > m_dtrack;
+};
+
+/** @brief parses datagrams handed in rather than received by the SDK
+ */
+class FDTrackReplayParser : public DTrackParser {
+
+	public:
+		FDTrackReplayParser();
+
+		/// parse one datagram the same way the SDK does after receiving it
+		bool parse(const char *n_data, const int32 n_size);
+
+	private:
+		TArray<char> m_buffer;   //!< SDK wants mutable lines
+};
+
+/** @brief receives a tracking stream sent to a multicast group
+ *
+ *	Listening only, measurement is not started or stopped as other 
+ *	receivers depend on the stream as well. The port is opened shared so
+ *	several processes on one host can receive the same group.
+ */
+class FDTrackMulticastSource : public FDTrackDataSource {
+
+	public:
+		/// an empty interface means the system picks one
+		FDTrackMulticastSource(const FString &n_group, const FString &n_interface, const uint32 n_port);
+		~FDTrackMulticastSource();
+
+		bool start() override;
+		bool receive() override;
+		void stop() override;
+		bool parse_error() const override;
+		const DTrackParser &parser() const override;
+		const char *datagram() const override;
+		int32 datagram_size() const override;
+		uint64 receive_cycles() const override;
+
+	private:
+		const FString         m_group_name;
+		const FString         m_interface_name;
+		const uint32          m_port;
+
+		FIPv4Address          m_group;
+		FIPv4Address          m_interface;
+		class FSocket        *m_socket = nullptr;
+
+		FDTrackReplayParser   m_parser;
+		TArray<char>          m_buffer;            //!< last datagram
+		int32                 m_size = 0;
+		uint64                m_receive_cycles = 0;
+		bool                  m_parse_error = false;
+};
+
+/** @brief receives frames rebroadcast by a cluster's primary node
+ *
+ *	Those are converted already, so there's no parsing and the poll thread 
+ *	injects them as they are. The parser stays empty.
+ */
+class FDTrackClusterSource : public FDTrackDataSource {
+
+	public:
+		/// an empty group means unicast or broadcast on the port
+		FDTrackClusterSource(const FString &n_group, const FString &n_interface, const uint32 n_port);
+		~FDTrackClusterSource();
+
+		bool start() override;
+		bool receive() override;
+		void stop() override;
+		bool parse_error() const override;
+		const DTrackParser &parser() const override;
+		const char *datagram() const override;
+		int32 datagram_size() const override;
+		uint64 receive_cycles() const override;
+		uint32 frame_counter() const override;
+		double timestamp() const override;
+		const FDTrackClusterFrame *converted() const override;
+
+		/// the last sync packet received since the last call, if any
+		bool take_sync(uint32 &n_frame_counter, double &n_timestamp);
+
+	private:
+		const FString         m_group_name;
+		const FString         m_interface_name;
+		const uint32          m_port;
+
+		FIPv4Address          m_group;
+		FIPv4Address          m_interface;
+		class FSocket        *m_socket = nullptr;
+
+		DTrackParser          m_parser;            //!< never filled
+		FDTrackClusterFrame   m_frame;
+		TArray<uint8>         m_buffer;            //!< last packet
+		int32                 m_size = 0;
+		uint64                m_receive_cycles = 0;
+		bool                  m_decode_error = false;
+
+		bool                  m_has_sync = false;
+		uint32                m_sync_frame_counter = 0;
+		double                m_sync_timestamp = -1.0;
+};
+
+/** @brief plays back a capture file as if it was received live
+ *
+ *	Playback speed is relative to the recorded arrival times. 1 is real time, 
+ *	0 means as fast as the pipeline takes it. In stepped mode each frame is only 
+ *	delivered when step() was called. Speed, pause and steps can be changed from 
+ *	any thread while playing.
+ */
+class FDTrackReplaySource : public FDTrackDataSource {
+
+	public:
+		FDTrackReplaySource(const FString &n_file_name, const float n_speed, const bool n_stepped, const bool n_loop);
+
+		bool start() override;
+		bool receive() override;
+		void stop() override;
+		bool parse_error() const override;
+		const DTrackParser &parser() const override;
+		const char *datagram() const override;
+		int32 datagram_size() const override;
+		uint64 receive_cycles() const override;
+
+		/// set playback speed factor. 0 or less plays as fast as possible
+		void set_speed(const float n_speed);
+
+		/// switch stepped mode on or off
+		void set_stepped(const bool n_stepped);
+		bool stepped() const;
+
+		/// allow the next n frames to be delivered in stepped mode
+		void step(const int32 n_frames = 1);
+
+		/// jump to the first frame at or after this time in the capture
+		void seek(const double n_seconds);
+
+		/// where we are in the capture, in seconds since it started
+		double position() const;
+
+	private:
+		/// restart the real time clock from the current record on
+		void resync();
+
+		/// wait for the delivery time of the current record or until a step is granted.
+		/// False if we couldn't within the receive timeout
+		bool wait_for_delivery(const FDTrackCaptureRecord &n_record);
+
+		const FString         m_file_name;
+		const bool            m_loop;
+
+		FDTrackCaptureReader  m_reader;
+		FDTrackReplayParser   m_parser;
+
+		FThreadSafeCounter    m_speed_permille;     //!< playback speed * 1000
+		FThreadSafeCounter    m_stepped;
+		FThreadSafeCounter    m_steps;              //!< steps granted but not yet taken
+		FThreadSafeCounter    m_seek_ms;            //!< pending seek, -1 if none
+		FThreadSafeCounter64  m_position_us;        //!< capture time of the last delivered frame, for position()
+
+		int64                 m_next = 0;           //!< next record to deliver
+		int32                 m_resync_speed = 0;   //!< speed the clock was synced with
+		uint64                m_sync_cycles = 0;    //!< cycles when ...
+		uint64                m_sync_time_us = 0;   //!< ... this capture time was delivered
+
+		FDTrackCaptureRecord  m_current;
+		uint64                m_receive_cycles = 0;
+		bool                  m_parse_error = false;
+};
+
+/// what a synthetic source puts into each frame
+struct FDTrackWorkload {
+	int32 m_bodies = 0;
+	int32 m_flysticks = 0;
+	int32 m_hands = 0;
+	int32 m_humans = 0;
+	int32 m_joints = 20;    //!< per human
+};
+
+/** @brief generates frames in memory for benchmarks
+ *
+ *	Datagrams are formatted up front in the DTrack ASCII format, so receive()
+ *	costs exactly as much as parsing a frame that came in from the network.
+ *	Targets move a little every frame. The prepared frames are played in a loop.
+ */
+class FDTrackSyntheticSource : public FDTrackDataSource {
+
+	public:
+		FDTrackSyntheticSource(const FDTrackWorkload &n_workload, const int32 n_frames = 256);
+
+		bool start() override;
+		bool receive() override;
+		void stop() override;
+		bool parse_error() const override;
+		const DTrackParser &parser() const override;
+		const char *datagram() const override;
+		int32 datagram_size() const override;
+		uint64 receive_cycles() const override;
+
+		/// average size of a prepared datagram in bytes
+		double average_size() const;
+
+	private:
+		/// format one frame in the DTrack ASCII format
+		static std::string format_frame(const FDTrackWorkload &n_workload, const uint32 n_frame_counter);
+
+		std::vector< std::string > m_frames;
+		FDTrackReplayParser        m_parser;
+
+		int32                 m_next = 0;
+		uint64                m_receive_cycles = 0;
+		bool                  m_parse_error = false;
+};
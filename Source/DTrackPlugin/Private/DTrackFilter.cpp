@@ -0,0 +1,288 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackFilter.h"
+#include "DTrackComponent.h"
+#include "DTrackStats.h"
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+namespace {
+
+/// quaternion to rotation vector, radians
+FVector to_rotation_vector(FQuat n_quat) {
+
+	if (n_quat.W < 0.0f) {
+		n_quat = n_quat * -1.0f;
+	}
+
+	FVector axis;
+	float angle;
+	n_quat.ToAxisAndAngle(axis, angle);
+	return axis * angle;
+}
+
+/// and back
+FQuat from_rotation_vector(const FVector &n_vector) {
+
+	const float angle = n_vector.Size();
+	if (angle < KINDA_SMALL_NUMBER) {
+		return FQuat::Identity;
+	}
+
+	return FQuat(n_vector / angle, angle);
+}
+
+}
+
+/************************************************************************/
+/* Filter of one target                                                 */
+/************************************************************************/
+FDTrackPoseFilter::FDTrackPoseFilter(const FDTrackFilterSettings &n_settings)
+		: m_settings(n_settings)
+		, m_location(FVector::ZeroVector)
+		, m_rotation(FQuat::Identity)
+		, m_velocity(FVector::ZeroVector) {
+}
+
+void FDTrackPoseFilter::reset() {
+
+	m_started = false;
+}
+
+float FDTrackPoseFilter::alpha(const float n_cutoff, const float n_dt) {
+
+	const float tau = 1.0f / (2.0f * PI * n_cutoff);
+	return 1.0f / (1.0f + tau / n_dt);
+}
+
+void FDTrackPoseFilter::filter(const double n_time, FVector &n_location, FQuat &n_rotation) {
+
+	const double dt = n_time - m_last_time;
+
+	if (!m_started || (dt > ResetSeconds)) {
+		m_started = true;
+		m_last_time = n_time;
+		m_location = n_location;
+		m_rotation = n_rotation;
+		m_velocity = FVector::ZeroVector;
+		m_angular_speed = 0.0f;
+
+		const float variance = FMath::Square(m_settings.m_measurement_noise);
+		const float angular_variance = FMath::Square(FMath::DegreesToRadians(m_settings.m_measurement_noise));
+		for (int32 i = 0; i < 3; i++) {
+			m_position_axes[i].start(variance);
+			m_rotation_axes[i].start(angular_variance);
+		}
+		return;
+	}
+
+	// same time twice, nothing new to learn
+	if (dt <= 0.0) {
+		n_location = m_location;
+		n_rotation = m_rotation;
+		return;
+	}
+
+	m_last_time = n_time;
+
+	// the same rotation either way, but filtering needs them on the same side
+	if ((m_rotation | n_rotation) < 0.0f) {
+		n_rotation = n_rotation * -1.0f;
+	}
+
+	switch (m_settings.m_type) {
+		case EDTrackSmoothing::SM_OneEuro:
+			one_euro(static_cast<float>(dt), n_location, n_rotation);
+			break;
+		case EDTrackSmoothing::SM_Kalman:
+			kalman(static_cast<float>(dt), n_location, n_rotation);
+			break;
+		default:
+			break;
+	}
+}
+
+void FDTrackPoseFilter::one_euro(const float n_dt, FVector &n_location, FQuat &n_rotation) {
+
+	const float derivative_alpha = alpha(m_settings.m_derivative_cutoff, n_dt);
+
+	// position, cutoff rising with speed
+	m_velocity = FMath::Lerp(m_velocity, (n_location - m_location) / n_dt, derivative_alpha);
+	const float location_alpha = alpha(m_settings.m_min_cutoff + m_settings.m_beta * m_velocity.Size(), n_dt);
+	m_location = FMath::Lerp(m_location, n_location, location_alpha);
+
+	// rotation, the same with angular speed and slerp
+	const float angular_speed = FMath::RadiansToDegrees(m_rotation.AngularDistance(n_rotation)) / n_dt;
+	m_angular_speed = FMath::Lerp(m_angular_speed, angular_speed, derivative_alpha);
+	const float rotation_alpha = alpha(m_settings.m_min_cutoff + m_settings.m_beta * m_angular_speed, n_dt);
+	m_rotation = FQuat::Slerp(m_rotation, n_rotation, rotation_alpha).GetNormalized();
+
+	n_location = m_location;
+	n_rotation = m_rotation;
+}
+
+void FDTrackPoseFilter::Axis::start(const float n_measurement_variance) {
+
+	// we know where it is but not how fast it goes
+	m_rate = 0.0f;
+	m_p[0][0] = n_measurement_variance;
+	m_p[0][1] = 0.0f;
+	m_p[1][0] = 0.0f;
+	m_p[1][1] = 1.0e4f;
+}
+
+void FDTrackPoseFilter::Axis::predict(const float n_dt, const float n_process_variance) {
+
+	// P = F P F' + Q with F = [1 dt; 0 1] and Q of white noise acceleration
+	const float dt2 = n_dt * n_dt;
+	const float p00 = m_p[0][0] + n_dt * (m_p[1][0] + m_p[0][1]) + dt2 * m_p[1][1];
+	const float p01 = m_p[0][1] + n_dt * m_p[1][1];
+	const float p10 = m_p[1][0] + n_dt * m_p[1][1];
+	const float p11 = m_p[1][1];
+
+	m_p[0][0] = p00 + n_process_variance * dt2 * dt2 * 0.25f;
+	m_p[0][1] = p01 + n_process_variance * dt2 * n_dt * 0.5f;
+	m_p[1][0] = p10 + n_process_variance * dt2 * n_dt * 0.5f;
+	m_p[1][1] = p11 + n_process_variance * dt2;
+}
+
+float FDTrackPoseFilter::Axis::update(const float n_innovation, const float n_measurement_variance) {
+
+	const float s = m_p[0][0] + n_measurement_variance;
+	const float k0 = m_p[0][0] / s;
+	const float k1 = m_p[1][0] / s;
+
+	m_rate += k1 * n_innovation;
+
+	const float p00 = m_p[0][0];
+	const float p01 = m_p[0][1];
+	m_p[0][0] = (1.0f - k0) * p00;
+	m_p[0][1] = (1.0f - k0) * p01;
+	m_p[1][0] -= k1 * p00;
+	m_p[1][1] -= k1 * p01;
+
+	return k0 * n_innovation;
+}
+
+void FDTrackPoseFilter::kalman(const float n_dt, FVector &n_location, FQuat &n_rotation) {
+
+	const float variance = FMath::Square(m_settings.m_measurement_noise);
+	const float process_variance = FMath::Square(m_settings.m_process_noise);
+	const float angular_variance = FMath::Square(FMath::DegreesToRadians(m_settings.m_measurement_noise));
+	const float angular_process_variance = FMath::Square(FMath::DegreesToRadians(m_settings.m_process_noise));
+
+	// position, each axis on its own
+	for (int32 i = 0; i < 3; i++) {
+		Axis &axis = m_position_axes[i];
+		m_location[i] += axis.m_rate * n_dt;
+		axis.predict(n_dt, process_variance);
+		m_location[i] += axis.update(n_location[i] - m_location[i], variance);
+	}
+
+	// rotation. Predict by turning at the angular rate, then correct by the rotation vector 
+	// from prediction to measurement. That vector is small, so its axes are independent enough
+	const FVector rate(m_rotation_axes[0].m_rate, m_rotation_axes[1].m_rate, m_rotation_axes[2].m_rate);
+	const FQuat predicted = (from_rotation_vector(rate * n_dt) * m_rotation).GetNormalized();
+	const FVector innovation = to_rotation_vector(n_rotation * predicted.Inverse());
+
+	FVector correction;
+	for (int32 i = 0; i < 3; i++) {
+		Axis &axis = m_rotation_axes[i];
+		axis.predict(n_dt, angular_process_variance);
+		correction[i] = axis.update(innovation[i], angular_variance);
+	}
+	m_rotation = (from_rotation_vector(correction) * predicted).GetNormalized();
+
+	n_location = m_location;
+	n_rotation = m_rotation;
+}
+
+/************************************************************************/
+/* All filters of a session                                             */
+/************************************************************************/
+FDTrackFilterBank::FDTrackFilterBank(const UDTrackComponent *n_client) {
+
+	m_defaults[static_cast<int32>(EDTrackTargetType::Body)] = n_client->m_body_filter;
+	m_defaults[static_cast<int32>(EDTrackTargetType::Flystick)] = n_client->m_flystick_filter;
+	m_defaults[static_cast<int32>(EDTrackTargetType::Hand)] = n_client->m_hand_filter;
+	m_by_id[static_cast<int32>(EDTrackTargetType::Body)] = n_client->m_body_filter_by_id;
+	m_by_id[static_cast<int32>(EDTrackTargetType::Flystick)] = n_client->m_flystick_filter_by_id;
+	m_by_id[static_cast<int32>(EDTrackTargetType::Hand)] = n_client->m_hand_filter_by_id;
+
+	for (int32 t = 0; t < NumTypes; t++) {
+		m_enabled |= (m_defaults[t].m_type != EDTrackSmoothing::SM_None);
+		for (const TPair<int32, FDTrackFilterSettings> &s : m_by_id[t]) {
+			m_enabled |= (s.Value.m_type != EDTrackSmoothing::SM_None);
+		}
+	}
+}
+
+bool FDTrackFilterBank::enabled() const {
+
+	return m_enabled;
+}
+
+const FDTrackFilterSettings &FDTrackFilterBank::settings(const EDTrackTargetType n_type, const int32 n_id) const {
+
+	const FDTrackFilterSettings *ret = m_by_id[static_cast<int32>(n_type)].Find(n_id);
+	return ret ? *ret : m_defaults[static_cast<int32>(n_type)];
+}
+
+void FDTrackFilterBank::filter(const EDTrackTargetType n_type, const int32 n_id, const double n_time, FVector &n_location, FRotator &n_rotation) {
+
+	if (n_id < 0) {
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackFilter);
+
+	// first time we see this one, decide whether it's filtered at all
+	const int32 type = static_cast<int32>(n_type);
+	if (!m_created[type].IsValidIndex(n_id) || !m_created[type][n_id]) {
+		if (m_created[type].Num() <= n_id) {
+			m_created[type].SetNumZeroed(n_id + 1);
+			m_filters[type].SetNum(n_id + 1);
+		}
+
+		const FDTrackFilterSettings &target_settings = settings(n_type, n_id);
+		if (target_settings.m_type != EDTrackSmoothing::SM_None) {
+			m_filters[type][n_id] = MakeUnique<FDTrackPoseFilter>(target_settings);
+		}
+		m_created[type][n_id] = true;
+	}
+
+	FDTrackPoseFilter *filter = m_filters[type][n_id].Get();
+	if (!filter) {
+		return;
+	}
+
+	FQuat rotation = n_rotation.Quaternion();
+	filter->filter(n_time, n_location, rotation);
+	n_rotation = rotation.Rotator();
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,122 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IDTrackPlugin.h"
+#include "DTrackInterface.h"
+
+class UDTrackComponent;
+
+/** @brief smooths the pose of one target
+ *
+ *	Fed with every pose the target has, in order. Rotations are filtered as 
+ *	quaternions, so there are no gimbal or wrap-around issues. Cost per pose 
+ *	is constant and there's no allocation.
+ */
+class FDTrackPoseFilter {
+
+	public:
+		explicit FDTrackPoseFilter(const FDTrackFilterSettings &n_settings);
+
+		/// replace n_location and n_rotation, measured at n_time in seconds, with their filtered values
+		void filter(const double n_time, FVector &n_location, FQuat &n_rotation);
+
+		/// start over with the next pose
+		void reset();
+
+		/// not fed for this long means the target was lost and we start over
+		static constexpr double ResetSeconds = 0.1;
+
+	private:
+		/// One Euro, see Casiez et al., "1 Euro Filter", CHI 2012
+		void one_euro(const float n_dt, FVector &n_location, FQuat &n_rotation);
+
+		/// constant velocity Kalman filter per axis, rotation as error state on the quaternion
+		void kalman(const float n_dt, FVector &n_location, FQuat &n_rotation);
+
+		/// Kalman filter of one axis with state value and rate
+		struct Axis {
+			float m_rate = 0.0f;
+			float m_p[2][2] = { { 0.0f, 0.0f }, { 0.0f, 0.0f } };
+
+			void start(const float n_measurement_variance);
+			void predict(const float n_dt, const float n_process_variance);
+
+			/// take a measurement deviating by n_innovation from the prediction, returns the correction
+			float update(const float n_innovation, const float n_measurement_variance);
+		};
+
+		/// smoothing factor of a low pass at n_cutoff Hz
+		static float alpha(const float n_cutoff, const float n_dt);
+
+		const FDTrackFilterSettings m_settings;
+
+		bool    m_started = false;
+		double  m_last_time = 0.0;
+		FVector m_location;                     //!< filtered
+		FQuat   m_rotation;
+
+		// One Euro
+		FVector m_velocity;                     //!< cm/s, low passed
+		float   m_angular_speed = 0.0f;         //!< degrees/s, low passed
+
+		// Kalman
+		Axis    m_position_axes[3];
+		Axis    m_rotation_axes[3];             //!< rotation vector, radians
+};
+
+/** @brief all filters of a session
+ *
+ *	Settings are taken from the client that started the session. Filters are 
+ *	created the first time a target shows up. Poll thread only.
+ */
+class FDTrackFilterBank {
+
+	public:
+		explicit FDTrackFilterBank(const UDTrackComponent *n_client);
+
+		/// true if any target is to be filtered at all
+		bool enabled() const;
+
+		/// filter a target's pose in place
+		void filter(const EDTrackTargetType n_type, const int32 n_id, const double n_time, FVector &n_location, FRotator &n_rotation);
+
+	private:
+		const FDTrackFilterSettings &settings(const EDTrackTargetType n_type, const int32 n_id) const;
+
+		static const int32 NumTypes = static_cast<int32>(EDTrackTargetType::Count);
+
+		FDTrackFilterSettings                  m_defaults[NumTypes];
+		TMap<int32, FDTrackFilterSettings>     m_by_id[NumTypes];
+
+		/// by target type and id. Null if not seen yet or not filtered
+		TArray< TUniquePtr<FDTrackPoseFilter> > m_filters[NumTypes];
+		TArray< bool >                          m_created[NumTypes];
+
+		bool m_enabled = false;
+};
@@ -0,0 +1,71 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackFingerKinematics.h"
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+FDTrackFingerKinematics::FDTrackFingerKinematics(const EDTrackCoordinateSystemType n_coordinate_system) {
+
+	// the same mapping as FDTrackPollThread::from_dtrack_location(), applied to x and y
+	switch (n_coordinate_system) {
+		default:
+		case EDTrackCoordinateSystemType::CST_Normal:
+			m_along = FVector(0.0f, 1.0f, 0.0f);
+			m_bend_axis = FVector(1.0f, 0.0f, 0.0f);
+			break;
+		case EDTrackCoordinateSystemType::CST_Unreal_Adapted:
+			m_along = FVector(1.0f, 0.0f, 0.0f);
+			m_bend_axis = FVector(0.0f, -1.0f, 0.0f);
+			break;
+		case EDTrackCoordinateSystemType::CST_Powerwall:
+			m_along = FVector(0.0f, 1.0f, 0.0f);
+			m_bend_axis = FVector(0.0f, 0.0f, 1.0f);
+			break;
+	}
+}
+
+void FDTrackFingerKinematics::solve(FDTrackFinger &n_finger) const {
+
+	// Each phalanx is its outer neighbour turned back by the angle between them. Unreal space
+	// is mirrored against DTrack's, which flips the sense of rotation, so the angle is positive here
+	const FQuat outer = n_finger.m_rotation.Quaternion();
+	const FQuat middle = outer * FQuat(m_bend_axis, FMath::DegreesToRadians(n_finger.m_middle_outer_phalanx_angle));
+	const FQuat inner = middle * FQuat(m_bend_axis, FMath::DegreesToRadians(n_finger.m_inner_middle_phalanx_angle));
+
+	// lengths come in mm, Unreal wants cm
+	const FVector tip = n_finger.m_location;
+	const FVector distal = tip - outer.RotateVector(m_along) * (n_finger.m_outer_phalanx_length / 10.0f);
+	const FVector middle_joint = distal - middle.RotateVector(m_along) * (n_finger.m_middle_phalanx_length / 10.0f);
+	const FVector knuckle = middle_joint - inner.RotateVector(m_along) * (n_finger.m_inner_phalanx_length / 10.0f);
+
+	n_finger.m_joints.m_knuckle = FTransform(inner, knuckle);
+	n_finger.m_joints.m_middle = FTransform(middle, middle_joint);
+	n_finger.m_joints.m_distal = FTransform(outer, distal);
+	n_finger.m_joints.m_tip = FTransform(outer, tip);
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,51 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DTrackInterface.h"
+
+/** @brief works out a finger's joints from what DTrack sends about it
+ *
+ *	DTrack gives the tip of a finger and the orientation of its outer phalanx, both
+ *	relative to the hand, plus the lengths of the three phalanges in mm and the angles
+ *	between them in degrees. Walking back from the tip along each phalanx and undoing 
+ *	each bend ends up at the knuckle. A phalanx points along DTrack's finger x axis 
+ *	and bends about its y axis, both mapped to Unreal space like any location.
+ */
+class FDTrackFingerKinematics {
+
+	public:
+		explicit FDTrackFingerKinematics(const EDTrackCoordinateSystemType n_coordinate_system);
+
+		/// fill n_finger's m_joints from the rest of it
+		void solve(FDTrackFinger &n_finger) const;
+
+	private:
+		FVector  m_along;        //!< DTrack's finger x axis in Unreal space, knuckle to tip
+		FVector  m_bend_axis;    //!< DTrack's finger y axis in Unreal space
+};
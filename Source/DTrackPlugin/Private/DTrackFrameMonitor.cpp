@@ -0,0 +1,182 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackFrameMonitor.h"
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+// the SDK's receive timeout is 1 s so the poll thread notices a missing stream after that at worst.
+// I don't rely on that and look at the last arrival time from the game thread instead
+const double FDTrackFrameMonitor::StallSeconds = 0.5;
+
+// DTrack2 needs a moment and a TCP round trip to start measuring, that's no stall yet
+const double FDTrackFrameMonitor::StartupSeconds = 5.0;
+const double FDTrackFrameMonitor::DegradedRatio = 0.01;
+
+FDTrackFrameMonitor::FDTrackFrameMonitor() {
+
+	reset();
+}
+
+void FDTrackFrameMonitor::reset() {
+
+	FScopeLock lock(&m_mutex);
+
+	m_stats = FDTrackStreamStats();
+	m_jitter.reset();
+	m_started = false;
+	m_last_counter = 0;
+	m_last_arrival = 0;
+	m_reset_cycles = FPlatformTime::Cycles64();
+	m_resume_cycles = 0;
+	m_period = 0.0;
+	m_window_start = 0;
+	m_window_first_counter = 0;
+	m_window_frames = 0;
+	m_window_lost = 0;
+	m_degraded = false;
+}
+
+void FDTrackFrameMonitor::frame(const uint32 n_frame_counter, const uint64 n_receive_cycles) {
+
+	FScopeLock lock(&m_mutex);
+
+	m_stats.m_frames++;
+	m_window_frames++;
+
+	if (!m_started) {
+		m_started = true;
+		m_last_counter = n_frame_counter;
+		m_last_arrival = n_receive_cycles;
+		m_window_start = n_receive_cycles;
+		m_window_first_counter = n_frame_counter;
+		return;
+	}
+
+	// unsigned difference handles the counter wrapping around
+	const uint32 ahead = n_frame_counter - m_last_counter;
+	const uint32 behind = m_last_counter - n_frame_counter;
+
+	if (ahead == 0) {
+		m_stats.m_duplicates++;
+		m_window_lost++;
+	} else if (behind <= ReorderWindow) {
+		// late arrival of a frame we counted as missing before
+		m_stats.m_out_of_order++;
+		if (m_stats.m_missing) {
+			m_stats.m_missing--;
+		}
+		m_window_lost++;
+	} else if (ahead < 0x80000000u) {
+		// regular case, possibly with a gap
+		const uint32 missing = ahead - 1;
+		m_stats.m_missing += missing;
+		m_window_lost += missing;
+
+		const double interval = FPlatformTime::ToSeconds64(n_receive_cycles - m_last_arrival);
+		
+		// a smoothed controller period lets me tell jitter from rate
+		const double period = interval / ahead;
+		m_period = (m_period > 0.0) ? (m_period * 0.95 + period * 0.05) : period;
+		m_jitter.add(FMath::Abs(interval - ahead * m_period) * 1000000.0);
+
+		m_last_counter = n_frame_counter;
+		m_last_arrival = n_receive_cycles;
+	} else {
+		// counter went back a long way. Controller restarted, start over with it
+		m_stats.m_restarts++;
+		m_last_counter = n_frame_counter;
+		m_last_arrival = n_receive_cycles;
+		m_window_first_counter = n_frame_counter;
+		m_period = 0.0;
+	}
+
+	if (FPlatformTime::ToSeconds64(n_receive_cycles - m_window_start) >= 1.0) {
+		close_window(n_receive_cycles);
+	}
+}
+
+void FDTrackFrameMonitor::close_window(const uint64 n_now) {
+
+	const double seconds = FPlatformTime::ToSeconds64(n_now - m_window_start);
+	const uint32 controller_frames = m_last_counter - m_window_first_counter;
+
+	m_stats.m_receive_rate = m_window_frames / seconds;
+	m_stats.m_controller_rate = controller_frames / seconds;
+	m_degraded = m_window_lost > (controller_frames * DegradedRatio);
+
+	m_window_start = n_now;
+	m_window_first_counter = m_last_counter;
+	m_window_frames = 0;
+	m_window_lost = 0;
+}
+
+void FDTrackFrameMonitor::set_stall_detection(const bool n_on) {
+
+	FScopeLock lock(&m_mutex);
+
+	if (n_on && !m_stall_detection) {
+		m_resume_cycles = FPlatformTime::Cycles64();
+	}
+	m_stall_detection = n_on;
+}
+
+EDTrackStreamState FDTrackFrameMonitor::state() const {
+
+	FScopeLock lock(&m_mutex);
+
+	const uint64 now = FPlatformTime::Cycles64();
+
+	if (!m_started) {
+		const uint64 since = FMath::Max(m_reset_cycles, m_resume_cycles);
+		const bool stalled = m_stall_detection && (FPlatformTime::ToSeconds64(now - since) > StartupSeconds);
+		return stalled ? EDTrackStreamState::SS_Stalled : EDTrackStreamState::SS_Ok;
+	}
+
+	const uint64 since = FMath::Max(m_last_arrival, m_resume_cycles);
+	if (m_stall_detection && (FPlatformTime::ToSeconds64(now - since) > StallSeconds)) {
+		return EDTrackStreamState::SS_Stalled;
+	}
+
+	return m_degraded ? EDTrackStreamState::SS_Degraded : EDTrackStreamState::SS_Ok;
+}
+
+FDTrackStreamStats FDTrackFrameMonitor::stats() const {
+
+	const EDTrackStreamState current_state = state();
+
+	FScopeLock lock(&m_mutex);
+
+	FDTrackStreamStats ret = m_stats;
+	ret.m_state = current_state;
+	ret.m_jitter_p50 = m_jitter.percentile(0.5);
+	ret.m_jitter_p99 = m_jitter.percentile(0.99);
+	ret.m_jitter_max = m_jitter.max();
+	ret.m_seconds_since_last_frame = m_started ? FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - m_last_arrival) : -1.0;
+	return ret;
+}
+
+#undef LOCTEXT_NAMESPACE
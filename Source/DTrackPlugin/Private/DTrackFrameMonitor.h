@@ -0,0 +1,94 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IDTrackPlugin.h"
+#include "DTrackLatencyProbe.h"
+
+/** @brief watches the frame counter for gaps, duplicates, reordering and stalls
+ *
+ *	The poll thread feeds every frame it receives. The game thread asks for the
+ *	stream state and statistics. Both are cheap enough to do every frame.
+ */
+class FDTrackFrameMonitor {
+
+	public:
+		FDTrackFrameMonitor();
+
+		/// a frame came in. Call from poll thread
+		void frame(const uint32 n_frame_counter, const uint64 n_receive_cycles);
+
+		/// state of the stream right now
+		EDTrackStreamState state() const;
+
+		/// snapshot of all statistics
+		FDTrackStreamStats stats() const;
+
+		/// start counting all over
+		void reset();
+
+		/// Off while frames only come on request, like a stepped replay. Switching it back 
+		/// on gives the stream StallSeconds from then on
+		void set_stall_detection(const bool n_on);
+
+	private:
+		/// evaluate the window that just ended, called with lock held
+		void close_window(const uint64 n_now);
+
+		/// no frame for this long and the stream is stalled
+		static const double StallSeconds;
+
+		/// no first frame for this long after a reset and the stream is stalled
+		static const double StartupSeconds;
+
+		/// more than this fraction of frames lost or out of order in a window and it's degraded
+		static const double DegradedRatio;
+
+		/// counter going back more than this is a controller restart rather than reordering
+		static const uint32 ReorderWindow = 100;
+
+		mutable FCriticalSection m_mutex;
+
+		FDTrackStreamStats  m_stats;
+		FDTrackLatencyHistogram m_jitter;    //!< deviation of arrival from where the rate says, in us
+
+		bool      m_started = false;
+		uint32    m_last_counter = 0;        //!< highest counter seen
+		uint64    m_last_arrival = 0;        //!< cycles
+		uint64    m_reset_cycles = 0;        //!< cycles when we started, to detect streams that never start
+		uint64    m_resume_cycles = 0;       //!< cycles when stall detection was switched back on
+		bool      m_stall_detection = true;
+		double    m_period = 0.0;            //!< seconds per controller frame, smoothed
+
+		// one second windows for rates and degradation
+		uint64    m_window_start = 0;
+		uint32    m_window_first_counter = 0;
+		uint32    m_window_frames = 0;
+		uint32    m_window_lost = 0;         //!< missing and out of order
+		bool      m_degraded = false;
+};
@@ -0,0 +1,192 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackLatencyProbe.h"
+
+#include <cmath>
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+namespace {
+
+	const int32 LinearBuckets = 1024;   // 1 us each
+	const int32 SubBuckets = 64;        // per power of two above that
+	const int32 Octaves = 24;           // up to ~4.7 hours, that ought to be enough
+	const int32 LinearOctave = 10;      // 2^10 = LinearBuckets
+
+	double to_microseconds(const uint64 n_from, const uint64 n_to) {
+
+		if (n_to <= n_from) {
+			return 0.0;
+		}
+
+		return FPlatformTime::ToMilliseconds64(n_to - n_from) * 1000.0;
+	}
+}
+
+/************************************************************************/
+/* Histogram                                                            */
+/************************************************************************/
+FDTrackLatencyHistogram::FDTrackLatencyHistogram() {
+
+	m_buckets.SetNumZeroed(LinearBuckets + Octaves * SubBuckets);
+}
+
+void FDTrackLatencyHistogram::add(const double n_microseconds) {
+
+	m_buckets[bucket(n_microseconds)]++;
+	m_count++;
+	m_max = FMath::Max(m_max, n_microseconds);
+}
+
+void FDTrackLatencyHistogram::reset() {
+
+	FMemory::Memzero(m_buckets.GetData(), m_buckets.Num() * sizeof(uint32));
+	m_count = 0;
+	m_max = 0.0;
+}
+
+uint64 FDTrackLatencyHistogram::count() const {
+
+	return m_count;
+}
+
+double FDTrackLatencyHistogram::max() const {
+
+	return m_max;
+}
+
+double FDTrackLatencyHistogram::percentile(const double n_fraction) const {
+
+	if (!m_count) {
+		return 0.0;
+	}
+
+	const uint64 rank = FMath::Max<uint64>(1, static_cast<uint64>(FMath::CeilToDouble(n_fraction * m_count)));
+	uint64 seen = 0;
+	for (int32 i = 0; i < m_buckets.Num(); i++) {
+		seen += m_buckets[i];
+		if (seen >= rank) {
+			// never report more than we've actually seen
+			return FMath::Min(bucket_value(i), m_max);
+		}
+	}
+
+	return m_max;
+}
+
+int32 FDTrackLatencyHistogram::bucket(const double n_microseconds) {
+
+	if (n_microseconds < LinearBuckets) {
+		return FMath::Max(0, static_cast<int32>(n_microseconds));
+	}
+
+	int32 exponent = 0;
+	const double mantissa = std::frexp(n_microseconds, &exponent);   // 0.5 <= mantissa < 1
+	const int32 octave = exponent - 1 - LinearOctave;
+	if (octave >= Octaves) {
+		return LinearBuckets + Octaves * SubBuckets - 1;
+	}
+
+	const int32 sub = static_cast<int32>((mantissa * 2.0 - 1.0) * SubBuckets);
+	return LinearBuckets + octave * SubBuckets + FMath::Clamp(sub, 0, SubBuckets - 1);
+}
+
+double FDTrackLatencyHistogram::bucket_value(const int32 n_bucket) {
+
+	// upper bound of the bucket so percentiles err on the pessimistic side
+	if (n_bucket < LinearBuckets) {
+		return n_bucket + 1.0;
+	}
+
+	const int32 octave = (n_bucket - LinearBuckets) / SubBuckets;
+	const int32 sub = (n_bucket - LinearBuckets) % SubBuckets;
+	return std::ldexp(1.0 + (sub + 1.0) / SubBuckets, octave + LinearOctave);
+}
+
+/************************************************************************/
+/* Probe                                                                */
+/************************************************************************/
+void FDTrackLatencyProbe::set_enabled(const bool n_enabled) {
+
+	m_enabled = n_enabled;
+}
+
+bool FDTrackLatencyProbe::enabled() const {
+
+	return m_enabled;
+}
+
+void FDTrackLatencyProbe::record(const FDTrackFrameStamps &n_stamps, const uint64 n_pickup, const uint64 n_dispatched) {
+
+	if (!m_enabled) {
+		return;
+	}
+
+	m_histograms[static_cast<int32>(EDTrackLatencyStage::Parse)].add(to_microseconds(n_stamps.m_received, n_stamps.m_parsed));
+	m_histograms[static_cast<int32>(EDTrackLatencyStage::Convert)].add(to_microseconds(n_stamps.m_parsed, n_stamps.m_converted));
+	m_histograms[static_cast<int32>(EDTrackLatencyStage::Publish)].add(to_microseconds(n_stamps.m_converted, n_stamps.m_published));
+	m_histograms[static_cast<int32>(EDTrackLatencyStage::Pickup)].add(to_microseconds(n_stamps.m_published, n_pickup));
+	m_histograms[static_cast<int32>(EDTrackLatencyStage::Dispatch)].add(to_microseconds(n_pickup, n_dispatched));
+	m_histograms[static_cast<int32>(EDTrackLatencyStage::Total)].add(to_microseconds(n_stamps.m_received, n_dispatched));
+}
+
+void FDTrackLatencyProbe::reset() {
+
+	for (FDTrackLatencyHistogram &histogram : m_histograms) {
+		histogram.reset();
+	}
+}
+
+FDTrackLatencyStats FDTrackLatencyProbe::stats(const EDTrackLatencyStage n_stage) const {
+
+	FDTrackLatencyStats ret;
+	if (n_stage >= EDTrackLatencyStage::Count) {
+		return ret;
+	}
+
+	const FDTrackLatencyHistogram &histogram = m_histograms[static_cast<int32>(n_stage)];
+	ret.m_count = histogram.count();
+	ret.m_p50 = histogram.percentile(0.5);
+	ret.m_p99 = histogram.percentile(0.99);
+	ret.m_max = histogram.max();
+	return ret;
+}
+
+void FDTrackLatencyProbe::print() const {
+
+	static const TCHAR *names[] = { TEXT("parse"), TEXT("convert"), TEXT("publish"), TEXT("pickup"), TEXT("dispatch"), TEXT("total") };
+	static_assert(ARRAY_COUNT(names) == static_cast<int32>(EDTrackLatencyStage::Count), "stage names out of sync");
+
+	UE_LOG(DTrackPluginLog, Display, TEXT("DTrack latency probe %s, in microseconds:"), m_enabled ? TEXT("on") : TEXT("off"));
+	UE_LOG(DTrackPluginLog, Display, TEXT("%-10s %10s %10s %10s %10s"), TEXT("stage"), TEXT("frames"), TEXT("p50"), TEXT("p99"), TEXT("max"));
+	for (int32 i = 0; i < static_cast<int32>(EDTrackLatencyStage::Count); i++) {
+		const FDTrackLatencyStats s = stats(static_cast<EDTrackLatencyStage>(i));
+		UE_LOG(DTrackPluginLog, Display, TEXT("%-10s %10llu %10.1f %10.1f %10.1f"), names[i], s.m_count, s.m_p50, s.m_p99, s.m_max);
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,98 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IDTrackPlugin.h"
+
+/** @brief time stamps a frame collects on its way through the pipeline
+ *
+ *	All are cycle counts as in FPlatformTime::Cycles64(). The poll thread fills
+ *	the first four, the game thread notes the rest when it dispatches the frame.
+ */
+struct FDTrackFrameStamps {
+	uint32 m_frame_counter = 0;
+	uint64 m_sequence = 0;       //!< counts published frames, starting with 1
+	uint64 m_received = 0;       //!< datagram arrived
+	uint64 m_parsed = 0;         //!< SDK is done parsing
+	uint64 m_converted = 0;      //!< all targets converted and injected
+	uint64 m_published = 0;      //!< frame swapped to front
+};
+
+/** @brief log-linear histogram of microsecond values
+ *
+ *	1 us resolution below 1 ms, above that 64 buckets per power of two which keeps
+ *	the relative error below 2%. Not thread safe, the probe only uses it in game thread.
+ */
+class FDTrackLatencyHistogram {
+
+	public:
+		FDTrackLatencyHistogram();
+
+		void add(const double n_microseconds);
+		void reset();
+
+		uint64 count() const;
+		double max() const;
+
+		/// value below which the given fraction (0..1) of all samples lie
+		double percentile(const double n_fraction) const;
+
+	private:
+		static int32 bucket(const double n_microseconds);
+		static double bucket_value(const int32 n_bucket);
+
+		TArray<uint32> m_buckets;
+		uint64         m_count = 0;
+		double         m_max = 0.0;
+};
+
+/** @brief measures how long frames take from arrival to dispatch
+ *
+ *	Fed with the stamps of each frame the game thread dispatches. Frames that 
+ *	were overwritten by newer ones before the game thread saw them don't count.
+ */
+class FDTrackLatencyProbe {
+
+	public:
+		void set_enabled(const bool n_enabled);
+		bool enabled() const;
+
+		/// record a dispatched frame
+		void record(const FDTrackFrameStamps &n_stamps, const uint64 n_pickup, const uint64 n_dispatched);
+
+		void reset();
+
+		FDTrackLatencyStats stats(const EDTrackLatencyStage n_stage) const;
+
+		/// log all stages
+		void print() const;
+
+	private:
+		bool                    m_enabled = false;
+		FDTrackLatencyHistogram m_histograms[static_cast<int32>(EDTrackLatencyStage::Count)];
+};
@@ -0,0 +1,91 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// this makes UBT allow windows types as (probably) used by the SDK header
+#if PLATFORM_WINDOWS
+#include "AllowWindowsPlatformTypes.h" 
+#endif
+
+#include "DTrackSDK.hpp"
+
+// revert above allowed types to UBT default
+#if PLATFORM_WINDOWS
+#include "HideWindowsPlatformTypes.h"
+#endif
+
+#include <cstring>
+
+/** @brief DTrack SDK with access to the raw datagram last received
+ *
+ *	The SDK receives into its own buffer and parses in place. It doesn't modify
+ *	the buffer while parsing, so after receive() the datagram is still in there 
+ *	and I can hand it to the capture recorder without another copy in the SDK.
+ */
+class FDTrackLiveSDK : public DTrackSDK {
+
+	public:
+		using DTrackSDK::DTrackSDK;
+
+		/// Receive buffer that takes the largest UDP datagram. The SDK's default of 32 KB 
+		/// cuts off frames with a few big human models
+		static const int32 DatagramBufferSize = 65536;
+
+		/// the last received datagram, null terminated as the SDK leaves it
+		const char *datagram() const {
+		
+			return d_udpbuf;
+		}
+
+		/// size of the last received datagram in bytes, excluding the terminator
+		int32 datagram_size() const {
+
+			if (!d_udpbuf || (d_udpbufsize <= 0)) {
+				return 0;
+			}
+
+			return static_cast<int32>(strnlen(d_udpbuf, d_udpbufsize));
+		}
+
+		/// cycle count when the last datagram arrived, before parsing started
+		uint64 receive_cycles() const {
+
+			return m_receive_cycles;
+		}
+
+		/// called by the SDK right after the datagram came in and before lines are parsed
+		void startFrame() override {
+
+			m_receive_cycles = FPlatformTime::Cycles64();
+			DTrackSDK::startFrame();
+		}
+
+	private:
+		uint64 m_receive_cycles = 0;
+};
@@ -0,0 +1,99 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackPlayout.h"
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+const double FDTrackPlayoutClock::RestartSeconds = 1.0;
+const double FDTrackPlayoutClock::WindowSeconds = 2.0;
+const double FDTrackPlayoutClock::MarginSeconds = 0.001;
+
+double FDTrackPlayoutClock::frame(const double n_timestamp, const double n_arrival) {
+
+	if (n_timestamp < 0.0) {
+		return n_arrival;
+	}
+
+	FScopeLock lock(&m_mutex);
+
+	const double offset = n_arrival - n_timestamp;
+
+	if (!m_started || (n_timestamp < m_last_timestamp - RestartSeconds) || (n_timestamp > m_last_timestamp + RestartSeconds)) {
+		m_started = true;
+		m_period = 0.0;
+		m_window_start = n_arrival;
+		m_window_min = offset;
+		m_previous_min = offset;
+		m_jitter.reset();
+		m_jitter_p99 = 0.0;
+		m_previous_p99 = 0.0;
+	} else if (n_timestamp > m_last_timestamp) {
+		const double period = n_timestamp - m_last_timestamp;
+		m_period = (m_period > 0.0) ? (0.95 * m_period + 0.05 * period) : period;
+	}
+	m_last_timestamp = FMath::Max(m_last_timestamp, n_timestamp);
+
+	if (n_arrival - m_window_start >= WindowSeconds) {
+		close_window(n_arrival);
+	}
+
+	m_window_min = FMath::Min(m_window_min, offset);
+
+	// the best offset in the last two windows. Frames are never placed after they arrived
+	const double best = FMath::Min(m_window_min, m_previous_min);
+	m_jitter.add((offset - best) * 1000000.0);
+
+	return n_timestamp + best;
+}
+
+void FDTrackPlayoutClock::close_window(const double n_arrival) {
+
+	m_previous_min = m_window_min;
+	m_window_min = TNumericLimits<double>::Max();
+	m_window_start = n_arrival;
+
+	m_previous_p99 = m_jitter_p99;
+	m_jitter_p99 = m_jitter.count() ? m_jitter.percentile(0.99) / 1000000.0 : 0.0;
+	m_jitter.reset();
+}
+
+double FDTrackPlayoutClock::suggested_delay() const {
+
+	FScopeLock lock(&m_mutex);
+
+	// until the first window closed, what we have so far
+	const double current = m_jitter.count() ? m_jitter.percentile(0.99) / 1000000.0 : 0.0;
+	return m_period + FMath::Max3(m_jitter_p99, m_previous_p99, current) + MarginSeconds;
+}
+
+void FDTrackPlayoutClock::reset() {
+
+	FScopeLock lock(&m_mutex);
+	m_started = false;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,86 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DTrackLatencyProbe.h"
+
+/** @brief takes network jitter out of frame arrival times
+ *
+ *	DTrack stamps each frame when it was measured. The offset between that and 
+ *	our arrival time is the transport delay, which is smallest for frames that 
+ *	came through without waiting anywhere. So the smallest offset seen lately plus 
+ *	the DTrack timestamp tells when a frame would have arrived on a perfect network.
+ *	That's the time poses are stored and played out by.
+ *
+ *	The extra delay of the others is the jitter. A playout buffer has to wait one
+ *	frame period plus about that long to always have a sample on either side of
+ *	the time it plays. That's the delay suggested here.
+ *
+ *	The poll thread feeds every frame, the game thread asks for the delay.
+ */
+class FDTrackPlayoutClock {
+
+	public:
+		/**
+		 * A frame DTrack stamped with n_timestamp came in at n_arrival, in FPlatformTime::Seconds().
+		 * Returns its arrival time without jitter. Without timestamp that's n_arrival as is.
+		 */
+		double frame(const double n_timestamp, const double n_arrival);
+
+		/// delay a playout buffer needs to ride out the jitter seen lately, in seconds
+		double suggested_delay() const;
+
+		void reset();
+
+	private:
+		/// close the current window, called with lock held
+		void close_window(const double n_arrival);
+
+		/// timestamp jumps larger than this mean DTrack restarted or it's midnight
+		static const double RestartSeconds;
+
+		/// the smallest offset is tracked in windows this long so it can follow drift
+		static const double WindowSeconds;
+
+		/// safety margin on top of period and jitter
+		static const double MarginSeconds;
+
+		mutable FCriticalSection m_mutex;
+
+		bool      m_started = false;
+		double    m_last_timestamp = 0.0;
+		double    m_period = 0.0;                //!< seconds between DTrack timestamps, smoothed
+
+		double    m_window_start = 0.0;
+		double    m_window_min = 0.0;            //!< smallest offset in the current window
+		double    m_previous_min = 0.0;          //!< and in the one before
+
+		FDTrackLatencyHistogram m_jitter;        //!< of the current window, in us
+		double    m_jitter_p99 = 0.0;            //!< seconds, worse of the last two windows
+		double    m_previous_p99 = 0.0;
+};
@@ -25,30 +25,40 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "DTrackPollThread.h"
+#include "DTrackSession.h"
+#include "DTrackComponent.h"
+#include "DTrackDataSource.h"
+#include "DTrackCapture.h"
+#include "DTrackStats.h"
 
-// this makes UBT allow windows types as (probably) used by the SDK header
-// @todo check if this is indeed the case and remove if not needed
-#include "AllowWindowsPlatformTypes.h" 
-
-#include "DTrackSDK.hpp"
-
-// revert above allowed types to UBT default
-#include "HideWindowsPlatformTypes.h"
 #include "Async.h"
+#include "Async/ParallelFor.h"
+#include "Misc/Paths.h"
 
 #define LOCTEXT_NAMESPACE "DTrackPlugin"
 
-FDTrackPollThread *FDTrackPollThread::m_runnable = nullptr;
+// relative capture paths are meant to be in the project's saved dir
+static FString saved_path(const FString &n_file_name) {
+
+	if (FPaths::IsRelative(n_file_name)) {
+		return FPaths::Combine(FPaths::ProjectSavedDir(), n_file_name);
+	}
 
+	return n_file_name;
+}
 
 
-FDTrackPollThread::FDTrackPollThread(const UDTrackComponent *n_client, FDTrackPlugin *n_plugin)
-		: m_plugin(n_plugin)
+FDTrackPollThread::FDTrackPollThread(const UDTrackComponent *n_client, FDTrackSession *n_session, FDTrackDataSource *n_source)
+		: m_thread(nullptr)
+		, m_session(n_session)
 		, m_dtrack2(n_client->m_dtrack_2)
 		, m_dtrack_server_ip(TCHAR_TO_UTF8(*n_client->m_dtrack_server_ip))
 		, m_dtrack_server_port(n_client->m_dtrack_server_port)
+		, m_capture_file(n_client->m_capture_file)
+		, m_replay_file(n_client->m_replay_file)
 		, m_coordinate_system(n_client->m_coordinate_system)
-		, m_stop_counter(0) {
+		, m_stop_counter(0)
+		, m_finger_kinematics(n_client->m_coordinate_system) {
 
 	// well, let's just say I don't know how to use the initializer list on them
 	FMatrix &trafo_normal = const_cast<FMatrix &>(m_trafo_normal);
@@ -84,7 +94,35 @@ FDTrackPollThread::FDTrackPollThread(const UDTrackComponent *n_client, FDTrackPl
 	// transposed is cached
 	const_cast<FMatrix &>(m_trafo_unreal_adapted_transposed) = trafo_unreal_adapted.GetTransposed();
 
-	m_thread = FRunnableThread::Create(this, TEXT("FDTrackPollThread"), 0, TPri_Normal);
+	// somebody wants to drive us without a thread
+	if (n_source) {
+		m_source.reset(n_source);
+		return;
+	}
+
+	// A replay is used in place of the live system if configured. I create the source 
+	// right here so replay controls can be reached from the game thread the whole time.
+	// A multicast group is received without talking to the controller, cluster secondaries 
+	// listen to their primary only
+	if (!m_replay_file.IsEmpty()) {
+		m_replay = new FDTrackReplaySource(saved_path(m_replay_file), n_client->m_replay_speed, 
+				n_client->m_replay_stepped, n_client->m_replay_loop);
+		m_source.reset(m_replay);
+	} else if (n_client->m_cluster_role == EDTrackClusterRole::CR_Secondary) {
+		// only join if it's a group, otherwise it's broadcast or sent straight to us
+		FIPv4Address address;
+		const bool multicast = FIPv4Address::Parse(n_client->m_cluster_address, address) && address.IsMulticastAddress();
+		m_cluster = new FDTrackClusterSource(multicast ? n_client->m_cluster_address : FString(), 
+				n_client->m_multicast_interface, n_client->m_cluster_port);
+		m_source.reset(m_cluster);
+	} else if (!n_client->m_multicast_group.IsEmpty()) {
+		m_source.reset(new FDTrackMulticastSource(n_client->m_multicast_group, n_client->m_multicast_interface, m_dtrack_server_port));
+	} else {
+		m_source.reset(new FDTrackLiveSource(m_dtrack2, m_dtrack_server_ip, m_dtrack_server_port));
+	}
+
+	// one thread per endpoint, name them apart for profiling
+	m_thread = FRunnableThread::Create(this, *FString::Printf(TEXT("FDTrackPollThread %s"), *FDTrackSession::endpoint(n_client)), 0, TPri_Normal);
 }
 
 FDTrackPollThread::~FDTrackPollThread() {
@@ -93,17 +131,15 @@ FDTrackPollThread::~FDTrackPollThread() {
 		delete m_thread;
 		m_thread = nullptr;
 	}
-
-	m_runnable = nullptr;
 }
 
-FDTrackPollThread *FDTrackPollThread::start(const UDTrackComponent *n_client, FDTrackPlugin *n_plugin) {
+FDTrackPollThread *FDTrackPollThread::start(const UDTrackComponent *n_client, FDTrackSession *n_session) {
 	
-	// Create new instance of thread if it does not exist and the platform supports multi threading
-	if (!m_runnable && FPlatformProcess::SupportsMultithreading()) {
-		m_runnable = new FDTrackPollThread(n_client, n_plugin);
+	// Create new instance of thread if the platform supports multi threading
+	if (FPlatformProcess::SupportsMultithreading()) {
+		return new FDTrackPollThread(n_client, n_session);
 	}
-	return m_runnable;
+	return nullptr;
 }
 
 void FDTrackPollThread::interrupt() {
@@ -113,7 +149,14 @@ void FDTrackPollThread::interrupt() {
 
 void FDTrackPollThread::join() {
 
-	m_thread->WaitForCompletion();
+	if (m_thread) {
+		m_thread->WaitForCompletion();
+	}
+}
+
+FDTrackReplaySource *FDTrackPollThread::replay() {
+
+	return m_replay;
 }
 
 bool FDTrackPollThread::Init() {
@@ -131,59 +174,102 @@ uint32 FDTrackPollThread::Run() {
 	// Initial wait before starting
 	FPlatformProcess::Sleep(0.1);
 
-	if (m_dtrack2) {
-		m_dtrack.reset(new DTrackSDK(m_dtrack_server_ip, m_dtrack_server_port));
-	} else {
-		m_dtrack.reset(new DTrackSDK(m_dtrack_server_port));
-	}
-
-	// I don't know when this can occur but I guess it's client
-	// port collision with fixed UDP ports
-	if (!m_dtrack->isLocalDataPortValid()) {
-		m_dtrack.reset();
+	if (!begin()) {
 		return 0;
 	}
 
-	// start the tracking via tcp route if applicable
-	if (m_dtrack2) {
-		if (!m_dtrack->startMeasurement()) {
-			if (m_dtrack->getLastServerError() == DTrackSDK::ERR_TIMEOUT) {
-				UE_LOG(DTrackPluginLog, Error, TEXT("Could not start tracking, timeout"));
-			} else if (m_dtrack->getLastServerError() == DTrackSDK::ERR_NET) {
-				UE_LOG(DTrackPluginLog, Error, TEXT("Could not start tracking, network error"));
-			} else {
-				UE_LOG(DTrackPluginLog, Error, TEXT("Could not start tracking"));
-			}
-			return 0;
-		} 
-	} 
-
 	// now go looping until Stop() increases the stop condition
 	while (!m_stop_counter.GetValue()) {
-		// receive as much as we can
-		if (m_dtrack->receive()) {
+		poll();
+	}
+
+	end();
 
-			m_plugin->begin_injection();
+	return 1;
+
+}
 
-			// treat body info and cache results into plug-in
-			handle_bodies();
-			handle_flysticks();
-			handle_hands();
-			handle_human_model();
-		
-			m_plugin->end_injection();
+bool FDTrackPollThread::begin() {
+
+	if (!m_source->start()) {
+		return false;
+	}
+
+	// the handlers only read parsed data, which looks the same for every source
+	m_dtrack = &m_source->parser();
+	m_converted = m_source->converted();
+
+	if (!m_capture_file.IsEmpty()) {
+		m_capture.reset(new FDTrackCaptureWriter(saved_path(m_capture_file)));
+		if (!m_capture->is_open()) {
+			m_capture.reset();
 		}
 	}
 
-	if (m_dtrack2) {
-		UE_LOG(DTrackPluginLog, Display, TEXT("Stopping DTrack2 measurement."));
-		m_dtrack->stopMeasurement();
+	return true;
+}
+
+bool FDTrackPollThread::poll() {
+
+	bool received = false;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_DTrackReceive);
+		DTRACK_TRACE_SCOPE(DTrackReceive);
+
+		// receive as much as we can
+		received = m_source->receive();
 	}
 
-	m_dtrack.reset();
+	if (received) {
+		const uint64 parsed = FPlatformTime::Cycles64();
+		SET_CYCLE_COUNTER(STAT_DTrackParse, static_cast<uint32>(parsed - m_source->receive_cycles()));
 
-	return 1;
+		record_datagram();
+
+		m_session->begin_injection(m_source->frame_counter(), m_source->timestamp(), m_source->receive_cycles(), parsed);
+
+		{
+			SCOPE_CYCLE_COUNTER(STAT_DTrackConvert);
+			DTRACK_TRACE_SCOPE(DTrackConvert);
 
+			if (m_converted) {
+				// somebody did the work already
+				m_session->inject_frame(*m_converted);
+			} else {
+				// treat body info and cache results into plug-in
+				handle_bodies();
+				handle_flysticks();
+				handle_hands();
+				handle_human_model();
+			}
+		}
+	
+		m_session->end_injection();
+
+		count_frame();
+	} else if (m_source->parse_error()) {
+		// those are the interesting ones when hunting bugs
+		record_datagram();
+	} else if (m_cluster) {
+		// the primary told us which frame to show
+		uint32 frame_counter = 0;
+		double timestamp = -1.0;
+		if (m_cluster->take_sync(frame_counter, timestamp)) {
+			m_session->lock_to(frame_counter, timestamp);
+		}
+	}
+
+	return received;
+}
+
+void FDTrackPollThread::end() {
+
+	// flushes and writes the index
+	m_capture.reset();
+
+	m_source->stop();
+	m_dtrack = nullptr;
+	m_converted = nullptr;
 }
 
 void FDTrackPollThread::Stop() {
@@ -196,6 +282,25 @@ void FDTrackPollThread::Exit() {
 
 }
 
+void FDTrackPollThread::count_frame() {
+
+	m_rate_frames++;
+
+	const uint64 now = FPlatformTime::Cycles64();
+	if (FPlatformTime::ToSeconds64(now - m_rate_start) >= 1.0) {
+		SET_DWORD_STAT(STAT_DTrackFrameRate, m_rate_frames);
+		m_rate_frames = 0;
+		m_rate_start = now;
+	}
+}
+
+void FDTrackPollThread::record_datagram() {
+
+	if (m_capture) {
+		m_capture->record(m_source->datagram(), m_source->datagram_size(), m_source->receive_cycles(), m_source->frame_counter());
+	}
+}
+
 void FDTrackPollThread::handle_bodies() {
 
 	const DTrack_Body_Type_d *body = nullptr;
@@ -204,13 +309,13 @@ void FDTrackPollThread::handle_bodies() {
 		checkf(body, TEXT("DTrack API error, body address null"));
 
 		if (body->quality > 0) {
-			// Quality below zero means the body is not visible to the system right now. I won't call the interface
-
 			FVector translation = from_dtrack_location(body->loc);
 			FRotator rotation = from_dtrack_rotation(body->rot);
 
-	//		FScopeLock lock(m_plugin->bodies_mutex());
-			m_plugin->inject_body_data(body->id, translation, rotation);
+			m_session->inject_body_data(body->id, static_cast<float>(body->quality), translation, rotation);
+		} else {
+			// Quality below zero means the body is not visible to the system right now
+			m_session->inject_body_occluded(body->id);
 		}
 	}
 }
@@ -222,103 +327,141 @@ void FDTrackPollThread::handle_flysticks() {
 		flystick = m_dtrack->getFlyStick(i);
 		checkf(flystick, TEXT("DTrack API error, flystick address null"));
 
+		// create a state vector for the button states
+		TArray<int> buttons;
+		buttons.SetNumZeroed(flystick->num_button);
+		for (int idx = 0; idx < flystick->num_button; idx++) {
+			buttons[idx] = flystick->button[idx];
+		}
+
+		// create a state vector for the joystick states
+		TArray<float> joysticks;  // have to use float as blueprints don't support TArray<double>
+		joysticks.SetNumZeroed(flystick->num_joystick);
+		for (int idx = 0; idx < flystick->num_joystick; idx++) {
+			joysticks[idx] = static_cast<float>(flystick->joystick[idx]);
+		}
+
 		if (flystick->quality > 0) {
-			// Quality below zero means the body is not visible to the system right now. I won't call the interface
 			FVector translation = from_dtrack_location(flystick->loc);
 			FRotator rotation = from_dtrack_rotation(flystick->rot);
 
-			// create a state vector for the button states
-			TArray<int> buttons;
-			buttons.SetNumZeroed(flystick->num_button);
-			for (int idx = 0; idx < flystick->num_button; idx++) {
-				buttons[idx] = flystick->button[idx];
-			}
+			m_session->inject_flystick_data(flystick->id, static_cast<float>(flystick->quality), translation, rotation, buttons, joysticks);
+		} else {
+			// not visible to the system right now. Buttons still work though
+			m_session->inject_flystick_occluded(flystick->id, buttons, joysticks);
+		}
+	}
+}
 
-			// create a state vector for the joystick states
-			TArray<float> joysticks;  // have to use float as blueprints don't support TArray<double>
-			joysticks.SetNumZeroed(flystick->num_joystick);
-			for (int idx = 0; idx < flystick->num_joystick; idx++) {
-				joysticks[idx] = static_cast<float>(flystick->joystick[idx]);
-			}
+void FDTrackPollThread::handle_hands() {
 
-	//		FScopeLock lock(m_plugin->flystick_mutex());
-			m_plugin->inject_flystick_data(flystick->id, translation, rotation, buttons, joysticks);
+	// Fingers make up most of the work. Every hand is converted into its own slot, in 
+	// parallel if there are enough, and then injected in DTrack's order whoever finished first.
+	// The session isn't thread safe and doesn't need to be that way
+	const int32 num_hands = m_dtrack->getNumHand();
+	m_hands.SetNum(num_hands, false);
+	ParallelFor(num_hands, [this](const int32 n_index) {
+		convert_hand(n_index);
+	}, num_hands < MinParallelHands);
+
+	for (const ConvertedHand &hand : m_hands) {
+		if (hand.m_measured) {
+			m_session->inject_hand_data(hand.m_id, hand.m_right, hand.m_quality, hand.m_location, hand.m_rotation, hand.m_fingers);
+		} else {
+			m_session->inject_hand_occluded(hand.m_id, hand.m_right);
 		}
 	}
 }
 
-void FDTrackPollThread::handle_hands() {
+void FDTrackPollThread::convert_hand(const int32 n_index) {
 
-	const DTrack_Hand_Type_d *hand = nullptr;
-	for (int i = 0; i < m_dtrack->getNumHand(); i++) {
-		hand = m_dtrack->getHand(i);
-		checkf(hand, TEXT("DTrack API error, hand address is null"));
-
-		if (hand->quality > 0) {
-			FVector translation = from_dtrack_location(hand->loc);
-			FRotator rotation = from_dtrack_rotation(hand->rot);
-			TArray<FDTrackFinger> fingers;
-
-			for (int j = 0; j < hand->nfinger; j++) {
-				FDTrackFinger finger;
-				switch (j) {     // this is mostly to allow for the blueprint to be a 
-								 // little more expressive than using assumptions about the index' meaning
-					case 0: finger.m_type = EDTrackFingerType::FT_Thumb; break;
-					case 1: finger.m_type = EDTrackFingerType::FT_Index; break;
-					case 2: finger.m_type = EDTrackFingerType::FT_Middle; break;
-					case 3: finger.m_type = EDTrackFingerType::FT_Ring; break;
-					case 4: finger.m_type = EDTrackFingerType::FT_Pinky; break;
-				}
-
-				finger.m_location = from_dtrack_location(hand->finger[j].loc);
-				finger.m_rotation = from_dtrack_rotation(hand->finger[j].rot);
-				finger.m_tip_radius = hand->finger[j].radiustip;
-				finger.m_inner_phalanx_length = hand->finger[j].lengthphalanx[2];
-				finger.m_middle_phalanx_length = hand->finger[j].lengthphalanx[1];
-				finger.m_outer_phalanx_length = hand->finger[j].lengthphalanx[0];
-				finger.m_inner_middle_phalanx_angle = hand->finger[j].anglephalanx[1];
-				finger.m_middle_outer_phalanx_angle = hand->finger[j].anglephalanx[0];
-				fingers.Add(std::move(finger));
-			}
+	const DTrack_Hand_Type_d *hand = m_dtrack->getHand(n_index);
+	checkf(hand, TEXT("DTrack API error, hand address is null"));
 
-	//		FScopeLock lock(m_plugin->hand_mutex());
-			m_plugin->inject_hand_data(hand->id, (hand->lr == 1), translation, rotation, fingers);
+	ConvertedHand &ret = m_hands[n_index];
+	ret.m_id = hand->id;
+	ret.m_right = (hand->lr == 1);
+	ret.m_measured = (hand->quality > 0);
+	ret.m_fingers.Reset();
+	if (!ret.m_measured) {
+		return;
+	}
+
+	ret.m_quality = static_cast<float>(hand->quality);
+	ret.m_location = from_dtrack_location(hand->loc);
+	ret.m_rotation = from_dtrack_rotation(hand->rot);
+
+	for (int j = 0; j < hand->nfinger; j++) {
+		FDTrackFinger finger;
+		switch (j) {     // this is mostly to allow for the blueprint to be a 
+						 // little more expressive than using assumptions about the index' meaning
+			case 0: finger.m_type = EDTrackFingerType::FT_Thumb; break;
+			case 1: finger.m_type = EDTrackFingerType::FT_Index; break;
+			case 2: finger.m_type = EDTrackFingerType::FT_Middle; break;
+			case 3: finger.m_type = EDTrackFingerType::FT_Ring; break;
+			case 4: finger.m_type = EDTrackFingerType::FT_Pinky; break;
 		}
+
+		finger.m_location = from_dtrack_location(hand->finger[j].loc);
+		finger.m_rotation = from_dtrack_rotation(hand->finger[j].rot);
+		finger.m_tip_radius = hand->finger[j].radiustip;
+		finger.m_inner_phalanx_length = hand->finger[j].lengthphalanx[2];
+		finger.m_middle_phalanx_length = hand->finger[j].lengthphalanx[1];
+		finger.m_outer_phalanx_length = hand->finger[j].lengthphalanx[0];
+		finger.m_inner_middle_phalanx_angle = hand->finger[j].anglephalanx[1];
+		finger.m_middle_outer_phalanx_angle = hand->finger[j].anglephalanx[0];
+		m_finger_kinematics.solve(finger);
+		ret.m_fingers.Add(std::move(finger));
 	}
 }
 
 void FDTrackPollThread::handle_human_model() {
+
+	// like hands, converted in parallel and injected in order
+	const int32 num_humans = m_dtrack->getNumHuman();
+	m_humans.SetNum(num_humans, false);
+	ParallelFor(num_humans, [this](const int32 n_index) {
+		convert_human(n_index);
+	}, num_humans < MinParallelHumans);
+
+	for (const ConvertedHuman &human : m_humans) {
+		m_session->inject_human_model_data(human.m_id, human.m_quality, human.m_joints);
+	}
+}
+
+void FDTrackPollThread::convert_human(const int32 n_index) {
 	
-	const DTrack_Human_Type_d *human = nullptr;
-	for (int i = 0; i < m_dtrack->getNumHuman(); i++) {
-		human = m_dtrack->getHuman(i);
-		checkf(human, TEXT("DTrack API error, human address is null"));
-
-		TArray<FDTrackJoint> joints;
-
-		for (int j = 0; j < human->num_joints; j++) {
-			FDTrackJoint joint;
-			// I'm not sure if I should check for quality as I don't know if the caller
-			// would expect number and order of joints to be relevant/constant.
-			// They do carry an ID though so I suppose the caller must be aware of that.
-			if (human->joint[j].quality > 0.1) {
-				joint.m_id = human->joint[j].id;
-				joint.m_location = from_dtrack_location(human->joint[j].loc);
-				joint.m_rotation = from_dtrack_rotation(human->joint[j].rot);
-				joint.m_angles.Add(human->joint[j].ang[0]);   // well, are they Euler angles of the same rot as above or not?
-				joint.m_angles.Add(human->joint[j].ang[1]);
-				joint.m_angles.Add(human->joint[j].ang[2]);
-				joints.Add(std::move(joint));
-			}
+	const DTrack_Human_Type_d *human = m_dtrack->getHuman(n_index);
+	checkf(human, TEXT("DTrack API error, human address is null"));
+
+	ConvertedHuman &ret = m_humans[n_index];
+	ret.m_id = human->id;
+	ret.m_joints.Reset();
+
+	double quality = 0.0;
+
+	for (int j = 0; j < human->num_joints; j++) {
+		FDTrackJoint joint;
+		// I'm not sure if I should check for quality as I don't know if the caller
+		// would expect number and order of joints to be relevant/constant.
+		// They do carry an ID though so I suppose the caller must be aware of that.
+		if (human->joint[j].quality > 0.1) {
+			joint.m_id = human->joint[j].id;
+			joint.m_location = from_dtrack_location(human->joint[j].loc);
+			joint.m_rotation = from_dtrack_rotation(human->joint[j].rot);
+			joint.m_angles.Add(human->joint[j].ang[0]);   // well, are they Euler angles of the same rot as above or not?
+			joint.m_angles.Add(human->joint[j].ang[1]);
+			joint.m_angles.Add(human->joint[j].ang[2]);
+			ret.m_joints.Add(std::move(joint));
+			quality += human->joint[j].quality;
 		}
-
-	//	FScopeLock lock(m_plugin->human_mutex());
-		m_plugin->inject_human_model_data(human->id, joints);
 	}
+
+	ret.m_quality = ret.m_joints.Num() ? static_cast<float>(quality / ret.m_joints.Num()) : 0.0f;
 }
 
 // translate a DTrack body location (translation in mm) into Unreal Location (in cm)
-FVector FDTrackPollThread::from_dtrack_location(const double(&n_translation)[3]) {
+FVector FDTrackPollThread::from_dtrack_location(const double(&n_translation)[3]) const {
 
 	FVector ret;
 
@@ -347,7 +490,7 @@ FVector FDTrackPollThread::from_dtrack_location(const double(&n_translation)[3])
 }
 
 // translate a DTrack 3x3 rotation matrix (translation in mm) into Unreal Location (in cm)
-FRotator FDTrackPollThread::from_dtrack_rotation(const double(&n_matrix)[9]) {
+FRotator FDTrackPollThread::from_dtrack_rotation(const double(&n_matrix)[9]) const {
 
 	// take DTrack matrix and put the values into FMatrix 
 	// ( M[RowIndex][ColumnIndex], DTrack matrix comes column-wise )
@@ -29,35 +29,47 @@
 #include "CoreMinimal.h"
 #include "HAL/Runnable.h"
 #include "HAL/ThreadSafeCounter.h"
+#include "DTrackInterface.h"
+#include "DTrackFingerKinematics.h"
 
 #include <memory>
 #include <string>
 
 class FDTrackPollThread;
-class DTrackSDK;
+class DTrackParser;
+class FDTrackDataSource;
+class FDTrackReplaySource;
+class FDTrackClusterSource;
+class FDTrackCaptureWriter;
 class DTrackComponent;
-class FDTrackPlugin;
+class FDTrackSession;
+struct FDTrackClusterFrame;
 
 /** @brief thread encapsulating all ART SDK interaction
  */
 class FDTrackPollThread : public FRunnable {
 
 	public:
-		FDTrackPollThread(const UDTrackComponent *n_client, FDTrackPlugin *n_plugin);
+		/**
+		 * Sets up the data source according to the client's settings and starts the thread.
+		 * If a source is given, it is used instead, no thread is started and the caller 
+		 * drives it via begin(), poll() and end(). That's for benchmarking.
+		 */
+		FDTrackPollThread(const UDTrackComponent *n_client, FDTrackSession *n_session, FDTrackDataSource *n_source = nullptr);
 		~FDTrackPollThread();
 		
-		/** Singleton instance, can access the thread any time via static accessor
-		 */
-		static FDTrackPollThread *m_runnable;
-
 		/**	Start the thread and the worker from static
-			This function returns a handle to the newly started instance.
+			This function returns a handle to the newly started instance,
+			one for each session.
 		 */
-		static FDTrackPollThread* start(const UDTrackComponent *n_client, FDTrackPlugin *n_plugin);
+		static FDTrackPollThread* start(const UDTrackComponent *n_client, FDTrackSession *n_session);
 	
 		void interrupt();
 		void join();
 
+		/// the replay source if we're playing back a capture, null when live
+		FDTrackReplaySource *replay();
+
 		/// does nothing, SDK is initialized in run
 		bool Init() override;
 
@@ -65,6 +77,15 @@ class FDTrackPollThread : public FRunnable {
 		// 0 is failure
 		uint32 Run() override;
 
+		/// start the source. Logs and returns false on error
+		bool begin();
+
+		/// receive one frame and publish it. False if none came in
+		bool poll();
+
+		/// counterpart to begin()
+		void end();
+
 		/// This is called if a thread is requested to terminate early.
 		void Stop() override;
 
@@ -85,25 +106,83 @@ class FDTrackPollThread : public FRunnable {
 		/// treat human model tracking info and send it to the plug-in
 		void handle_human_model();
 
+		/// convert the n_index'th hand of the current frame into m_hands. Any thread
+		void convert_hand(const int32 n_index);
+
+		/// convert the n_index'th human of the current frame into m_humans. Any thread
+		void convert_human(const int32 n_index);
+
 		/// translate dtrack rotation matrix to rotator according to selected room calibration
-		FRotator from_dtrack_rotation(const double(&n_matrix)[9]);
+		FRotator from_dtrack_rotation(const double(&n_matrix)[9]) const;
 
 		/// translate dtrack translation to unreal space
-		FVector from_dtrack_location(const double(&n_translation)[3]);
+		FVector from_dtrack_location(const double(&n_translation)[3]) const;
+
+		/// below that many in a frame, converting in parallel costs more than it saves
+		static const int32 MinParallelHands = 4;
+		static const int32 MinParallelHumans = 2;
+
+		/// a hand converted on a worker, injected in DTrack's order afterwards
+		struct ConvertedHand {
+			bool                   m_measured = false;
+			int                    m_id = 0;
+			bool                   m_right = false;
+			float                  m_quality = 0.0f;
+			FVector                m_location = FVector::ZeroVector;
+			FRotator               m_rotation = FRotator::ZeroRotator;
+			TArray<FDTrackFinger>  m_fingers;
+		};
+
+		/// the same for humans
+		struct ConvertedHuman {
+			int                    m_id = 0;
+			float                  m_quality = 0.0f;    //!< average of the tracked joints
+			TArray<FDTrackJoint>   m_joints;
+		};
+
+		/// one slot per hand and human of the current frame, each written by one worker only. Kept to save allocations
+		TArray<ConvertedHand>  m_hands;
+		TArray<ConvertedHuman> m_humans;
 
 		
 		FRunnableThread   *m_thread;       //!< Thread to run the worker FRunnable on
 		FThreadSafeCounter m_stop_counter; //!< atomic stop counter
-		FDTrackPlugin     *m_plugin;       //!< during runtime, plugin gets data injected
+		FDTrackSession    *m_session;      //!< during runtime, the session gets data injected
 
 
-		/// this is the DTrack SDK main object. I'll have one one owned here as I do not know if they can coexist
-		std::unique_ptr< DTrackSDK > m_dtrack;
+		/// hand the datagram just received to the capture writer, if we're recording
+		void record_datagram();
+
+		/// count frames for the frame rate stat
+		void count_frame();
+
+		/// live DTrack SDK or a replay. I'll have one owned here as I do not know if SDKs can coexist
+		std::unique_ptr< FDTrackDataSource > m_source;
+
+		/// same as m_source if that is a replay
+		FDTrackReplaySource *m_replay = nullptr;
+
+		/// same as m_source if we're a cluster secondary
+		FDTrackClusterSource *m_cluster = nullptr;
+
+		/// converted frame of the source's last receive, if it delivers those instead of datagrams
+		const FDTrackClusterFrame *m_converted = nullptr;
+
+		/// parsed data of the source's last frame, valid while running
+		const DTrackParser *m_dtrack = nullptr;
+
+		uint64 m_rate_start = 0;    //!< cycles when frame rate counting started
+		uint32 m_rate_frames = 0;   //!< frames since then
+
+		/// records raw datagrams if the client asked for a capture file
+		std::unique_ptr< FDTrackCaptureWriter > m_capture;
 
 		/// parameters
 		const bool                   m_dtrack2;
 		const std::string            m_dtrack_server_ip;
 		const uint32                 m_dtrack_server_port;
+		const FString                m_capture_file;
+		const FString                m_replay_file;
 		const EDTrackCoordinateSystemType  m_coordinate_system = EDTrackCoordinateSystemType::CST_Normal;
 
 		/// room coordinate adoption matrix for "normal" setting
@@ -124,4 +203,7 @@ class FDTrackPollThread : public FRunnable {
 		/// transposed variant cached
 		const FMatrix  m_trafo_unreal_adapted_transposed;
 
+		/// works out finger joints while hands are converted
+		const FDTrackFingerKinematics m_finger_kinematics;
+
 };
\ No newline at end of file
@@ -0,0 +1,214 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackPoseHistory.h"
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+FDTrackPoseHistory::Ring::Ring(const int32 n_capacity) {
+
+	m_samples.SetNumUninitialized(n_capacity);
+}
+
+void FDTrackPoseHistory::Ring::add(const Sample &n_sample) {
+
+	// late and duplicate frames would break the ordering binary search relies on
+	if (m_count && (n_sample.m_time <= at(m_count - 1).m_time)) {
+		return;
+	}
+
+	m_samples[m_head] = n_sample;
+	m_head = (m_head + 1) % m_samples.Num();
+	m_count = FMath::Min(m_count + 1, m_samples.Num());
+}
+
+const FDTrackPoseHistory::Sample &FDTrackPoseHistory::Ring::at(const int32 n_index) const {
+
+	return m_samples[(m_head - m_count + n_index + m_samples.Num()) % m_samples.Num()];
+}
+
+bool FDTrackPoseHistory::Ring::sample(const double n_time, FVector &n_location, FRotator &n_rotation) const {
+
+	if (!m_count || (n_time < at(0).m_time) || (n_time > at(m_count - 1).m_time)) {
+		return false;
+	}
+
+	// first sample later than n_time
+	int32 low = 0;
+	int32 high = m_count;
+	while (low < high) {
+		const int32 mid = low + (high - low) / 2;
+		if (at(mid).m_time <= n_time) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	const Sample &before = at(low - 1);
+	if ((low == m_count) || (before.m_time == n_time)) {
+		n_location = before.m_location;
+		n_rotation = before.m_rotation.Rotator();
+		return true;
+	}
+
+	const Sample &after = at(low);
+	if (after.m_time - before.m_time > MaxGap) {
+		return false;
+	}
+
+	const float alpha = static_cast<float>((n_time - before.m_time) / (after.m_time - before.m_time));
+	n_location = FMath::Lerp(before.m_location, after.m_location, alpha);
+	n_rotation = FQuat::Slerp(before.m_rotation, after.m_rotation, alpha).Rotator();
+	return true;
+}
+
+bool FDTrackPoseHistory::Ring::predict(const double n_time, const double n_max_ahead, FVector &n_location, FRotator &n_rotation) const {
+
+	if (m_count < 2) {
+		return false;
+	}
+
+	const Sample &last = at(m_count - 1);
+	const Sample &previous = at(m_count - 2);
+	if ((n_time < last.m_time) || (n_time - last.m_time > MaxGap)) {
+		return false;
+	}
+
+	// no telling how it moved if it was gone in between
+	const double period = last.m_time - previous.m_time;
+	if (period > MaxGap) {
+		n_location = last.m_location;
+		n_rotation = last.m_rotation.Rotator();
+		return true;
+	}
+
+	const float factor = static_cast<float>(FMath::Min(n_time - last.m_time, n_max_ahead) / period);
+	n_location = last.m_location + (last.m_location - previous.m_location) * factor;
+
+	// keep turning the same way at the same rate
+	FQuat delta = last.m_rotation * previous.m_rotation.Inverse();
+	if (delta.W < 0.0f) {
+		delta = delta * -1.0f;
+	}
+	FVector axis;
+	float angle;
+	delta.ToAxisAndAngle(axis, angle);
+	n_rotation = (FQuat(axis, angle * factor) * last.m_rotation).Rotator();
+	return true;
+}
+
+bool FDTrackPoseHistory::Ring::newest(double &n_time) const {
+
+	if (!m_count) {
+		return false;
+	}
+
+	n_time = at(m_count - 1).m_time;
+	return true;
+}
+
+void FDTrackPoseHistory::Ring::reset() {
+
+	m_head = 0;
+	m_count = 0;
+}
+
+FDTrackPoseHistory::FDTrackPoseHistory(const int32 n_capacity)
+		: m_capacity(FMath::Max(n_capacity, 2)) {
+}
+
+void FDTrackPoseHistory::add(const EDTrackTargetType n_type, const int32 n_id, const double n_time, const FVector &n_location, const FRotator &n_rotation) {
+
+	if (n_id < 0) {
+		return;
+	}
+
+	FScopeLock lock(&m_mutex);
+
+	// targets showing up the first time are the only ones allocating
+	TArray< TUniquePtr<Ring> > &rings = m_rings[static_cast<int32>(n_type)];
+	if (rings.Num() <= n_id) {
+		rings.SetNum(n_id + 1);
+	}
+	if (!rings[n_id]) {
+		rings[n_id] = MakeUnique<Ring>(m_capacity);
+	}
+
+	rings[n_id]->add(Sample{ n_time, n_location, n_rotation.Quaternion() });
+}
+
+bool FDTrackPoseHistory::sample(const EDTrackTargetType n_type, const int32 n_id, const double n_time, FVector &n_location, FRotator &n_rotation) const {
+
+	FScopeLock lock(&m_mutex);
+
+	const TArray< TUniquePtr<Ring> > &rings = m_rings[static_cast<int32>(n_type)];
+	if (!rings.IsValidIndex(n_id) || !rings[n_id]) {
+		return false;
+	}
+
+	return rings[n_id]->sample(n_time, n_location, n_rotation);
+}
+
+bool FDTrackPoseHistory::predict(const EDTrackTargetType n_type, const int32 n_id, const double n_time, const double n_max_ahead,
+		FVector &n_location, FRotator &n_rotation) const {
+
+	FScopeLock lock(&m_mutex);
+
+	const TArray< TUniquePtr<Ring> > &rings = m_rings[static_cast<int32>(n_type)];
+	if (!rings.IsValidIndex(n_id) || !rings[n_id]) {
+		return false;
+	}
+
+	return rings[n_id]->predict(n_time, n_max_ahead, n_location, n_rotation);
+}
+
+bool FDTrackPoseHistory::newest(const EDTrackTargetType n_type, const int32 n_id, double &n_time) const {
+
+	FScopeLock lock(&m_mutex);
+
+	const TArray< TUniquePtr<Ring> > &rings = m_rings[static_cast<int32>(n_type)];
+	if (!rings.IsValidIndex(n_id) || !rings[n_id]) {
+		return false;
+	}
+
+	return rings[n_id]->newest(n_time);
+}
+
+void FDTrackPoseHistory::reset() {
+
+	FScopeLock lock(&m_mutex);
+
+	for (TArray< TUniquePtr<Ring> > &rings : m_rings) {
+		for (TUniquePtr<Ring> &ring : rings) {
+			if (ring) {
+				ring->reset();
+			}
+		}
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
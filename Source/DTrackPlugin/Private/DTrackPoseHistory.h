@@ -0,0 +1,106 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IDTrackPlugin.h"
+
+/** @brief where each target was over the last few hundred frames
+ *
+ *	One fixed size ring of poses per target, filled by the poll thread as targets 
+ *	are injected. Rings are allocated when a target shows up for the first time, 
+ *	after that nothing is allocated anymore. Times are FPlatformTime::Seconds() 
+ *	of datagram arrival, as FDTrackPlayoutClock puts it.
+ */
+class FDTrackPoseHistory {
+
+	public:
+		/// keep n_capacity samples per target
+		explicit FDTrackPoseHistory(const int32 n_capacity);
+
+		/// add a target's pose. Samples not newer than what the target has are dropped
+		void add(const EDTrackTargetType n_type, const int32 n_id, const double n_time, const FVector &n_location, const FRotator &n_rotation);
+
+		/**
+		 * Sample a target's pose at n_time, interpolating between the samples around it.
+		 * False if n_time is outside the target's history or the target wasn't
+		 * seen for more than MaxGap seconds around then.
+		 */
+		bool sample(const EDTrackTargetType n_type, const int32 n_id, const double n_time, FVector &n_location, FRotator &n_rotation) const;
+
+		/**
+		 * Predict a target's pose at n_time after its newest sample from the motion between 
+		 * its last two samples, at most n_max_ahead seconds. False if it has fewer than 
+		 * two samples or its newest is more than MaxGap older than n_time, as it's lost then.
+		 */
+		bool predict(const EDTrackTargetType n_type, const int32 n_id, const double n_time, const double n_max_ahead, 
+				FVector &n_location, FRotator &n_rotation) const;
+
+		/// time of a target's newest sample. False if it has none
+		bool newest(const EDTrackTargetType n_type, const int32 n_id, double &n_time) const;
+
+		/// forget everything but keep the memory
+		void reset();
+
+		/// samples further apart than this mean the target was lost in between
+		static constexpr double MaxGap = 0.1;
+
+	private:
+		struct Sample {
+			double  m_time;
+			FVector m_location;
+			FQuat   m_rotation;
+		};
+
+		/// the samples of one target, oldest first once unrolled
+		class Ring {
+
+			public:
+				explicit Ring(const int32 n_capacity);
+
+				void add(const Sample &n_sample);
+				bool sample(const double n_time, FVector &n_location, FRotator &n_rotation) const;
+				bool predict(const double n_time, const double n_max_ahead, FVector &n_location, FRotator &n_rotation) const;
+				bool newest(double &n_time) const;
+				void reset();
+
+			private:
+				/// n-th sample, 0 is the oldest
+				const Sample &at(const int32 n_index) const;
+
+				TArray<Sample> m_samples;
+				int32          m_head = 0;     //!< next to write
+				int32          m_count = 0;
+		};
+
+		const int32           m_capacity;
+
+		/// rings by target type and id. Null where no target was seen
+		TArray< TUniquePtr<Ring> > m_rings[static_cast<int32>(EDTrackTargetType::Count)];
+
+		mutable FCriticalSection m_mutex;
+};
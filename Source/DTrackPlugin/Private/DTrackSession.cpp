@@ -0,0 +1,1702 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackSession.h"
+#include "DTrackPollThread.h"
+#include "DTrackDataSource.h"
+#include "DTrackComponent.h"
+#include "DTrackStats.h"
+#include "DTrackSharedMemoryWriter.h"
+#include "DTrackFilter.h"
+
+#include "Misc/App.h"
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+namespace {
+
+/**
+ * The injected buffer holds what was published three frames ago. Targets DTrack doesn't 
+ * report in the coming frame keep their last published pose instead, but aren't valid anymore. 
+ * The ones it reports overwrite all of this as they're injected.
+ */
+template <typename TTarget>
+void carry_over_extras(TTarget &n_target) {
+
+}
+
+/// a flystick that's gone doesn't hold its buttons down. Sizes stay, so nothing's allocated
+void carry_over_extras(FDTrackFlystick &n_flystick) {
+
+	for (int &button : n_flystick.m_button_states) {
+		button = 0;
+	}
+
+	for (float &joystick : n_flystick.m_joystick_states) {
+		joystick = 0.0f;
+	}
+}
+
+template <typename TTarget>
+void carry_over(const TArray<TTarget> &n_published, TArray<TTarget> &n_injected) {
+
+	if (n_injected.Num() < n_published.Num()) {
+		n_injected.SetNumZeroed(n_published.Num(), false);
+	}
+
+	for (int32 i = 0; i < n_injected.Num(); i++) {
+		TTarget &target = n_injected[i];
+		if (n_published.IsValidIndex(i)) {
+			const TTarget &published = n_published[i];
+			target.m_location = published.m_location;
+			target.m_rotation = published.m_rotation;
+			target.m_measured_frame = published.m_measured_frame;
+			target.m_measured_time = published.m_measured_time;
+		}
+		carry_over_extras(target);
+		target.m_state = EDTrackTrackingState::TS_Lost;
+		target.m_quality = 0.0f;
+		target.m_valid = false;
+	}
+}
+
+template <typename T>
+void copy_array(const TArray<T> &n_from, TArray<T> &n_to);
+
+/// the same for human models. Their joints are many, so carry_over_joints() only copies 
+/// them for the ones the frame didn't report once it's injected
+void carry_over(const TArray<FDTrackHuman> &n_published, TArray<FDTrackHuman> &n_injected) {
+
+	if (n_injected.Num() < n_published.Num()) {
+		n_injected.SetNum(n_published.Num(), false);
+	}
+
+	for (int32 i = 0; i < n_injected.Num(); i++) {
+		FDTrackHuman &human = n_injected[i];
+		if (n_published.IsValidIndex(i)) {
+			const FDTrackHuman &published = n_published[i];
+			human.m_measured_frame = published.m_measured_frame;
+			human.m_measured_time = published.m_measured_time;
+		}
+		human.m_state = EDTrackTrackingState::TS_Lost;
+		human.m_quality = 0.0f;
+		human.m_valid = false;
+	}
+}
+
+void carry_over_joints(const TArray<FDTrackHuman> &n_published, TArray<FDTrackHuman> &n_injected) {
+
+	for (int32 i = 0; i < n_injected.Num(); i++) {
+		FDTrackHuman &human = n_injected[i];
+		if (human.m_valid) {
+			continue;
+		}
+
+		if (n_published.IsValidIndex(i)) {
+			copy_array(n_published[i].m_joints, human.m_joints);
+		} else {
+			human.m_joints.SetNum(0, false);
+		}
+	}
+}
+
+// Assignment of whole structs gives their arrays a new allocation whenever the sizes differ,
+// these keep the one there is and copy element by element
+
+template <typename T>
+void copy_element(const T &n_from, T &n_to) {
+
+	n_to = n_from;
+}
+
+void copy_element(const FDTrackFlystick &n_from, FDTrackFlystick &n_to) {
+
+	n_to.m_location = n_from.m_location;
+	n_to.m_rotation = n_from.m_rotation;
+	n_to.m_state = n_from.m_state;
+	n_to.m_quality = n_from.m_quality;
+	n_to.m_valid = n_from.m_valid;
+	n_to.m_measured_frame = n_from.m_measured_frame;
+	n_to.m_measured_time = n_from.m_measured_time;
+	copy_array(n_from.m_button_states, n_to.m_button_states);
+	copy_array(n_from.m_joystick_states, n_to.m_joystick_states);
+}
+
+void copy_element(const FDTrackHand &n_from, FDTrackHand &n_to) {
+
+	n_to.m_right = n_from.m_right;
+	n_to.m_location = n_from.m_location;
+	n_to.m_rotation = n_from.m_rotation;
+	n_to.m_state = n_from.m_state;
+	n_to.m_quality = n_from.m_quality;
+	n_to.m_valid = n_from.m_valid;
+	n_to.m_measured_frame = n_from.m_measured_frame;
+	n_to.m_measured_time = n_from.m_measured_time;
+	copy_array(n_from.m_fingers, n_to.m_fingers);
+}
+
+void copy_element(const FDTrackJoint &n_from, FDTrackJoint &n_to) {
+
+	n_to.m_id = n_from.m_id;
+	n_to.m_location = n_from.m_location;
+	n_to.m_rotation = n_from.m_rotation;
+	copy_array(n_from.m_angles, n_to.m_angles);
+}
+
+void copy_element(const FDTrackHuman &n_from, FDTrackHuman &n_to) {
+
+	copy_array(n_from.m_joints, n_to.m_joints);
+	n_to.m_state = n_from.m_state;
+	n_to.m_quality = n_from.m_quality;
+	n_to.m_valid = n_from.m_valid;
+	n_to.m_measured_frame = n_from.m_measured_frame;
+	n_to.m_measured_time = n_from.m_measured_time;
+}
+
+template <typename T>
+void copy_array(const TArray<T> &n_from, TArray<T> &n_to) {
+
+	n_to.SetNum(n_from.Num(), false);
+	for (int32 i = 0; i < n_from.Num(); i++) {
+		copy_element(n_from[i], n_to[i]);
+	}
+}
+
+}
+
+FDTrackSession::FDTrackSession(const UDTrackComponent *n_client, FDTrackLatencyProbe &n_latency, FDTrackDataSource *n_source)
+		: m_key(endpoint(n_client))
+		, m_coordinate_system(n_client->m_coordinate_system)
+		, m_front(new DataBuffer)
+		, m_back(new DataBuffer)
+		, m_injected(new DataBuffer)
+		, m_latency(n_latency)
+		, m_frame_lock((n_client->m_cluster_role != EDTrackClusterRole::CR_None) && n_client->m_cluster_frame_lock)
+		, m_cluster_primary(n_client->m_cluster_role == EDTrackClusterRole::CR_Primary)
+		, m_playout(n_client->m_playout)
+		, m_playout_adaptive(n_client->m_playout_adaptive)
+		, m_playout_fixed_delay(n_client->m_playout_delay_ms / 1000.0)
+		, m_resample(n_client->m_resample)
+		, m_display_latency(n_client->m_display_latency_ms / 1000.0)
+		, m_coaster(n_client->m_coasting_ms / 1000.0, n_client->m_coasting_decay_ms / 1000.0)
+		, m_finger_kinematics(n_client->m_coordinate_system)
+		, m_anim_channel(FDTrackAnimChannel::get(m_key))
+		, m_default_anim_channel(FDTrackAnimChannel::get(FString())) {
+
+	// the playout buffer and resampling sample the history, so they need one with a few frames at least
+	if ((n_client->m_pose_history_size > 0) || m_playout || m_resample) {
+		m_pose_history.reset(new FDTrackPoseHistory((m_playout || m_resample) ? FMath::Max(n_client->m_pose_history_size, 64) : n_client->m_pose_history_size));
+	}
+
+	// cluster secondaries get frames the primary has filtered already
+	if (n_client->m_cluster_role != EDTrackClusterRole::CR_Secondary) {
+		m_filters.reset(new FDTrackFilterBank(n_client));
+		if (!m_filters->enabled()) {
+			m_filters.reset();
+		}
+	}
+
+	if (!n_client->m_shared_memory_name.IsEmpty()) {
+		m_shared_memory.reset(new FDTrackSharedMemoryWriter(n_client->m_shared_memory_name));
+		if (!m_shared_memory->is_open()) {
+			m_shared_memory.reset();
+		}
+	}
+
+	if (m_frame_lock) {
+		m_history.resize(HistorySize);
+		m_locked_blend.reset(new DataBuffer);
+	}
+
+	if (n_client->m_cluster_role == EDTrackClusterRole::CR_Primary) {
+		m_cluster_sender.reset(new FDTrackClusterSender(n_client->m_cluster_address, n_client->m_cluster_port));
+		if (!m_cluster_sender->is_open()) {
+			m_cluster_sender.reset();
+		}
+	}
+
+	if (n_source) {
+		m_polling_thread = new FDTrackPollThread(n_client, this, n_source);
+	} else {
+		m_polling_thread = FDTrackPollThread::start(n_client, this);
+	}
+}
+
+FDTrackSession::~FDTrackSession() {
+
+	if (m_polling_thread) {
+		m_polling_thread->interrupt();
+		m_polling_thread->join();
+		delete m_polling_thread;
+		m_polling_thread = nullptr;
+	}
+
+	// nodes keep the channels, but there's nothing coming anymore
+	m_anim_channel->release(m_key);
+	m_default_anim_channel->release(m_key);
+}
+
+FString FDTrackSession::endpoint(const UDTrackComponent *n_client) {
+
+	if (!n_client->m_replay_file.IsEmpty()) {
+		return FString::Printf(TEXT("replay:%s"), *n_client->m_replay_file);
+	}
+
+	// secondaries all get the same frames, no matter which DTrack they'd talk to
+	if (n_client->m_cluster_role == EDTrackClusterRole::CR_Secondary) {
+		return FString::Printf(TEXT("cluster:%s:%u"), *n_client->m_cluster_address, n_client->m_cluster_port);
+	}
+
+	if (!n_client->m_multicast_group.IsEmpty()) {
+		return FString::Printf(TEXT("multicast:%s:%u%s%s"), *n_client->m_multicast_group, n_client->m_dtrack_server_port, 
+				n_client->m_multicast_interface.IsEmpty() ? TEXT("") : TEXT("@"), *n_client->m_multicast_interface);
+	}
+
+	return FString::Printf(TEXT("%s:%u"), *n_client->m_dtrack_server_ip, n_client->m_dtrack_server_port);
+}
+
+const FString &FDTrackSession::key() const {
+
+	return m_key;
+}
+
+void FDTrackSession::add(UDTrackComponent *n_client) {
+
+	if (n_client->m_coordinate_system != m_coordinate_system) {
+		UE_LOG(DTrackPluginLog, Warning, TEXT("DTrack component %s uses a different room calibration than others on %s. The first one wins"),
+				*n_client->GetName(), *m_key);
+	}
+
+	m_clients.AddDefaulted();
+	Subscription &subscription = m_clients.Last();
+	subscription.m_component = n_client;
+	subscription.m_thresholds = (n_client->m_position_threshold_cm > 0.0f) || (n_client->m_rotation_threshold_deg > 0.0f);
+	subscription.m_changes.set_thresholds(n_client->m_position_threshold_cm, n_client->m_rotation_threshold_deg);
+
+	// Decimated ones get consecutive phases, so they don't all come due on the same tick.
+	// For rates the phase is a fraction of the period, golden ratio steps spread them evenly
+	subscription.m_every_nth = FMath::Max(n_client->m_update_every_nth_frame, 1);
+	subscription.m_period = (n_client->m_max_update_rate_hz > 0.0f) ? (1.0 / n_client->m_max_update_rate_hz) : 0.0;
+	if ((subscription.m_every_nth > 1) || (subscription.m_period > 0.0)) {
+		const int32 phase = m_next_phase++;
+		subscription.m_phase = phase % subscription.m_every_nth;
+		subscription.m_next_dispatch = FPlatformTime::Seconds() + subscription.m_period * FMath::Frac(phase * 0.618034);
+	}
+
+	subscription.m_priority = n_client->m_dispatch_priority;
+
+	update_change_thresholds();
+}
+
+bool FDTrackSession::remove(const UDTrackComponent *n_client) {
+
+	const bool ret = m_clients.RemoveAll([&](const Subscription &p) {
+		return p.m_component.Get() == n_client;
+	}) > 0;
+
+	update_change_thresholds();
+	return ret;
+}
+
+bool FDTrackSession::has(const UDTrackComponent *n_client) const {
+
+	return m_clients.ContainsByPredicate([&](const Subscription &p) {
+		return p.m_component.Get() == n_client;
+	});
+}
+
+bool FDTrackSession::due(Subscription &n_subscription, const double n_now) const {
+
+	if ((n_subscription.m_every_nth > 1) && (((m_ticks + n_subscription.m_phase) % n_subscription.m_every_nth) != 0)) {
+		return false;
+	}
+
+	if (n_subscription.m_period > 0.0) {
+		if (n_now < n_subscription.m_next_dispatch) {
+			return false;
+		}
+
+		// keep the cadence, but don't try to catch up after a hitch
+		n_subscription.m_next_dispatch += n_subscription.m_period;
+		if (n_subscription.m_next_dispatch <= n_now) {
+			n_subscription.m_next_dispatch = n_now + n_subscription.m_period;
+		}
+	}
+
+	return true;
+}
+
+void FDTrackSession::update_change_thresholds() {
+
+	bool detect = false;
+	float distance = 0.0f;
+	float angle = 0.0f;
+	for (const Subscription &c : m_clients) {
+		if (!c.m_thresholds) {
+			continue;
+		}
+
+		const UDTrackComponent *component = c.m_component.Get();
+		if (!component) {
+			continue;
+		}
+
+		distance = detect ? FMath::Min(distance, component->m_position_threshold_cm) : component->m_position_threshold_cm;
+		angle = detect ? FMath::Min(angle, component->m_rotation_threshold_deg) : component->m_rotation_threshold_deg;
+		detect = true;
+	}
+
+	m_change_distance = distance;
+	m_change_angle = angle;
+	m_detect_changes = detect;
+}
+
+int32 FDTrackSession::num_clients() const {
+
+	return m_clients.Num();
+}
+
+UDTrackComponent *FDTrackSession::any_client() const {
+
+	for (const Subscription &c : m_clients) {
+		if (c.m_component.IsValid()) {
+			return c.m_component.Get();
+		}
+	}
+
+	return nullptr;
+}
+
+FDTrackPollThread *FDTrackSession::poll_thread() {
+
+	return m_polling_thread;
+}
+
+FDTrackReplaySource *FDTrackSession::replay() {
+
+	return m_polling_thread ? m_polling_thread->replay() : nullptr;
+}
+
+FDTrackStreamStats FDTrackSession::stream_stats() const {
+
+	FDTrackStreamStats ret = m_stream_monitor.stats();
+	if (m_playing_out) {
+		ret.m_playout_delay = m_playout_delay * 1000.0;
+		ret.m_playout_underruns = m_playout_underruns;
+	}
+	return ret;
+}
+
+bool FDTrackSession::pose_at(const EDTrackTargetType n_type, const int32 n_id, const double n_time, FVector &n_location, FRotator &n_rotation) const {
+
+	return m_pose_history && m_pose_history->sample(n_type, n_id, n_time, n_location, n_rotation);
+}
+
+FCriticalSection *FDTrackSession::swapping_mutex() {
+
+	return &m_swapping_mutex;
+}
+
+FDTrackFrameStamps FDTrackSession::published_stamps() {
+
+	FDTrackScopeLock lock(swapping_mutex());
+	return m_front->m_stamps;
+}
+
+void FDTrackSession::tick(const uint64 n_deadline, FGraphEventArray &n_sink_tasks) {
+
+	if (!m_polling_thread) {
+		return;
+	}
+
+	// see if there's a new frame for the latency probe
+	const FDTrackFrameStamps stamps = published_stamps();
+	const uint64 pickup = FPlatformTime::Cycles64();
+
+	if (m_frame_lock) {
+		select_locked_frame();
+	}
+
+	// Playout buffer. Everything's played a bit in the past so there's always a frame 
+	// before and after to interpolate between. Frame lock has its own idea of what to play
+	m_playing_out = m_playout && m_pose_history && !m_serving_locked;
+	if (m_playing_out) {
+		const double now = FPlatformTime::Seconds();
+		const double target = m_playout_adaptive ? m_playout_clock.suggested_delay() : m_playout_fixed_delay;
+
+		if (m_playout_delay < 0.0) {
+			m_playout_delay = target;
+		} else {
+			// follow the target gently so motion doesn't jump. Being too short stutters, so go up faster
+			const double elapsed = now - m_last_playout_tick;
+			m_playout_delay += FMath::Clamp(target - m_playout_delay, -0.01 * elapsed, 0.1 * elapsed);
+		}
+
+		m_last_playout_tick = now;
+		m_sample_time = now - m_playout_delay;
+		m_underrun = false;
+		SET_FLOAT_STAT(STAT_DTrackPlayoutDelay, static_cast<float>(m_playout_delay * 1000.0));
+	}
+
+	// Resampling. Poses are for when this engine frame will be seen, so their motion from frame 
+	// to frame follows the render rate rather than beating against the tracking rate.
+	// Engine frames start at regular intervals with vsync, so that's the time base
+	m_resampling = m_resample && m_pose_history && !m_serving_locked && !m_playing_out;
+	if (m_resampling) {
+		const double frame_start = FApp::UseFixedTimeStep() ? FPlatformTime::Seconds() : FApp::GetCurrentTime();
+		const double delta = FApp::GetDeltaTime();
+		if (delta > 0.0) {
+			m_frame_time = (m_frame_time > 0.0) ? (0.9 * m_frame_time + 0.1 * delta) : delta;
+		}
+
+		m_sample_time = frame_start + ((m_display_latency > 0.0) ? m_display_latency : m_frame_time);
+	}
+
+	// what this tick's poses are for
+	if (!m_playing_out && !m_resampling) {
+		FDTrackScopeLock lock(swapping_mutex());
+		m_sample_time = dispatched()->m_arrival;
+	}
+
+	// iterate all registered components and call the interface methods upon them
+	// sinks on workers first, so they run while the components are called here
+	dispatch_sinks(n_sink_tasks);
+
+	// Who's due, never deferred ones first, then by priority. Within that, the ones deferred 
+	// last tick go first, so nobody waits for good
+	const double now = FPlatformTime::Seconds();
+	TArray<Subscription *, TInlineAllocator<8>> due_now;
+	for (Subscription &c : m_clients) {
+		// components might get killed and created along the way.
+		// I only operate those which seem to live OK
+		if (!c.m_component.IsValid()) {
+			continue;
+		}
+
+		// those that want fewer updates wait for their turn, what they missed they get then
+		if (!c.m_deferred && !due(c, now)) {
+			INC_DWORD_STAT(STAT_DTrackDecimated);
+			continue;
+		}
+
+		due_now.Add(&c);
+	}
+
+	due_now.StableSort([](const Subscription &n_a, const Subscription &n_b) {
+		if (n_a.m_priority != n_b.m_priority) {
+			return n_a.m_priority < n_b.m_priority;
+		}
+		return n_a.m_deferred && !n_b.m_deferred;
+	});
+
+	// Out of budget means out of time. Yet the first one that may be deferred always goes,
+	// so something moves even when DP_Always ones take it all
+	auto out_of_budget = [n_deadline](const bool n_progressed) {
+		return n_deadline && n_progressed && (FPlatformTime::Cycles64() > n_deadline);
+	};
+
+	// poses first, they are what's seen moving
+	bool progressed = false;
+	for (Subscription *c : due_now) {
+		const bool always = (c->m_priority == EDTrackDispatchPriority::DP_Always);
+		c->m_deferred = !always && out_of_budget(progressed);
+		if (c->m_deferred) {
+			INC_DWORD_STAT(STAT_DTrackDeferred);
+			continue;
+		}
+
+		// now handle the different tracking types by calling the component
+		handle_bodies(*c);
+		handle_flysticks(*c);
+		handle_hands(*c);
+
+		// the next tick only needs what moved after this
+		c->m_seen_sequence = stamps.m_sequence;
+		progressed |= !always;
+	}
+
+	// then the bulk. Human models are coalesced, deferred ones get the newest data when it's their turn
+	progressed = false;
+	for (Subscription *c : due_now) {
+		if (c->m_deferred) {
+			continue;
+		}
+
+		if (c->m_priority == EDTrackDispatchPriority::DP_Always) {
+			bool ignored = false;
+			handle_human_model(*c, 0, ignored);
+		} else {
+			handle_human_model(*c, n_deadline, progressed);
+		}
+	}
+
+	m_ticks++;
+
+	if (stamps.m_sequence && (stamps.m_sequence != m_last_sequence)) {
+		// frames published in between were overwritten before we got to see them
+		if (m_last_sequence) {
+			INC_DWORD_STAT_BY(STAT_DTrackSkipped, stamps.m_sequence - m_last_sequence - 1);
+		}
+
+		m_last_sequence = stamps.m_sequence;
+		m_latency.record(stamps, pickup, FPlatformTime::Cycles64());
+	}
+
+	handle_target_states();
+
+	if (m_playing_out && m_underrun) {
+		m_playout_underruns++;
+		INC_DWORD_STAT(STAT_DTrackPlayoutUnderruns);
+	}
+
+	// tell everyone when the stream degrades, stalls or recovers. Stepped replays wait for 
+	// the user, not for a stalled controller
+	const FDTrackReplaySource *replay_source = replay();
+	m_stream_monitor.set_stall_detection(!replay_source || !replay_source->stepped());
+
+	const EDTrackStreamState stream_state = m_stream_monitor.state();
+	if (stream_state != m_stream_state) {
+		UE_LOG(DTrackPluginLog, Warning, TEXT("DTrack stream %s state changed to %s"), *m_key,
+				*StaticEnum<EDTrackStreamState>()->GetNameStringByValue(static_cast<int64>(stream_state)));
+
+		m_stream_state = stream_state;
+		for (const Subscription &c : m_clients) {
+			UDTrackComponent *component = c.m_component.Get();
+			if (component) {
+				component->stream_state_changed(stream_state);
+			}
+		}
+	}
+}
+
+/************************************************************************/
+/* Injection routines                                                   */
+/* Called as lambdas from polling thread, executed in game thread       */
+/************************************************************************/
+void FDTrackSession::inject_body_data(const int n_body_id, const float n_quality, const FVector &n_translation, const FRotator &n_rotation) {
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackInject);
+	check(m_injected);
+	TArray<FDTrackBody> &body_inject = m_injected->m_body_data;
+
+	if (body_inject.Num() < (n_body_id + 1)) {
+		body_inject.SetNumZeroed(n_body_id + 1, false);
+	}
+
+	FVector translation = n_translation;
+	FRotator rotation = n_rotation;
+	if (m_filters) {
+		m_filters->filter(EDTrackTargetType::Body, n_body_id, m_injected_seconds, translation, rotation);
+	}
+
+	body_inject[n_body_id].m_location = translation;
+	body_inject[n_body_id].m_rotation = rotation;
+	body_inject[n_body_id].m_state = EDTrackTrackingState::TS_Measured;
+	body_inject[n_body_id].m_quality = n_quality;
+	body_inject[n_body_id].m_valid = true;
+	body_inject[n_body_id].m_measured_frame = static_cast<int32>(m_injected->m_stamps.m_frame_counter);
+	body_inject[n_body_id].m_measured_time = m_injected_seconds;
+	m_coaster.measured(EDTrackTargetType::Body, n_body_id, m_injected_seconds, translation, rotation);
+
+	if (m_pose_history) {
+		m_pose_history->add(EDTrackTargetType::Body, n_body_id, m_injected_seconds, translation, rotation);
+	}
+
+	m_injected_targets++;
+}
+
+void FDTrackSession::inject_flystick_data(const int n_flystick_id, const float n_quality, const FVector &n_translation, const FRotator &n_rotation, const TArray<int> &n_button_state, const TArray<float> &n_joystick_state) {
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackInject);
+	check(m_injected);
+	TArray<FDTrackFlystick> &flystick_inject = m_injected->m_flystick_data;
+
+	if (flystick_inject.Num() < (n_flystick_id + 1)) {
+		flystick_inject.SetNumZeroed(n_flystick_id + 1, false);
+	}
+
+	FVector translation = n_translation;
+	FRotator rotation = n_rotation;
+	if (m_filters) {
+		m_filters->filter(EDTrackTargetType::Flystick, n_flystick_id, m_injected_seconds, translation, rotation);
+	}
+
+	flystick_inject[n_flystick_id].m_location = translation;
+	flystick_inject[n_flystick_id].m_rotation = rotation;
+	flystick_inject[n_flystick_id].m_state = EDTrackTrackingState::TS_Measured;
+	flystick_inject[n_flystick_id].m_quality = n_quality;
+	flystick_inject[n_flystick_id].m_valid = true;
+	flystick_inject[n_flystick_id].m_measured_frame = static_cast<int32>(m_injected->m_stamps.m_frame_counter);
+	flystick_inject[n_flystick_id].m_measured_time = m_injected_seconds;
+	m_coaster.measured(EDTrackTargetType::Flystick, n_flystick_id, m_injected_seconds, translation, rotation);
+	flystick_inject[n_flystick_id].m_button_states = n_button_state;
+	flystick_inject[n_flystick_id].m_joystick_states = n_joystick_state;
+
+	if (m_pose_history) {
+		m_pose_history->add(EDTrackTargetType::Flystick, n_flystick_id, m_injected_seconds, translation, rotation);
+	}
+
+	m_injected_targets++;
+}
+
+void FDTrackSession::inject_hand_data(const int n_hand_id, const bool &n_right, const float n_quality, const FVector &n_translation, const FRotator &n_rotation, const TArray<FDTrackFinger> &n_fingers) {
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackInject);
+	check(m_injected);
+	TArray<FDTrackHand> &hand_inject = m_injected->m_hand_data;
+
+	if (hand_inject.Num() < (n_hand_id + 1)) {
+		hand_inject.SetNumZeroed(n_hand_id + 1, false);
+	}
+
+	hand_inject[n_hand_id].m_right = n_right;
+	FVector translation = n_translation;
+	FRotator rotation = n_rotation;
+	if (m_filters) {
+		m_filters->filter(EDTrackTargetType::Hand, n_hand_id, m_injected_seconds, translation, rotation);
+	}
+
+	hand_inject[n_hand_id].m_location = translation;
+	hand_inject[n_hand_id].m_rotation = rotation;
+	hand_inject[n_hand_id].m_state = EDTrackTrackingState::TS_Measured;
+	hand_inject[n_hand_id].m_quality = n_quality;
+	hand_inject[n_hand_id].m_valid = true;
+	hand_inject[n_hand_id].m_measured_frame = static_cast<int32>(m_injected->m_stamps.m_frame_counter);
+	hand_inject[n_hand_id].m_measured_time = m_injected_seconds;
+	m_coaster.measured(EDTrackTargetType::Hand, n_hand_id, m_injected_seconds, translation, rotation);
+	hand_inject[n_hand_id].m_fingers = n_fingers;
+
+	if (m_pose_history) {
+		m_pose_history->add(EDTrackTargetType::Hand, n_hand_id, m_injected_seconds, translation, rotation);
+	}
+
+	m_injected_targets++;
+}
+
+void FDTrackSession::inject_body_occluded(const int n_body_id) {
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackInject);
+	check(m_injected);
+	TArray<FDTrackBody> &body_inject = m_injected->m_body_data;
+
+	if (body_inject.Num() < (n_body_id + 1)) {
+		body_inject.SetNumZeroed(n_body_id + 1, false);
+	}
+
+	FDTrackBody &body = body_inject[n_body_id];
+	body.m_state = m_coaster.occluded(EDTrackTargetType::Body, n_body_id, m_injected_seconds, body.m_location, body.m_rotation);
+	body.m_quality = 0.0f;
+	body.m_valid = (body.m_state == EDTrackTrackingState::TS_Coasted);
+
+	// coasted poses are played out and resampled like measured ones
+	if (m_pose_history && (body.m_state == EDTrackTrackingState::TS_Coasted)) {
+		m_pose_history->add(EDTrackTargetType::Body, n_body_id, m_injected_seconds, body.m_location, body.m_rotation);
+	}
+}
+
+void FDTrackSession::inject_flystick_occluded(const int n_flystick_id, const TArray<int> &n_button_state, const TArray<float> &n_joystick_state) {
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackInject);
+	check(m_injected);
+	TArray<FDTrackFlystick> &flystick_inject = m_injected->m_flystick_data;
+
+	if (flystick_inject.Num() < (n_flystick_id + 1)) {
+		flystick_inject.SetNumZeroed(n_flystick_id + 1, false);
+	}
+
+	// buttons and joysticks work without the cameras
+	FDTrackFlystick &flystick = flystick_inject[n_flystick_id];
+	flystick.m_state = m_coaster.occluded(EDTrackTargetType::Flystick, n_flystick_id, m_injected_seconds, flystick.m_location, flystick.m_rotation);
+	flystick.m_quality = 0.0f;
+	flystick.m_valid = (flystick.m_state == EDTrackTrackingState::TS_Coasted);
+	flystick.m_button_states = n_button_state;
+	flystick.m_joystick_states = n_joystick_state;
+
+	if (m_pose_history && (flystick.m_state == EDTrackTrackingState::TS_Coasted)) {
+		m_pose_history->add(EDTrackTargetType::Flystick, n_flystick_id, m_injected_seconds, flystick.m_location, flystick.m_rotation);
+	}
+}
+
+void FDTrackSession::inject_hand_occluded(const int n_hand_id, const bool &n_right) {
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackInject);
+	check(m_injected);
+	TArray<FDTrackHand> &hand_inject = m_injected->m_hand_data;
+
+	if (hand_inject.Num() < (n_hand_id + 1)) {
+		hand_inject.SetNumZeroed(n_hand_id + 1, false);
+	}
+
+	FDTrackHand &hand = hand_inject[n_hand_id];
+	hand.m_right = n_right;
+	hand.m_state = m_coaster.occluded(EDTrackTargetType::Hand, n_hand_id, m_injected_seconds, hand.m_location, hand.m_rotation);
+	hand.m_quality = 0.0f;
+	hand.m_valid = (hand.m_state == EDTrackTrackingState::TS_Coasted);
+
+	// fingers stay as they were last published. Only this thread swaps buffers, so the front holds still
+	if (m_front->m_hand_data.IsValidIndex(n_hand_id)) {
+		hand.m_fingers = m_front->m_hand_data[n_hand_id].m_fingers;
+	}
+
+	if (m_pose_history && (hand.m_state == EDTrackTrackingState::TS_Coasted)) {
+		m_pose_history->add(EDTrackTargetType::Hand, n_hand_id, m_injected_seconds, hand.m_location, hand.m_rotation);
+	}
+}
+
+void FDTrackSession::inject_human_model_data(const int n_human_id, const float n_quality, const TArray<FDTrackJoint> &n_joints) {
+	
+	SCOPE_CYCLE_COUNTER(STAT_DTrackInject);
+	check(m_injected);
+	TArray<FDTrackHuman> &human_inject = m_injected->m_human_model_data;
+
+	if (human_inject.Num() < (n_human_id + 1)) {
+		human_inject.SetNum(n_human_id + 1, false);
+	}
+
+	// no joint good enough is no measurement. It stays lost with the joints it was last seen with
+	if (!n_joints.Num()) {
+		return;
+	}
+
+	FDTrackHuman &human = human_inject[n_human_id];
+	copy_array(n_joints, human.m_joints);
+	human.m_state = EDTrackTrackingState::TS_Measured;
+	human.m_quality = n_quality;
+	human.m_valid = true;
+	human.m_measured_frame = static_cast<int32>(m_injected->m_stamps.m_frame_counter);
+	human.m_measured_time = m_injected_seconds;
+
+	m_injected_targets++;
+}
+
+void FDTrackSession::inject_frame(const FDTrackClusterFrame &n_frame) {
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackInject);
+	check(m_injected);
+
+	// the primary sends its dense arrays, so that's what we publish too. Lost humans included
+	m_carry_human_joints = false;
+	m_injected->m_body_data = n_frame.m_bodies;
+	m_injected->m_flystick_data = n_frame.m_flysticks;
+	m_injected->m_hand_data = n_frame.m_hands;
+	m_injected->m_human_model_data = n_frame.m_humans;
+
+	// measured times come relative to the frame, make them ours
+	auto to_local = [this](auto &n_targets) {
+		for (auto &target : n_targets) {
+			target.m_measured_time = (target.m_measured_time > 0.0) ? 0.0 : m_injected_seconds + target.m_measured_time;
+		}
+	};
+	to_local(m_injected->m_body_data);
+	to_local(m_injected->m_flystick_data);
+	to_local(m_injected->m_hand_data);
+	to_local(m_injected->m_human_model_data);
+
+	// finger joints aren't sent, they're worked out again. Same room calibration as the primary assumed
+	for (FDTrackHand &hand : m_injected->m_hand_data) {
+		for (FDTrackFinger &finger : hand.m_fingers) {
+			m_finger_kinematics.solve(finger);
+		}
+	}
+
+	m_injected_targets += n_frame.m_bodies.Num() + n_frame.m_flysticks.Num() + n_frame.m_hands.Num() + n_frame.m_humans.Num();
+
+	// lost ones stay out like they do on the primary
+	if (m_pose_history) {
+		for (int32 i = 0; i < n_frame.m_bodies.Num(); i++) {
+			if (n_frame.m_bodies[i].m_state != EDTrackTrackingState::TS_Lost) {
+				m_pose_history->add(EDTrackTargetType::Body, i, m_injected_seconds, n_frame.m_bodies[i].m_location, n_frame.m_bodies[i].m_rotation);
+			}
+		}
+		for (int32 i = 0; i < n_frame.m_flysticks.Num(); i++) {
+			if (n_frame.m_flysticks[i].m_state != EDTrackTrackingState::TS_Lost) {
+				m_pose_history->add(EDTrackTargetType::Flystick, i, m_injected_seconds, n_frame.m_flysticks[i].m_location, n_frame.m_flysticks[i].m_rotation);
+			}
+		}
+		for (int32 i = 0; i < n_frame.m_hands.Num(); i++) {
+			if (n_frame.m_hands[i].m_state != EDTrackTrackingState::TS_Lost) {
+				m_pose_history->add(EDTrackTargetType::Hand, i, m_injected_seconds, n_frame.m_hands[i].m_location, n_frame.m_hands[i].m_rotation);
+			}
+		}
+	}
+}
+
+void FDTrackSession::lock_to(const uint32 n_frame_counter, const double n_timestamp) {
+
+	FDTrackScopeLock lock(swapping_mutex());
+	m_lock_valid = true;
+	m_lock_frame_counter = n_frame_counter;
+	m_lock_timestamp = n_timestamp;
+}
+
+void FDTrackSession::begin_injection(const uint32 n_frame_counter, const double n_timestamp, const uint64 n_received, const uint64 n_parsed) {
+
+	m_last_injection_time = m_current_injection_time;
+	m_current_injection_time = FPlatformTime::Cycles64();
+
+	m_injected_targets = 0;
+	m_injected_seconds = m_playout_clock.frame(n_timestamp, FPlatformTime::ToSeconds64(n_received));
+
+	m_stream_monitor.frame(n_frame_counter, n_received);
+	m_injected->m_timestamp = n_timestamp;
+	m_injected->m_arrival = m_injected_seconds;
+
+	// only this thread swaps buffers, so the front holds still
+	carry_over(m_front->m_body_data, m_injected->m_body_data);
+	carry_over(m_front->m_flystick_data, m_injected->m_flystick_data);
+	carry_over(m_front->m_hand_data, m_injected->m_hand_data);
+	carry_over(m_front->m_human_model_data, m_injected->m_human_model_data);
+	m_carry_human_joints = true;
+
+	FDTrackFrameStamps &stamps = m_injected->m_stamps;
+	stamps.m_frame_counter = n_frame_counter;
+	stamps.m_received = n_received;
+	stamps.m_parsed = n_parsed;
+}
+
+void FDTrackSession::end_injection() {
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackSwap);
+	DTRACK_TRACE_SCOPE(DTrackSwap);
+
+	// only this thread swaps buffers, so the front still holds the last published joints
+	if (m_carry_human_joints) {
+		carry_over_joints(m_front->m_human_model_data, m_injected->m_human_model_data);
+		m_carry_human_joints = false;
+	}
+
+	SET_DWORD_STAT(STAT_DTrackTargets, m_injected_targets);
+	m_injected->m_stamps.m_converted = FPlatformTime::Cycles64();
+	m_injected->m_stamps.m_sequence = ++m_publish_sequence;
+
+	mark_changes();
+	publish_anim_frame();
+
+	// secondaries get exactly what we're about to publish
+	if (m_cluster_sender) {
+		FDTrackClusterCodec::encode(m_injected->m_stamps.m_frame_counter, m_injected->m_timestamp, m_injected->m_arrival,
+				m_injected->m_body_data, m_injected->m_flystick_data, m_injected->m_hand_data, 
+				m_injected->m_human_model_data, m_cluster_packet);
+		m_cluster_sender->send(m_cluster_packet);
+	}
+
+	// and so do other processes
+	if (m_shared_memory) {
+		m_shared_memory->publish(m_injected->m_stamps.m_frame_counter, m_injected->m_timestamp, m_injected->m_arrival,
+				m_injected->m_body_data, m_injected->m_flystick_data, m_injected->m_hand_data, 
+				m_injected->m_human_model_data);
+	}
+
+	// keep it around for frame lock. Copied before taking the lock the game thread waits for
+	TSharedPtr<DataBuffer, ESPMode::ThreadSafe> history;
+	if (m_frame_lock) {
+		for (const TSharedRef<DataBuffer, ESPMode::ThreadSafe> &h : m_history_pool) {
+			if (h.IsUnique()) {
+				history = h;
+				break;
+			}
+		}
+
+		// the history, the one being filled and what the game thread holds
+		if (!history.IsValid()) {
+			history = MakeShareable(new DataBuffer());
+			if (m_history_pool.Num() < HistorySize + 4) {
+				m_history_pool.Add(history.ToSharedRef());
+			}
+		}
+
+		copy_frame(*m_injected, *history);
+	}
+
+	// injection vector becomes front now, front becomes back and back becomes 
+	// the new injection data storage
+	FDTrackScopeLock lock(swapping_mutex());
+
+	if (history.IsValid()) {
+		m_history[m_history_next] = history;
+		m_history_next = (m_history_next + 1) % HistorySize;
+	}
+
+	std::swap(m_front, m_back);
+	std::swap(m_front, m_injected);
+	m_front->m_stamps.m_published = FPlatformTime::Cycles64();
+}
+
+/************************************************************************/
+/* Frame lock                                                           */
+/* Every node of a cluster shows the same DTrack frame in an engine     */
+/* frame. The primary picks the newest it has and tells the others.     */
+/* As they get that during their own engine frame, everyone including   */
+/* the primary shows it one engine frame later.                         */
+/************************************************************************/
+void FDTrackSession::select_locked_frame() {
+
+	m_serving_locked = false;
+
+	bool send_sync = false;
+	uint32 next_frame_counter = 0;
+	double next_timestamp = -1.0;
+
+	// Picked under the lock, read after it. Holding them keeps the poll thread from reusing them
+	TSharedPtr<const DataBuffer, ESPMode::ThreadSafe> exact;
+	TSharedPtr<const DataBuffer, ESPMode::ThreadSafe> before;
+	TSharedPtr<const DataBuffer, ESPMode::ThreadSafe> after;
+	double time = 0.0;
+	bool by_time = false;
+
+	// without DTrack timestamps frame counters have to do as time
+	auto time_of = [&by_time](const DataBuffer &n_frame) {
+		return by_time ? n_frame.m_timestamp : static_cast<double>(n_frame.m_stamps.m_frame_counter);
+	};
+
+	{
+		FDTrackScopeLock lock(swapping_mutex());
+
+		if (m_cluster_primary) {
+			if (!m_front->m_stamps.m_sequence) {
+				return;
+			}
+
+			// what we pick now is shown next time, until then what we picked last time
+			next_frame_counter = m_front->m_stamps.m_frame_counter;
+			next_timestamp = m_front->m_timestamp;
+			send_sync = true;
+
+			if (!m_lock_valid) {
+				m_lock_frame_counter = next_frame_counter;
+				m_lock_timestamp = next_timestamp;
+				m_lock_valid = true;
+			}
+		}
+
+		if (m_lock_valid) {
+			const uint32 frame_counter = m_lock_frame_counter;
+
+			by_time = (m_lock_timestamp >= 0.0);
+			time = by_time ? m_lock_timestamp : static_cast<double>(frame_counter);
+
+			for (const TSharedPtr<DataBuffer, ESPMode::ThreadSafe> &frame : m_history) {
+				if (!frame.IsValid() || !frame->m_stamps.m_sequence) {
+					continue;
+				}
+
+				if (frame->m_stamps.m_frame_counter == frame_counter) {
+					exact = frame;
+					break;
+				}
+
+				const double t = time_of(*frame);
+				if ((t < time) && (!before.IsValid() || (t > time_of(*before)))) {
+					before = frame;
+				}
+				if ((t > time) && (!after.IsValid() || (t < time_of(*after)))) {
+					after = frame;
+				}
+			}
+		}
+
+		if (send_sync) {
+			m_lock_frame_counter = next_frame_counter;
+			m_lock_timestamp = next_timestamp;
+		}
+	}
+
+	// the one shown stays held until the next pick
+	m_locked_source.Reset();
+	m_locked = nullptr;
+	if (exact.IsValid()) {
+		m_locked_source = exact;
+		m_locked = exact.Get();
+	} else if (before.IsValid() && after.IsValid()) {
+		// we lost that one
+		interpolate(*before, *after, static_cast<float>((time - time_of(*before)) / (time_of(*after) - time_of(*before))), *m_locked_blend);
+		m_locked = m_locked_blend.get();
+		INC_DWORD_STAT(STAT_DTrackLockInterpolated);
+	} else if (before.IsValid()) {
+		// not here yet, the best we can do is the newest
+		m_locked_source = before;
+		m_locked = before.Get();
+		INC_DWORD_STAT(STAT_DTrackLockLate);
+	} else if (after.IsValid()) {
+		// fell out of the history
+		m_locked_source = after;
+		m_locked = after.Get();
+	}
+	m_serving_locked = (m_locked != nullptr);
+
+	if (send_sync && m_cluster_sender) {
+		FDTrackClusterCodec::encode_sync(next_frame_counter, next_timestamp, m_sync_packet);
+		m_cluster_sender->send(m_sync_packet);
+	}
+}
+
+bool FDTrackSession::sample_pose(const EDTrackTargetType n_type, const int32 n_id, FVector &n_location, FRotator &n_rotation) {
+
+	if (m_pose_history->sample(n_type, n_id, m_sample_time, n_location, n_rotation)) {
+		return true;
+	}
+
+	double newest = 0.0;
+	if (!m_pose_history->newest(n_type, n_id, newest) || (newest >= m_sample_time)) {
+		return false;
+	}
+
+	// the display time is usually past the newest frame, so resampling predicts
+	if (m_resampling) {
+		return m_pose_history->predict(n_type, n_id, m_sample_time, MaxPrediction, n_location, n_rotation);
+	}
+
+	// nothing after the playout time yet, the delay is too short for this network.
+	// Unless the target's just gone
+	if (m_sample_time - newest < FDTrackPoseHistory::MaxGap) {
+		m_underrun = true;
+	}
+
+	return false;
+}
+
+double FDTrackSession::sample_time() const {
+
+	return m_sample_time;
+}
+
+bool FDTrackSession::target_status(const EDTrackTargetType n_type, const int32 n_id, FDTrackTargetStatus &n_status) {
+
+	auto get = [n_id, &n_status](const auto &n_targets) {
+		if (!n_targets.IsValidIndex(n_id)) {
+			return false;
+		}
+
+		const auto &target = n_targets[n_id];
+		n_status.m_state = target.m_state;
+		n_status.m_valid = target.m_valid;
+		n_status.m_quality = target.m_quality;
+		n_status.m_measured_frame = target.m_measured_frame;
+		n_status.m_measured_time = target.m_measured_time;
+		return true;
+	};
+
+	FDTrackScopeLock lock(swapping_mutex());
+	const DataBuffer *front = dispatched();
+	switch (n_type) {
+		case EDTrackTargetType::Body:
+			return get(front->m_body_data);
+		case EDTrackTargetType::Flystick:
+			return get(front->m_flystick_data);
+		case EDTrackTargetType::Hand:
+			return get(front->m_hand_data);
+		case EDTrackTargetType::HumanModel:
+			return get(front->m_human_model_data);
+		default:
+			return false;
+	}
+}
+
+void FDTrackSession::copy_frame(const DataBuffer &n_from, DataBuffer &n_to) {
+
+	copy_array(n_from.m_body_data, n_to.m_body_data);
+	copy_array(n_from.m_flystick_data, n_to.m_flystick_data);
+	copy_array(n_from.m_hand_data, n_to.m_hand_data);
+	copy_array(n_from.m_human_model_data, n_to.m_human_model_data);
+	n_to.m_timestamp = n_from.m_timestamp;
+	n_to.m_arrival = n_from.m_arrival;
+	n_to.m_stamps = n_from.m_stamps;
+	for (int32 t = 0; t < static_cast<int32>(EDTrackTargetType::Count); t++) {
+		copy_array(n_from.m_changed[t], n_to.m_changed[t]);
+	}
+	copy_array(n_from.m_input_changed, n_to.m_input_changed);
+}
+
+const FDTrackSession::DataBuffer *FDTrackSession::dispatched() const {
+
+	return m_serving_locked ? m_locked : m_front.get();
+}
+
+void FDTrackSession::interpolate(const DataBuffer &n_a, const DataBuffer &n_b, const float n_alpha, DataBuffer &n_out) {
+
+	// buttons, finger and joint layouts and whatever else can't be blended come from the later one
+	copy_frame(n_b, n_out);
+
+	for (int32 i = 0; i < FMath::Min(n_a.m_body_data.Num(), n_b.m_body_data.Num()); i++) {
+		FDTrackBody &body = n_out.m_body_data[i];
+		body.m_location = FMath::Lerp(n_a.m_body_data[i].m_location, n_b.m_body_data[i].m_location, n_alpha);
+		body.m_rotation = FQuat::Slerp(n_a.m_body_data[i].m_rotation.Quaternion(), n_b.m_body_data[i].m_rotation.Quaternion(), n_alpha).Rotator();
+	}
+
+	for (int32 i = 0; i < FMath::Min(n_a.m_flystick_data.Num(), n_b.m_flystick_data.Num()); i++) {
+		FDTrackFlystick &flystick = n_out.m_flystick_data[i];
+		flystick.m_location = FMath::Lerp(n_a.m_flystick_data[i].m_location, n_b.m_flystick_data[i].m_location, n_alpha);
+		flystick.m_rotation = FQuat::Slerp(n_a.m_flystick_data[i].m_rotation.Quaternion(), n_b.m_flystick_data[i].m_rotation.Quaternion(), n_alpha).Rotator();
+	}
+
+	for (int32 i = 0; i < FMath::Min(n_a.m_hand_data.Num(), n_b.m_hand_data.Num()); i++) {
+		FDTrackHand &hand = n_out.m_hand_data[i];
+		hand.m_location = FMath::Lerp(n_a.m_hand_data[i].m_location, n_b.m_hand_data[i].m_location, n_alpha);
+		hand.m_rotation = FQuat::Slerp(n_a.m_hand_data[i].m_rotation.Quaternion(), n_b.m_hand_data[i].m_rotation.Quaternion(), n_alpha).Rotator();
+
+		const TArray<FDTrackFinger> &fingers_a = n_a.m_hand_data[i].m_fingers;
+		if (fingers_a.Num() == hand.m_fingers.Num()) {
+			for (int32 f = 0; f < fingers_a.Num(); f++) {
+				hand.m_fingers[f].m_location = FMath::Lerp(fingers_a[f].m_location, hand.m_fingers[f].m_location, n_alpha);
+				hand.m_fingers[f].m_rotation = FQuat::Slerp(fingers_a[f].m_rotation.Quaternion(), hand.m_fingers[f].m_rotation.Quaternion(), n_alpha).Rotator();
+
+				FDTrackFingerJoints &joints = hand.m_fingers[f].m_joints;
+				const FDTrackFingerJoints &joints_a = fingers_a[f].m_joints;
+				joints.m_knuckle.Blend(joints_a.m_knuckle, FTransform(joints.m_knuckle), n_alpha);
+				joints.m_middle.Blend(joints_a.m_middle, FTransform(joints.m_middle), n_alpha);
+				joints.m_distal.Blend(joints_a.m_distal, FTransform(joints.m_distal), n_alpha);
+				joints.m_tip.Blend(joints_a.m_tip, FTransform(joints.m_tip), n_alpha);
+			}
+		}
+	}
+
+	for (int32 i = 0; i < FMath::Min(n_a.m_human_model_data.Num(), n_b.m_human_model_data.Num()); i++) {
+		const TArray<FDTrackJoint> &joints_a = n_a.m_human_model_data[i].m_joints;
+		TArray<FDTrackJoint> &joints = n_out.m_human_model_data[i].m_joints;
+		if (joints_a.Num() == joints.Num()) {
+			for (int32 j = 0; j < joints.Num(); j++) {
+				joints[j].m_location = FMath::Lerp(joints_a[j].m_location, joints[j].m_location, n_alpha);
+				joints[j].m_rotation = FQuat::Slerp(joints_a[j].m_rotation.Quaternion(), joints[j].m_rotation.Quaternion(), n_alpha).Rotator();
+			}
+		}
+	}
+
+	n_out.m_timestamp = FMath::Lerp(n_a.m_timestamp, n_b.m_timestamp, static_cast<double>(n_alpha));
+}
+
+// y = dst
+// y1 = last
+// y2 = current
+void FDTrackSession::extrapolate(FVector &y, const FVector &y1, const FVector &y2) const {
+
+	uint64 now = FPlatformTime::Cycles64();
+
+	// If the values we have are very recent I don't extrapolate and just return the latest
+	if (now < m_current_injection_time + 10) {
+		y = y2;
+		return;
+	}
+
+	// this should cover startup conditions
+	if (!m_current_injection_time || !m_last_injection_time) {		
+		y = y2;
+		return;
+	}
+
+	// unlikely since we use cycles but we could run twice so close together
+	if (m_current_injection_time == m_last_injection_time) {
+		y = y2;
+		return;
+	}
+
+
+	// f(x) = y1 + ((x - x1) / (x2 - x1)) * (y2 - y1)
+	//              ^-----factor--------^
+
+	float factor = ((now - m_last_injection_time) / (m_current_injection_time - m_last_injection_time));
+
+	y.X = y1.X + factor * (y2.X - y1.X);
+	y.Y = y1.Y + factor * (y2.Y - y1.Y);
+	y.Z = y1.Z + factor * (y2.Z - y1.Z);
+}
+
+void FDTrackSession::extrapolate(FRotator &n_y, const FRotator &n_y1, const FRotator &n_y2) const {
+
+	uint64 now = FPlatformTime::Cycles64();
+
+	// If the values we have are very recent I don't extrapolate and just return the latest
+	if (now < m_current_injection_time + 10) {
+		n_y = n_y2;
+		return;
+	}
+
+	// this should cover startup conditions
+	if (!m_current_injection_time || !m_last_injection_time) {
+		n_y = n_y2;
+		return;
+	}
+
+	// unlikely since we use cycles but we could run twice so close together
+	if (m_current_injection_time == m_last_injection_time) {
+		n_y = n_y2;
+		return;
+	}
+
+	// I will use quaternions of those because I have no idea what happens when 
+	// I extrapolate those Eulers
+	FQuat y1 = n_y1.Quaternion();
+	FQuat y2 = n_y2.Quaternion();
+	FQuat ret;
+
+	// f(x) = y1 + ((x - x1) / (x2 - x1)) * (y2 - y1)
+	//              ^-----factor--------^
+
+	float factor = ((now - m_last_injection_time) / (m_current_injection_time - m_last_injection_time));
+	ret.W = y1.W + factor * (y2.W - y1.W);
+	ret.X = y1.X + factor * (y2.X - y1.X);
+	ret.Y = y1.Y + factor * (y2.Y - y1.Y);
+	ret.Z = y1.Z + factor * (y2.Z - y1.Z);
+	n_y = ret.Rotator();
+}
+
+
+void FDTrackSession::mark_changes() {
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackChanges);
+
+	if (!m_detect_changes) {
+		// no stamps means everything counts as moved
+		for (TArray<uint64> &changed : m_injected->m_changed) {
+			changed.Reset();
+		}
+		m_injected->m_input_changed.Reset();
+		m_published_changes.reset();
+		return;
+	}
+
+	// Half the finest thresholds. A target that's not stamped stayed within half of
+	// them of where it was stamped last, so it didn't move further than the whole
+	// since any subscription looked. Nobody misses a move that way
+	m_published_changes.set_thresholds(0.5f * m_change_distance, 0.5f * m_change_angle);
+
+	const uint64 sequence = m_injected->m_stamps.m_sequence;
+	auto stamp = [&](const EDTrackTargetType n_type, const int32 n_num, TFunctionRef<bool(int32)> n_changed) {
+		TArray<uint64> &changed = m_injected->m_changed[static_cast<int32>(n_type)];
+		const TArray<uint64> &published = m_front->m_changed[static_cast<int32>(n_type)];
+		changed.SetNumUninitialized(n_num);
+		for (int32 i = 0; i < n_num; i++) {
+			// always asked, so the detector keeps up
+			const bool moved = n_changed(i);
+			changed[i] = (moved || !published.IsValidIndex(i)) ? sequence : published[i];
+		}
+	};
+
+	stamp(EDTrackTargetType::Body, m_injected->m_body_data.Num(), [this](const int32 n_id) {
+		const FDTrackBody &body = m_injected->m_body_data[n_id];
+		return m_published_changes.changed(EDTrackTargetType::Body, n_id, body.m_location, body.m_rotation, body.m_valid);
+	});
+
+	stamp(EDTrackTargetType::Flystick, m_injected->m_flystick_data.Num(), [this](const int32 n_id) {
+		const FDTrackFlystick &flystick = m_injected->m_flystick_data[n_id];
+		return m_published_changes.changed(EDTrackTargetType::Flystick, n_id, flystick.m_location, flystick.m_rotation, flystick.m_valid);
+	});
+
+	stamp(EDTrackTargetType::Hand, m_injected->m_hand_data.Num(), [this](const int32 n_id) {
+		const FDTrackHand &hand = m_injected->m_hand_data[n_id];
+		const bool moved = m_published_changes.changed(EDTrackTargetType::Hand, n_id, hand.m_location, hand.m_rotation, hand.m_valid);
+		const bool fingers_moved = m_published_changes.fingers_changed(n_id, hand.m_fingers);
+		return moved || fingers_moved;
+	});
+
+	// buttons and joysticks are exact, any difference counts
+	TArray<uint64> &input_changed = m_injected->m_input_changed;
+	const TArray<uint64> &published_input = m_front->m_input_changed;
+	input_changed.SetNumUninitialized(m_injected->m_flystick_data.Num());
+	for (int32 i = 0; i < m_injected->m_flystick_data.Num(); i++) {
+		const FDTrackFlystick &flystick = m_injected->m_flystick_data[i];
+		const bool same = m_front->m_flystick_data.IsValidIndex(i) && published_input.IsValidIndex(i)
+				&& (m_front->m_flystick_data[i].m_button_states == flystick.m_button_states)
+				&& (m_front->m_flystick_data[i].m_joystick_states == flystick.m_joystick_states);
+		input_changed[i] = same ? published_input[i] : sequence;
+	}
+}
+
+void FDTrackSession::publish_anim_frame() {
+
+	if (!m_anim_channel->wanted() && !m_default_anim_channel->wanted()) {
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackAnimFrame);
+
+	// One nobody holds anymore, else a new one. Nodes hold them for an update at most, so there are few
+	TSharedPtr<FDTrackAnimFrame, ESPMode::ThreadSafe> frame;
+	for (const TSharedRef<FDTrackAnimFrame, ESPMode::ThreadSafe> &f : m_anim_frames) {
+		if (f.IsUnique()) {
+			frame = f;
+			break;
+		}
+	}
+
+	if (!frame.IsValid()) {
+		frame = MakeShareable(new FDTrackAnimFrame());
+		if (m_anim_frames.Num() < 8) {
+			m_anim_frames.Add(frame.ToSharedRef());
+		}
+	}
+
+	frame->m_frame_counter = m_injected->m_stamps.m_frame_counter;
+	frame->m_arrival = m_injected->m_arrival;
+
+	// arrays keep their memory from the last time this frame was used
+	frame->m_human_first_joint.Reset();
+	frame->m_joint_ids.Reset();
+	frame->m_joint_locations.Reset();
+	frame->m_joint_rotations.Reset();
+	for (const FDTrackHuman &human : m_injected->m_human_model_data) {
+		frame->m_human_first_joint.Add(frame->m_joint_ids.Num());
+		if (!human.m_valid) {
+			// no joints, nodes keep their source pose
+			continue;
+		}
+
+		for (const FDTrackJoint &joint : human.m_joints) {
+			frame->m_joint_ids.Add(joint.m_id);
+			frame->m_joint_locations.Add(joint.m_location);
+			frame->m_joint_rotations.Add(joint.m_rotation.Quaternion());
+		}
+	}
+	frame->m_human_first_joint.Add(frame->m_joint_ids.Num());
+
+	// hands in their fixed layout, missing fingers stay at identity
+	frame->m_hand_transforms.Reset();
+	frame->m_hand_fingers.Reset();
+	frame->m_finger_joints.Reset();
+	for (const FDTrackHand &hand : m_injected->m_hand_data) {
+		frame->m_hand_transforms.Add(FTransform(hand.m_rotation, hand.m_location));
+
+		const int32 num_fingers = hand.m_valid ? FMath::Min(hand.m_fingers.Num(), FDTrackAnimFrame::FingersPerHand) : 0;
+		frame->m_hand_fingers.Add(static_cast<uint8>(num_fingers));
+		for (int32 f = 0; f < num_fingers; f++) {
+			const FDTrackFingerJoints &joints = hand.m_fingers[f].m_joints;
+			frame->m_finger_joints.Add(joints.m_knuckle);
+			frame->m_finger_joints.Add(joints.m_middle);
+			frame->m_finger_joints.Add(joints.m_distal);
+			frame->m_finger_joints.Add(joints.m_tip);
+		}
+		frame->m_finger_joints.AddDefaulted((FDTrackAnimFrame::FingersPerHand - num_fingers) * FDTrackAnimFrame::JointsPerFinger);
+	}
+
+	const TSharedRef<const FDTrackAnimFrame, ESPMode::ThreadSafe> published = frame.ToSharedRef();
+	m_anim_channel->publish(m_key, published);
+	m_default_anim_channel->publish(m_key, published);
+}
+
+/************************************************************************/
+/* Handler methods. Called in game thread tick                          */
+/* to relay information to components                                   */
+/************************************************************************/
+void FDTrackSession::tick_pose(const DataBuffer &n_frame, const EDTrackTargetType n_type, const int32 n_id, FVector &n_location, FRotator &n_rotation) {
+
+	if (m_playing_out || m_resampling) {
+		// from the history. The newest if there's nothing there
+		sample_pose(n_type, n_id, n_location, n_rotation);
+		return;
+	}
+
+	// Only bodies are extrapolated. No extrapolation with one data set, which should occur only 
+	// once while starting up. Frame lock means showing exactly what the others show
+	if ((n_type == EDTrackTargetType::Body) && !m_serving_locked && (m_back->m_body_data.Num() == n_frame.m_body_data.Num())) {
+		const FDTrackBody &last_body = m_back->m_body_data[n_id];
+		const FDTrackBody &current_body = n_frame.m_body_data[n_id];
+		extrapolate(n_location, last_body.m_location, current_body.m_location);
+		extrapolate(n_rotation, last_body.m_rotation, current_body.m_rotation);
+	}
+}
+
+TSharedRef<const FDTrackFrameSnapshot, ESPMode::ThreadSafe> FDTrackSession::snapshot() {
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackSnapshot);
+
+	TSharedRef<FDTrackFrameSnapshot, ESPMode::ThreadSafe> ret = MakeShareable(new FDTrackFrameSnapshot());
+
+	FDTrackScopeLock lock(swapping_mutex());
+	const DataBuffer *front = dispatched();
+	ret->m_frame_counter = front->m_stamps.m_frame_counter;
+	ret->m_timestamp = front->m_timestamp;
+	ret->m_sample_time = m_sample_time;
+	ret->m_bodies = front->m_body_data;
+	ret->m_flysticks = front->m_flystick_data;
+	ret->m_hands = front->m_hand_data;
+	ret->m_humans = front->m_human_model_data;
+
+	for (int32 i = 0; i < ret->m_bodies.Num(); i++) {
+		tick_pose(*front, EDTrackTargetType::Body, i, ret->m_bodies[i].m_location, ret->m_bodies[i].m_rotation);
+	}
+	for (int32 i = 0; i < ret->m_flysticks.Num(); i++) {
+		tick_pose(*front, EDTrackTargetType::Flystick, i, ret->m_flysticks[i].m_location, ret->m_flysticks[i].m_rotation);
+	}
+	for (int32 i = 0; i < ret->m_hands.Num(); i++) {
+		tick_pose(*front, EDTrackTargetType::Hand, i, ret->m_hands[i].m_location, ret->m_hands[i].m_rotation);
+	}
+
+	return ret;
+}
+
+void FDTrackSession::dispatch_sinks(FGraphEventArray &n_sink_tasks) {
+
+	if (!m_sinks.Num()) {
+		return;
+	}
+
+	// one copy for all of them, nobody may change it
+	const TSharedRef<const FDTrackFrameSnapshot, ESPMode::ThreadSafe> frame = snapshot();
+
+	for (const Sink &s : m_sinks) {
+		if (s.m_thread_safe) {
+			const TSharedRef<IDTrackSink, ESPMode::ThreadSafe> sink = s.m_sink;
+			n_sink_tasks.Add(FFunctionGraphTask::CreateAndDispatchWhenReady([sink, frame]() {
+				SCOPE_CYCLE_COUNTER(STAT_DTrackSinks);
+				sink->frame(*frame);
+			}, TStatId(), nullptr, ENamedThreads::AnyThread));
+		}
+	}
+
+	// the others right here while the workers are busy
+	for (const Sink &s : m_sinks) {
+		if (!s.m_thread_safe) {
+			s.m_sink->frame(*frame);
+		}
+	}
+}
+
+void FDTrackSession::add_sink(const TSharedRef<IDTrackSink, ESPMode::ThreadSafe> &n_sink, const bool n_thread_safe) {
+
+	remove_sink(n_sink);
+	m_sinks.Add(Sink{ n_sink, n_thread_safe });
+}
+
+bool FDTrackSession::remove_sink(const TSharedRef<IDTrackSink, ESPMode::ThreadSafe> &n_sink) {
+
+	return m_sinks.RemoveAll([&](const Sink &p) {
+		return p.m_sink == n_sink;
+	}) > 0;
+}
+
+bool FDTrackSession::moved_since_last_tick(const Subscription &n_subscription, const DataBuffer &n_frame, const EDTrackTargetType n_type, const int32 n_id) const {
+
+	// sampled and locked poses aren't the newest, only the newest are marked
+	if (!n_subscription.m_thresholds || m_playing_out || m_resampling || m_serving_locked) {
+		return true;
+	}
+
+	const TArray<uint64> &changed = n_frame.m_changed[static_cast<int32>(n_type)];
+	return !changed.IsValidIndex(n_id) || (changed[n_id] > n_subscription.m_seen_sequence);
+}
+
+void FDTrackSession::handle_bodies(Subscription &n_subscription) {
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackDispatchBodies);
+	DTRACK_TRACE_SCOPE(DTrackDispatchBodies);
+	
+	check(m_front);
+	check(m_back);
+
+	UDTrackComponent *component = n_subscription.m_component.Get();
+
+	FDTrackScopeLock lock(swapping_mutex());
+	const DataBuffer *front = dispatched();
+	for (int32 i = 0; i < front->m_body_data.Num(); i++) {
+
+		const FDTrackBody &current_body = front->m_body_data[i];
+		if (!current_body.m_valid && !component->m_dispatch_lost_targets) {
+			continue;
+		}
+
+		// parked ones are skipped before anything's computed
+		if (!moved_since_last_tick(n_subscription, *front, EDTrackTargetType::Body, i)) {
+			continue;
+		}
+
+		FVector location = current_body.m_location;
+		FRotator rotation = current_body.m_rotation;
+		tick_pose(*front, EDTrackTargetType::Body, i, location, rotation);
+
+		if (n_subscription.m_thresholds && !n_subscription.m_changes.changed(EDTrackTargetType::Body, i, location, rotation, current_body.m_valid)) {
+			continue;
+		}
+
+		component->body_tracking(i, location, rotation);
+	}
+}
+
+void FDTrackSession::handle_flysticks(Subscription &n_subscription) {
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackDispatchFlysticks);
+	DTRACK_TRACE_SCOPE(DTrackDispatchFlysticks);
+
+	UDTrackComponent *component = n_subscription.m_component.Get();
+
+	// treat all flysticks
+	FDTrackScopeLock lock(swapping_mutex());
+	const DataBuffer *front = dispatched();
+	for (int32 i = 0; i < front->m_flystick_data.Num(); i++) {
+
+		const FDTrackFlystick &current_flystick = front->m_flystick_data[i];
+
+		// tracking first, it's called unless the flystick is lost and the component doesn't want that
+		// or it didn't move enough for the component to care
+		if ((current_flystick.m_valid || component->m_dispatch_lost_targets)
+				&& moved_since_last_tick(n_subscription, *front, EDTrackTargetType::Flystick, i)) {
+			FVector location = current_flystick.m_location;
+			FRotator rotation = current_flystick.m_rotation;
+			tick_pose(*front, EDTrackTargetType::Flystick, i, location, rotation);
+
+			if (!n_subscription.m_thresholds || n_subscription.m_changes.changed(EDTrackTargetType::Flystick, i, location, rotation, current_flystick.m_valid)) {
+				component->flystick_tracking(i, location, rotation);
+			}
+		}
+
+		if (current_flystick.m_button_states.Num()) {
+			// compare button states with the last seen state, calling button handlers if appropriate
+
+			// See if we have to resize our actual state vector to accommodate this.
+			std::vector< TArray<int> > &last_button_states = n_subscription.m_last_button_states;
+			if (last_button_states.size() < (i + 1)) {
+				// vector too small, insert new empties to pad
+				TArray<int> new_stick;
+				new_stick.SetNumZeroed(DTRACKSDK_FLYSTICK_MAX_BUTTON);
+				last_button_states.resize(i + 1, new_stick);
+			}
+			
+			const TArray<int> &current_states = current_flystick.m_button_states;
+			TArray<int> &last_states = last_button_states[i];
+
+			// have to go through all the button states now to figure out which ones have differed
+			for (int32 b = 0; b < current_states.Num(); b++) {
+				if (current_states[b] != last_states[b]) {
+					last_states[b] = current_states[b];
+					component->flystick_button(i, b, (current_states[b] == 1));
+				}
+			}
+		}
+
+		// Call joysticks if we have 'em. With thresholds only when they moved
+		if (current_flystick.m_joystick_states.Num()) {
+			const bool changed = !n_subscription.m_thresholds || !front->m_input_changed.IsValidIndex(i)
+					|| (front->m_input_changed[i] > n_subscription.m_seen_sequence);
+			if (changed) {
+				component->flystick_joystick(i, current_flystick.m_joystick_states);
+			}
+		}
+	}
+
+	// that's it. Flystick all done.
+}
+
+void FDTrackSession::handle_hands(Subscription &n_subscription) {
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackDispatchHands);
+	DTRACK_TRACE_SCOPE(DTrackDispatchHands);
+
+	UDTrackComponent *component = n_subscription.m_component.Get();
+
+	// treat all tracked hands
+	FDTrackScopeLock lock(swapping_mutex());
+	const DataBuffer *front = dispatched();
+	for (int32 i = 0; i < front->m_hand_data.Num(); i++) {
+		const FDTrackHand &hand = front->m_hand_data[i];
+		if (!hand.m_valid && !component->m_dispatch_lost_targets) {
+			continue;
+		}
+
+		if (!moved_since_last_tick(n_subscription, *front, EDTrackTargetType::Hand, i)) {
+			continue;
+		}
+
+		FVector location = hand.m_location;
+		FRotator rotation = hand.m_rotation;
+		tick_pose(*front, EDTrackTargetType::Hand, i, location, rotation);
+
+		// fingers move while the hand holds still
+		if (n_subscription.m_thresholds) {
+			const bool hand_changed = n_subscription.m_changes.changed(EDTrackTargetType::Hand, i, location, rotation, hand.m_valid);
+			const bool fingers_changed = n_subscription.m_changes.fingers_changed(i, hand.m_fingers);
+			if (!hand_changed && !fingers_changed) {
+				continue;
+			}
+		}
+
+		component->hand_tracking(i, hand.m_right, location, rotation, hand.m_fingers);
+	}
+}
+
+void FDTrackSession::handle_target_states() {
+
+	auto changed = [this](const EDTrackTargetType n_type, const int32 n_id, const EDTrackTrackingState n_state) {
+		TArray<EDTrackTrackingState> &states = m_dispatched_states[static_cast<int32>(n_type)];
+		if (states.Num() <= n_id) {
+			states.SetNumZeroed(n_id + 1);
+		}
+
+		if (states[n_id] == n_state) {
+			return;
+		}
+		states[n_id] = n_state;
+
+		for (const Subscription &c : m_clients) {
+			UDTrackComponent *component = c.m_component.Get();
+			if (component) {
+				component->target_state_changed(n_type, n_id, n_state);
+			}
+		}
+	};
+
+	FDTrackScopeLock lock(swapping_mutex());
+	const DataBuffer *front = dispatched();
+	for (int32 i = 0; i < front->m_body_data.Num(); i++) {
+		changed(EDTrackTargetType::Body, i, front->m_body_data[i].m_state);
+	}
+	for (int32 i = 0; i < front->m_flystick_data.Num(); i++) {
+		changed(EDTrackTargetType::Flystick, i, front->m_flystick_data[i].m_state);
+	}
+	for (int32 i = 0; i < front->m_hand_data.Num(); i++) {
+		changed(EDTrackTargetType::Hand, i, front->m_hand_data[i].m_state);
+	}
+}
+
+void FDTrackSession::handle_human_model(Subscription &n_subscription, const uint64 n_deadline, bool &n_progressed) {
+
+	SCOPE_CYCLE_COUNTER(STAT_DTrackDispatchHumanModels);
+	DTRACK_TRACE_SCOPE(DTrackDispatchHumanModels);
+	
+	FDTrackScopeLock lock(swapping_mutex());
+	const DataBuffer *front = dispatched();
+	const int32 num_humans = front->m_human_model_data.Num();
+
+	// treat all tracked humans, starting where the last tick ran out of time
+	const int32 first = (n_subscription.m_next_human < num_humans) ? n_subscription.m_next_human : 0;
+	n_subscription.m_next_human = 0;
+	for (int32 n = 0; n < num_humans; n++) {
+		const int32 i = (first + n) % num_humans;
+		if (n_deadline && n_progressed && (FPlatformTime::Cycles64() > n_deadline)) {
+			n_subscription.m_next_human = i;
+			n_subscription.m_deferred = true;
+			INC_DWORD_STAT_BY(STAT_DTrackDeferredHumans, num_humans - n);
+			break;
+		}
+
+		const FDTrackHuman &human = front->m_human_model_data[i];
+		if (!human.m_valid && !n_subscription.m_component->m_dispatch_lost_targets) {
+			continue;
+		}
+
+		n_subscription.m_component->human_model(i, human.m_joints);
+		n_progressed = true;
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,395 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IDTrackPlugin.h"
+#include "DTrackInterface.h"
+#include "DTrackLatencyProbe.h"
+#include "DTrackFrameMonitor.h"
+#include "DTrackCluster.h"
+#include "DTrackPoseHistory.h"
+#include "DTrackPlayout.h"
+#include "DTrackCoasting.h"
+#include "DTrackChangeDetector.h"
+#include "DTrackSink.h"
+#include "DTrackAnimFrame.h"
+#include "DTrackFingerKinematics.h"
+#include "Async/TaskGraphInterfaces.h"
+
+#include <vector>
+#include <memory>
+#include <atomic>
+
+class UDTrackComponent;
+class FDTrackPollThread;
+class FDTrackDataSource;
+class FDTrackReplaySource;
+class FDTrackSharedMemoryWriter;
+class FDTrackFilterBank;
+
+/** @brief one DTrack endpoint and everyone subscribed to it
+ *
+ *	Each session has its own polling thread, room calibration and target ids.
+ *	All components with the same server and port (or the same replay file) share 
+ *	one session. The plug-in keeps them all and ticks them on the game thread.
+ */
+class FDTrackSession {
+
+	public:
+		/**
+		 * Sets up the session according to the client's settings and starts polling.
+		 * If a source is given, no thread is started. Drive poll_thread() yourself then.
+		 */
+		FDTrackSession(const UDTrackComponent *n_client, FDTrackLatencyProbe &n_latency, FDTrackDataSource *n_source = nullptr);
+		~FDTrackSession();
+
+		/// the endpoint a client subscribes to, sessions are keyed by that
+		static FString endpoint(const UDTrackComponent *n_client);
+
+		/// this session's endpoint
+		const FString &key() const;
+
+		/// subscribe a component
+		void add(UDTrackComponent *n_client);
+
+		/// unsubscribe a component. True if it was subscribed
+		bool remove(const UDTrackComponent *n_client);
+
+		/// true if the component is subscribed here
+		bool has(const UDTrackComponent *n_client) const;
+
+		/// number of subscribed components
+		int32 num_clients() const;
+
+		/// any living subscribed component, null if none
+		UDTrackComponent *any_client() const;
+
+		/// call all subscribed components with the current data. Game thread only.
+		/// Components that aren't DP_Always are deferred after n_deadline in FPlatformTime::Cycles64(), 0 for none.
+		/// Tasks of thread safe sinks are added to n_sink_tasks, for the caller to wait for
+		void tick(const uint64 n_deadline, FGraphEventArray &n_sink_tasks);
+
+		/// see IDTrackPlugin::add_sink()
+		void add_sink(const TSharedRef<IDTrackSink, ESPMode::ThreadSafe> &n_sink, const bool n_thread_safe);
+
+		/// true if it was added here
+		bool remove_sink(const TSharedRef<IDTrackSink, ESPMode::ThreadSafe> &n_sink);
+
+		/// the polling thread, null if it couldn't be started
+		FDTrackPollThread *poll_thread();
+
+		/// the replay source if we're playing back a capture, null when live
+		FDTrackReplaySource *replay();
+
+		/// frame continuity of this endpoint's stream
+		FDTrackStreamStats stream_stats() const;
+
+		/// pipeline timestamps of the frame the game thread currently sees
+		FDTrackFrameStamps published_stamps();
+
+		/// where a target was at n_time, see IDTrackPlugin::pose_at()
+		bool pose_at(const EDTrackTargetType n_type, const int32 n_id, const double n_time, FVector &n_location, FRotator &n_rotation) const;
+
+		/// the time this tick's poses are for, see IDTrackPlugin::sample_time()
+		double sample_time() const;
+
+		/// see IDTrackPlugin::target_status()
+		bool target_status(const EDTrackTargetType n_type, const int32 n_id, FDTrackTargetStatus &n_status);
+
+	private:
+		
+		friend class FDTrackPollThread;
+
+		FCriticalSection *swapping_mutex();
+
+		/// polling thread injects body tracking data for later retrieval
+		/// call in game thread, not mutexed!
+		void inject_body_data(const int n_body_id, const float n_quality, const FVector &n_translation, const FRotator &n_rotation);
+
+		/// polling thread injects flystick data for later retrieval
+		void inject_flystick_data(const int n_flystick_id, const float n_quality, const FVector &n_translation, const FRotator &n_rotation,
+					const TArray<int> &n_button_state, const TArray<float> &n_joystick_state);
+
+		/// polling thread injects hand tracking data for later retrieval
+		void inject_hand_data(const int n_hand_id, const bool &n_right, const float n_quality, const FVector &n_translation, 
+					const FRotator &n_rotation, const TArray<FDTrackFinger> &n_fingers);
+
+		/// DTrack reports a target it doesn't see right now. It's coasted or lost, see FDTrackCoaster
+		void inject_body_occluded(const int n_body_id);
+		void inject_flystick_occluded(const int n_flystick_id, const TArray<int> &n_button_state, const TArray<float> &n_joystick_state);
+		void inject_hand_occluded(const int n_hand_id, const bool &n_right);
+
+		/// polling thread injects hand tracking data for later retrieval
+		void inject_human_model_data(const int n_human_id, const float n_quality, const TArray<FDTrackJoint> &n_joints);
+
+		/// a secondary injects a frame converted by the cluster primary as it is
+		void inject_frame(const FDTrackClusterFrame &n_frame);
+
+		/// a secondary got told by the primary which frame to show next
+		void lock_to(const uint32 n_frame_counter, const double n_timestamp);
+
+		/// begin enter values and measure time
+		void begin_injection(const uint32 n_frame_counter, const double n_timestamp, const uint64 n_received, const uint64 n_parsed);
+		void end_injection();
+
+		void extrapolate(FVector &y, const FVector &y1, const FVector &y2) const;
+		void extrapolate(FRotator &n_y, const FRotator &n_y1, const FRotator &n_y2) const;
+
+		/// frame lock: find the frame all nodes show this time in the history and make it the locked one
+		void select_locked_frame();
+
+		/// playout buffer or resampling: a target's pose at this tick's sample time. False if there's none
+		bool sample_pose(const EDTrackTargetType n_type, const int32 n_id, FVector &n_location, FRotator &n_rotation);
+
+		/// this tick's frame for sinks, poses as components get them
+		TSharedRef<const FDTrackFrameSnapshot, ESPMode::ThreadSafe> snapshot();
+
+		/// build the snapshot and hand it to all sinks, see tick()
+		void dispatch_sinks(FGraphEventArray &n_sink_tasks);
+
+		/// a subscribed component and what it was told so far
+		struct Subscription {
+			TWeakObjectPtr<UDTrackComponent> m_component;
+			bool                       m_thresholds = false;     //!< only changes beyond its thresholds are dispatched
+			FDTrackChangeDetector      m_changes;                //!< poses it was last called with
+			uint64                     m_seen_sequence = 0;      //!< the last frame dispatched to it
+
+			int32                      m_every_nth = 1;          //!< dispatched every this many ticks
+			int32                      m_phase = 0;              //!< on which of them, spread over subscriptions
+			double                     m_period = 0.0;           //!< seconds between dispatches from its max rate, 0 for every tick
+			double                     m_next_dispatch = 0.0;    //!< FPlatformTime::Seconds()
+
+			std::vector< TArray<int> > m_last_button_states;     //!< as it was told, so it gets every edge when decimated
+
+			EDTrackDispatchPriority    m_priority = EDTrackDispatchPriority::DP_Normal;
+			bool                       m_deferred = false;       //!< ran out of budget last tick, goes first next
+			int32                      m_next_human = 0;         //!< human models continue here after being deferred
+		};
+
+		/// true if the subscription is to be dispatched this tick, by its rate settings
+		bool due(Subscription &n_subscription, const double n_now) const;
+
+		/// consider the current frame's 6dof bodies and call the component if appropriate
+		void handle_bodies(Subscription &n_subscription);
+
+		/// consider the current frame's flystick tracking and button and call the component if appropriate
+		void handle_flysticks(Subscription &n_subscription);
+	
+		/// treat everything hand and finger tracking relevant
+		void handle_hands(Subscription &n_subscription);
+
+		/// extract and hand out human model (mocap?) data. Stops after n_deadline once n_progressed, 
+		/// the rest goes out next tick
+		void handle_human_model(Subscription &n_subscription, const uint64 n_deadline, bool &n_progressed);
+
+		/// tell all components about targets lost, found or coasting since the last tick
+		void handle_target_states();
+
+		/// For front and back buffer of data sent by polling thread
+		struct DataBuffer {
+			TArray<FDTrackBody>        m_body_data;          //!< cached body data being injected by thread
+			TArray<FDTrackFlystick>    m_flystick_data;      //!< cached flystick tracking info
+			TArray<FDTrackHand>  m_hand_data;          //!< cached hand tracking info
+			TArray<FDTrackHuman>       m_human_model_data;   //!< cached human model info
+			double                     m_timestamp = -1.0;   //!< DTrack's timestamp of this frame
+			double                     m_arrival = 0.0;      //!< arrival without jitter, FPlatformTime::Seconds()
+			FDTrackFrameStamps         m_stamps;             //!< when this frame passed the pipeline stages
+			TArray<uint64>             m_changed[static_cast<int32>(EDTrackTargetType::Count)]; //!< sequence each target last moved at, empty if nobody asks
+			TArray<uint64>             m_input_changed;      //!< sequence each flystick's buttons or joysticks last changed at
+		};
+
+		/// false if the target hasn't moved since the subscription's last tick, by the poll thread's stamps
+		bool moved_since_last_tick(const Subscription &n_subscription, const DataBuffer &n_frame, const EDTrackTargetType n_type, const int32 n_id) const;
+
+		/// stamp every target of the injected frame with the sequence it last moved at. Poll thread only
+		void mark_changes();
+
+		/// recompute the poll thread's thresholds after subscriptions changed
+		void update_change_thresholds();
+
+		/// lay out the injected frame's skeletal data for animation nodes, if any want it. Poll thread only
+		void publish_anim_frame();
+
+		/// the frame handlers dispatch, either the front or the locked one
+		const DataBuffer *dispatched() const;
+
+		/// Turn a target's pose in n_frame into what's handed out this tick: played out, resampled
+		/// or extrapolated. Under the swapping mutex
+		void tick_pose(const DataBuffer &n_frame, const EDTrackTargetType n_type, const int32 n_id, FVector &n_location, FRotator &n_rotation);
+
+		/// blend two frames into n_out for a point alpha between them
+		static void interpolate(const DataBuffer &n_a, const DataBuffer &n_b, const float n_alpha, DataBuffer &n_out);
+
+		/// n_to becomes n_from, keeping n_to's array storage so steady frames don't allocate
+		static void copy_frame(const DataBuffer &n_from, DataBuffer &n_to);
+
+		/// frames kept for frame lock, about half a second at DTrack's usual rates
+		static const int32 HistorySize = 32;
+
+		/// resampling predicts no further than this past the newest frame, in seconds
+		static constexpr double MaxPrediction = 0.05;
+
+		const FString            m_key;
+
+		/// the coordinate system of the first client, the polling thread uses it for everyone
+		const EDTrackCoordinateSystemType m_coordinate_system;
+
+		/// unreal doesn't seem to have condition variables
+		FCriticalSection         m_swapping_mutex;
+		uint64                   m_current_injection_time = 0;
+		uint64                   m_last_injection_time = 0;
+
+		std::unique_ptr<DataBuffer> m_front;           //!< current data to read by game thread
+		std::unique_ptr<DataBuffer> m_back;            //!< last values 
+		std::unique_ptr<DataBuffer> m_injected;        //!< values being injected  
+
+		/// shared with all other sessions, owned by the plug-in
+		FDTrackLatencyProbe       &m_latency;
+
+		/// watches the frame counter for lost frames and the stream for stalls
+		FDTrackFrameMonitor        m_stream_monitor;
+
+		/// stream state last told to the components
+		EDTrackStreamState         m_stream_state = EDTrackStreamState::SS_Ok;
+
+		/// sequence number of the last frame published, only touched by poll thread
+		uint64                     m_publish_sequence = 0;
+
+		/// sequence number of the last frame dispatched, to tell new frames from old
+		uint64                     m_last_sequence = 0;
+
+		/// targets injected in the current frame, for stats
+		uint32                     m_injected_targets = 0;
+
+		/// human models the current frame doesn't report still need their last joints, see end_injection
+		bool                       m_carry_human_joints = false;
+
+		/// every target's recent poses, null if the client wants none
+		std::unique_ptr<FDTrackPoseHistory> m_pose_history;
+
+		/// arrival of the frame being injected in FPlatformTime::Seconds(), for the history
+		double                     m_injected_seconds = 0.0;
+
+		/// a cluster primary rebroadcasts every frame it publishes through this
+		std::unique_ptr<FDTrackClusterSender> m_cluster_sender;
+
+		/// packet buffer reused for every frame
+		TArray<uint8>              m_cluster_packet;
+
+		/// carries targets DTrack doesn't see for a moment. Poll thread only
+		FDTrackCoaster             m_coaster;
+
+		/// finger joints of frames a cluster primary sent. Poll thread only
+		const FDTrackFingerKinematics m_finger_kinematics;
+
+		/// what components were told about each target's state. Game thread only
+		TArray<EDTrackTrackingState> m_dispatched_states[static_cast<int32>(EDTrackTargetType::Count)];
+
+		/// smooths poses as they come in, before anything else sees them. Poll thread only
+		std::unique_ptr<FDTrackFilterBank> m_filters;
+
+		/// other processes on this machine get every frame published through this
+		std::unique_ptr<FDTrackSharedMemoryWriter> m_shared_memory;
+
+		/// cluster nodes show the same frame, see select_locked_frame()
+		const bool                 m_frame_lock;
+		const bool                 m_cluster_primary;
+
+		/// deliver poses from the history at a delay rather than the newest, see tick()
+		const bool                 m_playout;
+		const bool                 m_playout_adaptive;
+		const double               m_playout_fixed_delay;
+
+		/// deliver poses for the display time of each engine frame, see tick()
+		const bool                 m_resample;
+		const double               m_display_latency;          //!< seconds, 0 for one frame
+
+		/// arrival times without network jitter, for the history and the playout delay
+		FDTrackPlayoutClock        m_playout_clock;
+
+		/// playout state. Game thread only
+		bool                       m_playing_out = false;
+		bool                       m_resampling = false;
+		bool                       m_underrun = false;
+		double                     m_playout_delay = -1.0;    //!< seconds, negative until the first tick
+		double                     m_frame_time = 0.0;        //!< engine frame time, smoothed
+		double                     m_sample_time = 0.0;       //!< what this tick's poses are for, FPlatformTime::Seconds()
+		double                     m_last_playout_tick = 0.0;
+		uint64                     m_playout_underruns = 0;
+
+		/// last frames published. The poll thread copies each into a buffer of the pool first and 
+		/// only puts it in here under the swapping mutex, readers hold on to what they picked
+		std::vector< TSharedPtr<DataBuffer, ESPMode::ThreadSafe> > m_history;
+		int32                      m_history_next = 0;
+
+		/// storage for the history, reused once neither the history nor the game thread holds it. Poll thread only
+		TArray< TSharedRef<DataBuffer, ESPMode::ThreadSafe> > m_history_pool;
+
+		/// the frame to show, told by the primary. Under the swapping mutex
+		bool                       m_lock_valid = false;
+		uint32                     m_lock_frame_counter = 0;
+		double                     m_lock_timestamp = -1.0;
+
+		/// what the handlers dispatch in frame lock mode: a frame of the history or the blend of two. Game thread only
+		TSharedPtr<const DataBuffer, ESPMode::ThreadSafe> m_locked_source;
+		std::unique_ptr<DataBuffer> m_locked_blend;
+		const DataBuffer          *m_locked = nullptr;
+		bool                       m_serving_locked = false;
+		TArray<uint8>              m_sync_packet;
+
+		/// where animation nodes get skeletal data, this endpoint's and the one for the first stream
+		const TSharedRef<FDTrackAnimChannel, ESPMode::ThreadSafe> m_anim_channel;
+		const TSharedRef<FDTrackAnimChannel, ESPMode::ThreadSafe> m_default_anim_channel;
+
+		/// frames built for them, reused once no node holds them anymore. Poll thread only
+		TArray< TSharedRef<FDTrackAnimFrame, ESPMode::ThreadSafe> > m_anim_frames;
+
+		FDTrackPollThread         *m_polling_thread = nullptr;
+
+		/// each DTrack component subscribed to this endpoint
+		TArray<Subscription>       m_clients;
+
+		/// native consumers and whether they may run on a worker
+		struct Sink {
+			TSharedRef<IDTrackSink, ESPMode::ThreadSafe> m_sink;
+			bool                       m_thread_safe;
+		};
+		TArray<Sink>               m_sinks;
+
+		/// for every-nth-tick decimation, and the phase the next decimated subscription gets. Game thread only
+		uint64                     m_ticks = 0;
+		int32                      m_next_phase = 0;
+
+		/// finest thresholds of all subscriptions that have some, read by the poll thread
+		std::atomic<bool>          m_detect_changes{ false };
+		std::atomic<float>         m_change_distance{ 0.0f };
+		std::atomic<float>         m_change_angle{ 0.0f };
+
+		/// poses the injected frames' change stamps refer to. Poll thread only
+		FDTrackChangeDetector      m_published_changes;
+};
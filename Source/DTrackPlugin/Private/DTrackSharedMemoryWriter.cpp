@@ -0,0 +1,205 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackSharedMemoryWriter.h"
+#include "IDTrackPlugin.h"
+
+#include "HAL/PlatformMemory.h"
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+namespace {
+
+void to_shared(const FVector &n_location, const FRotator &n_rotation, FDTrackSharedPose &n_pose) {
+
+	n_pose.m_location[0] = n_location.X;
+	n_pose.m_location[1] = n_location.Y;
+	n_pose.m_location[2] = n_location.Z;
+
+	const FQuat q = n_rotation.Quaternion();
+	n_pose.m_rotation[0] = q.X;
+	n_pose.m_rotation[1] = q.Y;
+	n_pose.m_rotation[2] = q.Z;
+	n_pose.m_rotation[3] = q.W;
+}
+
+template <typename TTarget>
+void to_shared(const TTarget &n_target, const double n_arrival, FDTrackSharedStatus &n_status) {
+
+	n_status.m_state = static_cast<uint32>(n_target.m_state);
+	n_status.m_valid = n_target.m_valid ? 1 : 0;
+	n_status.m_quality = n_target.m_quality;
+	n_status.m_measured_frame = static_cast<uint32>(n_target.m_measured_frame);
+	n_status.m_age = (n_target.m_measured_time > 0.0) ? static_cast<float>(FMath::Max(n_arrival - n_target.m_measured_time, 0.0)) : -1.0f;
+}
+
+}
+
+FDTrackSharedMemoryWriter::FDTrackSharedMemoryWriter(const FString &n_name)
+		: m_name(n_name) {
+
+	m_region = FPlatformMemory::MapNamedSharedMemoryRegion(m_name, true,
+			static_cast<uint32>(FPlatformMemory::ESharedMemoryAccess::Read) | static_cast<uint32>(FPlatformMemory::ESharedMemoryAccess::Write),
+			sizeof(FDTrackSharedRegion));
+
+	if (!m_region) {
+		UE_LOG(DTrackPluginLog, Error, TEXT("Could not create DTrack shared memory region '%s'"), *m_name);
+		return;
+	}
+
+	m_shared = static_cast<FDTrackSharedRegion *>(m_region->GetAddress());
+
+	// readers check magic and version, so those go last
+	FMemory::Memzero(m_shared, sizeof(FDTrackSharedRegion));
+	m_shared->m_size = sizeof(FDTrackSharedRegion);
+	m_shared->m_layout_version = DTrackSharedMemory::Version;
+	std::atomic_thread_fence(std::memory_order_release);
+	m_shared->m_magic = DTrackSharedMemory::Magic;
+
+	UE_LOG(DTrackPluginLog, Display, TEXT("Publishing DTrack frames into shared memory '%s' (%d bytes)"), *m_name, static_cast<int32>(sizeof(FDTrackSharedRegion)));
+}
+
+FDTrackSharedMemoryWriter::~FDTrackSharedMemoryWriter() {
+
+	if (m_region) {
+		// readers mapping it keep what they have, it just won't change anymore
+		m_shared->m_magic = 0;
+		FPlatformMemory::UnmapNamedSharedMemoryRegion(m_region);
+		m_region = nullptr;
+		m_shared = nullptr;
+	}
+}
+
+bool FDTrackSharedMemoryWriter::is_open() const {
+
+	return m_shared != nullptr;
+}
+
+uint32 FDTrackSharedMemoryWriter::fit(const int32 n_num, const uint32 n_max, const EOverflow n_what) {
+
+	static const TCHAR *const names[] = { TEXT("bodies"), TEXT("flysticks"), TEXT("hands"), TEXT("humans"), TEXT("joints") };
+	static_assert(ARRAY_COUNT(names) == static_cast<int32>(EOverflow::Count), "overflow names out of sync");
+
+	if (static_cast<uint32>(n_num) > n_max) {
+		bool &warned = m_warned[static_cast<int32>(n_what)];
+		if (!warned) {
+			UE_LOG(DTrackPluginLog, Warning, TEXT("%d %s tracked but only %u fit into shared memory '%s'"), n_num, names[static_cast<int32>(n_what)], n_max, *m_name);
+			warned = true;
+		}
+		return n_max;
+	}
+
+	return static_cast<uint32>(n_num);
+}
+
+void FDTrackSharedMemoryWriter::publish(const uint32 n_frame_counter, const double n_timestamp, const double n_arrival,
+		const TArray<FDTrackBody> &n_bodies, const TArray<FDTrackFlystick> &n_flysticks,
+		const TArray<FDTrackHand> &n_hands, const TArray<FDTrackHuman> &n_humans) {
+
+	if (!m_shared) {
+		return;
+	}
+
+	const uint64 sequence = ++m_sequence;
+	FDTrackSharedSlot &slot = m_shared->m_slots[sequence % 2];
+
+	// odd means we're writing. The fence keeps the frame from being written before that is visible
+	slot.m_version.store(2 * sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	FDTrackSharedFrame &frame = slot.m_frame;
+	frame.m_frame_counter = n_frame_counter;
+	frame.m_timestamp = n_timestamp;
+
+	frame.m_num_bodies = fit(n_bodies.Num(), DTrackSharedMemory::MaxBodies, EOverflow::Bodies);
+	for (uint32 i = 0; i < frame.m_num_bodies; i++) {
+		to_shared(n_bodies[i].m_location, n_bodies[i].m_rotation, frame.m_bodies[i]);
+		to_shared(n_bodies[i], n_arrival, frame.m_body_status[i]);
+	}
+
+	frame.m_num_flysticks = fit(n_flysticks.Num(), DTrackSharedMemory::MaxFlysticks, EOverflow::Flysticks);
+	for (uint32 i = 0; i < frame.m_num_flysticks; i++) {
+		const FDTrackFlystick &flystick = n_flysticks[i];
+		FDTrackSharedFlystick &shared = frame.m_flysticks[i];
+		to_shared(flystick.m_location, flystick.m_rotation, shared.m_pose);
+		to_shared(flystick, n_arrival, shared.m_status);
+
+		shared.m_num_buttons = FMath::Min<uint32>(flystick.m_button_states.Num(), DTrackSharedMemory::MaxButtons);
+		shared.m_buttons = 0;
+		for (uint32 b = 0; b < shared.m_num_buttons; b++) {
+			if (flystick.m_button_states[b]) {
+				shared.m_buttons |= 1u << b;
+			}
+		}
+
+		shared.m_num_joysticks = FMath::Min<uint32>(flystick.m_joystick_states.Num(), DTrackSharedMemory::MaxJoysticks);
+		for (uint32 j = 0; j < shared.m_num_joysticks; j++) {
+			shared.m_joysticks[j] = flystick.m_joystick_states[j];
+		}
+	}
+
+	frame.m_num_hands = fit(n_hands.Num(), DTrackSharedMemory::MaxHands, EOverflow::Hands);
+	for (uint32 i = 0; i < frame.m_num_hands; i++) {
+		const FDTrackHand &hand = n_hands[i];
+		FDTrackSharedHand &shared = frame.m_hands[i];
+		to_shared(hand.m_location, hand.m_rotation, shared.m_pose);
+		to_shared(hand, n_arrival, shared.m_status);
+		shared.m_right = hand.m_right ? 1 : 0;
+
+		shared.m_num_fingers = FMath::Min<uint32>(hand.m_fingers.Num(), DTrackSharedMemory::MaxFingers);
+		for (uint32 f = 0; f < shared.m_num_fingers; f++) {
+			const FDTrackFinger &finger = hand.m_fingers[f];
+			FDTrackSharedFinger &shared_finger = shared.m_fingers[f];
+			to_shared(finger.m_location, finger.m_rotation, shared_finger.m_pose);
+			shared_finger.m_type = static_cast<uint32>(finger.m_type);
+			shared_finger.m_tip_radius = finger.m_tip_radius;
+			shared_finger.m_phalanx_lengths[0] = finger.m_inner_phalanx_length;
+			shared_finger.m_phalanx_lengths[1] = finger.m_middle_phalanx_length;
+			shared_finger.m_phalanx_lengths[2] = finger.m_outer_phalanx_length;
+			shared_finger.m_phalanx_angles[0] = finger.m_inner_middle_phalanx_angle;
+			shared_finger.m_phalanx_angles[1] = finger.m_middle_outer_phalanx_angle;
+		}
+	}
+
+	frame.m_num_humans = fit(n_humans.Num(), DTrackSharedMemory::MaxHumans, EOverflow::Humans);
+	for (uint32 i = 0; i < frame.m_num_humans; i++) {
+		const TArray<FDTrackJoint> &joints = n_humans[i].m_joints;
+		FDTrackSharedHuman &shared = frame.m_humans[i];
+		to_shared(n_humans[i], n_arrival, shared.m_status);
+
+		shared.m_num_joints = fit(joints.Num(), DTrackSharedMemory::MaxJoints, EOverflow::Joints);
+		for (uint32 j = 0; j < shared.m_num_joints; j++) {
+			to_shared(joints[j].m_location, joints[j].m_rotation, shared.m_joints[j].m_pose);
+			shared.m_joints[j].m_id = joints[j].m_id;
+		}
+	}
+
+	// even again, then tell readers
+	slot.m_version.store(2 * sequence, std::memory_order_release);
+	m_shared->m_latest.store(sequence, std::memory_order_release);
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,71 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DTrackInterface.h"
+#include "DTrackSharedMemory.h"
+
+/** @brief publishes frames into a named shared memory region
+ *
+ *	The poll thread calls publish() after converting, other processes read the 
+ *	region with the reader in Tools/DTrackSharedMemory. Writing never waits for readers.
+ */
+class FDTrackSharedMemoryWriter {
+
+	public:
+		/// creates the region. Check is_open() afterwards
+		explicit FDTrackSharedMemoryWriter(const FString &n_name);
+		~FDTrackSharedMemoryWriter();
+
+		bool is_open() const;
+
+		/// copy one frame, arrived at n_arrival in FPlatformTime::Seconds(), into the next slot and make it the latest
+		void publish(const uint32 n_frame_counter, const double n_timestamp, const double n_arrival,
+				const TArray<FDTrackBody> &n_bodies, const TArray<FDTrackFlystick> &n_flysticks,
+				const TArray<FDTrackHand> &n_hands, const TArray<FDTrackHuman> &n_humans);
+
+	private:
+		/// what there can be too many of
+		enum class EOverflow : uint8 {
+			Bodies,
+			Flysticks,
+			Hands,
+			Humans,
+			Joints,
+			Count
+		};
+
+		/// warn once for each kind if there is more than fits
+		uint32 fit(const int32 n_num, const uint32 n_max, const EOverflow n_what);
+
+		const FString                         m_name;
+		struct FSharedMemoryRegion           *m_region = nullptr;
+		FDTrackSharedRegion                  *m_shared = nullptr;
+		uint64                                m_sequence = 0;
+		bool                                  m_warned[static_cast<int32>(EOverflow::Count)] = {};
+};
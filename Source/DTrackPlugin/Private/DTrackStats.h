@@ -0,0 +1,101 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Misc/ScopeLock.h"
+
+// Insights CPU trace scopes where the engine has them, named events otherwise
+#if defined(__has_include)
+#if __has_include("ProfilingDebugging/CpuProfilerTrace.h")
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#endif
+#endif
+
+#if defined(TRACE_CPUPROFILER_EVENT_SCOPE)
+#define DTRACK_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE(Name)
+#else
+#define DTRACK_TRACE_SCOPE(Name) SCOPED_NAMED_EVENT(Name, FColor::Cyan)
+#endif
+
+/** 
+ * "stat DTrack" shows these. Poll thread cost is in receive, parse, convert and inject,
+ * the game thread's in the handlers. Defined in FDTrackPlugin.cpp
+ */
+DECLARE_STATS_GROUP(TEXT("DTrack"), STATGROUP_DTrack, STATCAT_Advanced);
+
+// poll thread
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Receive (incl. wait)"), STAT_DTrackReceive, STATGROUP_DTrack, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Parse"), STAT_DTrackParse, STATGROUP_DTrack, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Convert"), STAT_DTrackConvert, STATGROUP_DTrack, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Inject"), STAT_DTrackInject, STATGROUP_DTrack, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Filter"), STAT_DTrackFilter, STATGROUP_DTrack, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Change Detection"), STAT_DTrackChanges, STATGROUP_DTrack, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Anim Frame"), STAT_DTrackAnimFrame, STATGROUP_DTrack, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Swap"), STAT_DTrackSwap, STATGROUP_DTrack, );
+
+// game thread
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Tick"), STAT_DTrackTick, STATGROUP_DTrack, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dispatch Bodies"), STAT_DTrackDispatchBodies, STATGROUP_DTrack, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dispatch Flysticks"), STAT_DTrackDispatchFlysticks, STATGROUP_DTrack, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dispatch Hands"), STAT_DTrackDispatchHands, STATGROUP_DTrack, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dispatch Human Models"), STAT_DTrackDispatchHumanModels, STATGROUP_DTrack, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sink Snapshot"), STAT_DTrackSnapshot, STATGROUP_DTrack, );
+
+// task graph workers
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Sinks"), STAT_DTrackSinks, STATGROUP_DTrack, );
+
+// counters
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Tracking frames per second"), STAT_DTrackFrameRate, STATGROUP_DTrack, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Targets per frame"), STAT_DTrackTargets, STATGROUP_DTrack, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Skipped frames"), STAT_DTrackSkipped, STATGROUP_DTrack, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Decimated dispatches"), STAT_DTrackDecimated, STATGROUP_DTrack, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Deferred dispatches"), STAT_DTrackDeferred, STATGROUP_DTrack, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Deferred human models"), STAT_DTrackDeferredHumans, STATGROUP_DTrack, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Frame lock interpolated"), STAT_DTrackLockInterpolated, STATGROUP_DTrack, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Frame lock late"), STAT_DTrackLockLate, STATGROUP_DTrack, );
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Playout delay (ms)"), STAT_DTrackPlayoutDelay, STATGROUP_DTrack, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Playout underruns"), STAT_DTrackPlayoutUnderruns, STATGROUP_DTrack, );
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Mutex wait (ms)"), STAT_DTrackMutexWait, STATGROUP_DTrack, );
+
+/** @brief scope lock that accounts the time spent waiting for the mutex
+ */
+class FDTrackScopeLock {
+
+	public:
+		explicit FDTrackScopeLock(FCriticalSection *n_mutex)
+				: m_start(FPlatformTime::Cycles64())
+				, m_lock(n_mutex) {
+
+			INC_FLOAT_STAT_BY(STAT_DTrackMutexWait, static_cast<float>(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - m_start)));
+		}
+
+	private:
+		const uint64 m_start;
+		FScopeLock   m_lock;
+};
@@ -25,26 +25,70 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "FDTrackPlugin.h"
-#include "DTrackPollThread.h"
+#include "DTrackSession.h"
+#include "DTrackDataSource.h"
+#include "DTrackComponent.h"
+#include "DTrackStats.h"
+#include "DTrackAnimFrame.h"
 #include "Math/UnrealMathUtility.h"
-#include "DTrackSDK.hpp"
+#include "HAL/IConsoleManager.h"
 
 IMPLEMENT_MODULE(FDTrackPlugin, DTrackPlugin)
 
 DEFINE_LOG_CATEGORY(DTrackPluginLog);
 
+DEFINE_STAT(STAT_DTrackReceive);
+DEFINE_STAT(STAT_DTrackParse);
+DEFINE_STAT(STAT_DTrackConvert);
+DEFINE_STAT(STAT_DTrackInject);
+DEFINE_STAT(STAT_DTrackFilter);
+DEFINE_STAT(STAT_DTrackChanges);
+DEFINE_STAT(STAT_DTrackAnimFrame);
+DEFINE_STAT(STAT_DTrackSwap);
+DEFINE_STAT(STAT_DTrackTick);
+DEFINE_STAT(STAT_DTrackDispatchBodies);
+DEFINE_STAT(STAT_DTrackDispatchFlysticks);
+DEFINE_STAT(STAT_DTrackDispatchHands);
+DEFINE_STAT(STAT_DTrackDispatchHumanModels);
+DEFINE_STAT(STAT_DTrackSnapshot);
+DEFINE_STAT(STAT_DTrackSinks);
+DEFINE_STAT(STAT_DTrackFrameRate);
+DEFINE_STAT(STAT_DTrackTargets);
+DEFINE_STAT(STAT_DTrackSkipped);
+DEFINE_STAT(STAT_DTrackDecimated);
+DEFINE_STAT(STAT_DTrackDeferred);
+DEFINE_STAT(STAT_DTrackDeferredHumans);
+DEFINE_STAT(STAT_DTrackLockInterpolated);
+DEFINE_STAT(STAT_DTrackLockLate);
+DEFINE_STAT(STAT_DTrackPlayoutDelay);
+DEFINE_STAT(STAT_DTrackPlayoutUnderruns);
+DEFINE_STAT(STAT_DTrackMutexWait);
+
 #define LOCTEXT_NAMESPACE "DTrackPlugin"
 
-#define PLUGIN_VERSION "0.3.0"
 
+FDTrackPlugin::~FDTrackPlugin() {
+
+}
 
 void FDTrackPlugin::StartupModule() {
 	
 	UE_LOG(DTrackPluginLog, Log, TEXT("Using DTrack Plugin, threaded version %s"), TEXT(PLUGIN_VERSION));
 
-	m_front.reset(new DataBuffer);
-	m_back.reset(new DataBuffer);
-	m_injected.reset(new DataBuffer);
+	m_console_commands.Add(IConsoleManager::Get().RegisterConsoleCommand(TEXT("DTrack.Replay"),
+			TEXT("Control a running DTrack replay: Step [n], Speed <factor>, Stepped <0|1>, Seek <seconds>, Position"),
+			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FDTrackPlugin::replay_command)));
+
+	m_console_commands.Add(IConsoleManager::Get().RegisterConsoleCommand(TEXT("DTrack.Latency"),
+			TEXT("DTrack latency probe: On, Off, Reset or Print (default)"),
+			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FDTrackPlugin::latency_command)));
+
+	m_console_commands.Add(IConsoleManager::Get().RegisterConsoleCommand(TEXT("DTrack.Stream"),
+			TEXT("Print DTrack frame loss, jitter and rate"),
+			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FDTrackPlugin::stream_command)));
+
+	m_console_commands.Add(IConsoleManager::Get().RegisterConsoleVariableRef(TEXT("DTrack.DispatchBudget"), m_dispatch_budget_ms,
+			TEXT("Milliseconds per frame for calling DTrack components. Over that, all but DP_Always ones are deferred. 0 for no limit")));
 
 	// quick test for extrapolation
 // 	FVector current;
@@ -68,65 +112,102 @@ void FDTrackPlugin::StartupModule() {
 
 void FDTrackPlugin::ShutdownModule() {
 
+	for (IConsoleObject *command : m_console_commands) {
+		IConsoleManager::Get().UnregisterConsoleObject(command);
+	}
+	m_console_commands.Empty();
+
 	// Another wait for potential asyncs. 
 	// Should be able to catch them but don't know how
 	FPlatformProcess::Sleep(0.1);
 
 	// we should have been stopped but what can you do?
-	if (m_polling_thread) {
-		m_polling_thread->interrupt();
-		m_polling_thread->join();
-		delete m_polling_thread;
-		m_polling_thread = nullptr;
+	m_sessions.clear();
+	FDTrackAnimChannel::reset_all();
+}
+
+FDTrackSession *FDTrackPlugin::find_session(const FString &n_key) {
+
+	for (const std::unique_ptr<FDTrackSession> &session : m_sessions) {
+		if (session->key() == n_key) {
+			return session.get();
+		}
+	}
+
+	return nullptr;
+}
+
+FDTrackSession *FDTrackPlugin::session_of(const UDTrackComponent *n_client) const {
+
+	for (const std::unique_ptr<FDTrackSession> &session : m_sessions) {
+		if (session->has(n_client)) {
+			return session.get();
+		}
 	}
 
-	m_front.reset();
-	m_back.reset();
-	m_injected.reset();
+	return nullptr;
 }
 
 void FDTrackPlugin::start_up(UDTrackComponent *n_client) {
 
-	if (!m_polling_thread) {
-		m_polling_thread = FDTrackPollThread::start(n_client, this);
+	// components pointing at the same endpoint share the session
+	FDTrackSession *session = find_session(FDTrackSession::endpoint(n_client));
+	if (!session) {
+		UE_LOG(DTrackPluginLog, Display, TEXT("Starting DTrack session for %s"), *FDTrackSession::endpoint(n_client));
+		m_sessions.emplace_back(new FDTrackSession(n_client, m_latency));
+		session = m_sessions.back().get();
 	}
 
 	// on error, the object is created but an error condition set within
-	m_clients.Add(n_client);
+	session->add(n_client);
 }
 
-void FDTrackPlugin::remove(class UDTrackComponent *n_client) {
+FDTrackSession *FDTrackPlugin::start_inline(UDTrackComponent *n_client, FDTrackDataSource *n_source) {
 
-	m_clients.RemoveAll([&](const TWeakObjectPtr<UDTrackComponent> p) {
-		return p.Get() == n_client;
-	});
-
-	// we have no reason to run anymore
-	if (m_polling_thread && (m_clients.Num() == 0)) {	
-		m_polling_thread->interrupt();
-		m_polling_thread->join();
-		delete m_polling_thread;
-		m_polling_thread = nullptr;
+	if (find_session(FDTrackSession::endpoint(n_client))) {
+		delete n_source;
+		return nullptr;
 	}
+
+	m_sessions.emplace_back(new FDTrackSession(n_client, m_latency, n_source));
+	FDTrackSession *session = m_sessions.back().get();
+	session->add(n_client);
+
+	return session;
 }
 
-FCriticalSection *FDTrackPlugin::swapping_mutex() {
+void FDTrackPlugin::remove(class UDTrackComponent *n_client) {
+
+	// someone else will have to tick us from now on
+	if (m_ticker.Get() == n_client) {
+		m_ticker.Reset();
+	}
 
-	return &m_swapping_mutex;
+	for (std::vector< std::unique_ptr<FDTrackSession> >::iterator i = m_sessions.begin(); i != m_sessions.end(); ++i) {
+		FDTrackSession *session = i->get();
+		if (session->remove(n_client)) {
+			// this endpoint has no reason to run anymore
+			if (session->num_clients() == 0) {
+				UE_LOG(DTrackPluginLog, Display, TEXT("Stopping DTrack session for %s"), *session->key());
+				m_sessions.erase(i);
+			}
+			return;
+		}
+	}
 }
 
-void FDTrackPlugin::tick(const float n_delta_time, const UDTrackComponent *n_component) {
+void FDTrackPlugin::tick(const float n_delta_time, const UDTrackComponent *n_component, const FGraphEventRef &n_completion) {
 
-	if (!m_polling_thread) {
+	if (m_sessions.empty()) {
 		return;
 	}
 	
 	// only one component may cause an actual tick to save performance.
 	// which one doesn't matter though. So I take any and store it
 	if (!m_ticker.IsValid()) {
-		for (TWeakObjectPtr<UDTrackComponent> c : m_clients) {
-			if (c.IsValid()) {
-				m_ticker = c;
+		for (const std::unique_ptr<FDTrackSession> &session : m_sessions) {
+			m_ticker = session->any_client();
+			if (m_ticker.IsValid()) {
 				break;
 			}
 		}
@@ -138,264 +219,168 @@ void FDTrackPlugin::tick(const float n_delta_time, const UDTrackComponent *n_com
 		return;
 	}
 
-	// iterate all registered components and call the interface methods upon them
-	for (TWeakObjectPtr<UDTrackComponent> c : m_clients) {
-		// components might get killed and created along the way.
-		// I only operate those which seem to live OK
-		UDTrackComponent *component = c.Get();
-		if (component) {
-			// now handle the different tracking types by calling the component
-			
-			handle_bodies(component);
-			handle_flysticks(component);
-			handle_hands(component);
-			handle_human_model(component);
+	SCOPE_CYCLE_COUNTER(STAT_DTrackTick);
+	DTRACK_TRACE_SCOPE(DTrackTick);
+
+	// all endpoints are dispatched the same way, one after the other, sharing the budget
+	const uint64 deadline = (m_dispatch_budget_ms > 0.0f)
+			? FPlatformTime::Cycles64() + static_cast<uint64>(m_dispatch_budget_ms / (1000.0 * FPlatformTime::GetSecondsPerCycle64())) : 0;
+	FGraphEventArray sink_tasks;
+	for (const std::unique_ptr<FDTrackSession> &session : m_sessions) {
+		session->tick(deadline, sink_tasks);
+	}
+
+	// Sinks on workers. The engine waits for them before the caller's tick group ends,
+	// the game thread goes on meanwhile
+	if (sink_tasks.Num()) {
+		if (n_completion.GetReference()) {
+			for (const FGraphEventRef &task : sink_tasks) {
+				n_completion->DontCompleteUntil(task);
+			}
+		} else {
+			FTaskGraphInterface::Get().WaitUntilTasksComplete(sink_tasks, ENamedThreads::GameThread);
 		}
 	}
 }
 
-/************************************************************************/
-/* Injection routines                                                   */
-/* Called as lambdas from polling thread, executed in game thread       */
-/************************************************************************/
-void FDTrackPlugin::inject_body_data(const int n_body_id, const FVector &n_translation, const FRotator &n_rotation) {
+void FDTrackPlugin::replay_command(const TArray<FString> &n_args) {
 
-	check(m_injected);
-	TArray<FDTrackBody> &body_inject = m_injected->m_body_data;
+	const FString command = n_args.Num() ? n_args[0] : FString(TEXT("Position"));
+	const FString value = (n_args.Num() > 1) ? n_args[1] : FString();
 
-	if (body_inject.Num() < (n_body_id + 1)) {
-		body_inject.SetNumZeroed(n_body_id + 1, false);
+	bool found = false;
+	for (const std::unique_ptr<FDTrackSession> &session : m_sessions) {
+		FDTrackReplaySource *replay = session->replay();
+		if (replay) {
+			found = true;
+			replay_command(*replay, command, value);
+		}
 	}
 
-	body_inject[n_body_id].m_location = n_translation;
-	body_inject[n_body_id].m_rotation = n_rotation;
+	if (!found) {
+		UE_LOG(DTrackPluginLog, Warning, TEXT("No DTrack replay running"));
+	}
 }
 
-void FDTrackPlugin::inject_flystick_data(const int n_flystick_id, const FVector &n_translation, const FRotator &n_rotation, const TArray<int> &n_button_state, const TArray<float> &n_joystick_state) {
-
-	check(m_injected);
-	TArray<FDTrackFlystick> &flystick_inject = m_injected->m_flystick_data;
-
-	if (flystick_inject.Num() < (n_flystick_id + 1)) {
-		flystick_inject.SetNumZeroed(n_flystick_id + 1, false);
+void FDTrackPlugin::replay_command(FDTrackReplaySource &n_replay, const FString &n_command, const FString &n_value) {
+
+	if (n_command == TEXT("Step")) {
+		n_replay.step(n_value.IsEmpty() ? 1 : FCString::Atoi(*n_value));
+	} else if (n_command == TEXT("Speed")) {
+		n_replay.set_speed(FCString::Atof(*n_value));
+	} else if (n_command == TEXT("Stepped")) {
+		n_replay.set_stepped(FCString::Atoi(*n_value) != 0);
+	} else if (n_command == TEXT("Seek")) {
+		n_replay.seek(FCString::Atod(*n_value));
+	} else if (n_command == TEXT("Position")) {
+		UE_LOG(DTrackPluginLog, Display, TEXT("DTrack replay at %.3f s"), n_replay.position());
+	} else {
+		UE_LOG(DTrackPluginLog, Warning, TEXT("Unknown DTrack.Replay command '%s'"), *n_command);
 	}
-
-	flystick_inject[n_flystick_id].m_location = n_translation;
-	flystick_inject[n_flystick_id].m_rotation = n_rotation;
-	flystick_inject[n_flystick_id].m_button_states = n_button_state;
-	flystick_inject[n_flystick_id].m_joystick_states = n_joystick_state;
 }
 
-void FDTrackPlugin::inject_hand_data(const int n_hand_id, const bool &n_right, const FVector &n_translation, const FRotator &n_rotation, const TArray<FDTrackFinger> &n_fingers) {
+void FDTrackPlugin::latency_command(const TArray<FString> &n_args) {
 
-	check(m_injected);
-	TArray<FDTrackHand> &hand_inject = m_injected->m_hand_data;
+	const FString command = n_args.Num() ? n_args[0] : FString(TEXT("Print"));
 
-	if (hand_inject.Num() < (n_hand_id + 1)) {
-		hand_inject.SetNumZeroed(n_hand_id + 1, false);
+	if (command == TEXT("On")) {
+		set_latency_probe(true);
+	} else if (command == TEXT("Off")) {
+		set_latency_probe(false);
+	} else if (command == TEXT("Reset")) {
+		reset_latency();
+	} else if (command == TEXT("Print")) {
+		m_latency.print();
+	} else {
+		UE_LOG(DTrackPluginLog, Warning, TEXT("Unknown DTrack.Latency command '%s'"), *command);
 	}
-
-	hand_inject[n_hand_id].m_right = n_right;
-	hand_inject[n_hand_id].m_location = n_translation;
-	hand_inject[n_hand_id].m_rotation = n_rotation;
-	hand_inject[n_hand_id].m_fingers = n_fingers;
 }
 
-void FDTrackPlugin::inject_human_model_data(const int n_human_id, const TArray<FDTrackJoint> &n_joints) {
-	
-	check(m_injected);
-	TArray<FDTrackHuman> &human_inject = m_injected->m_human_model_data;
-
-	if (human_inject.Num() < (n_human_id + 1)) {
-		human_inject.SetNumZeroed(n_human_id + 1, false);
-	}
+void FDTrackPlugin::set_latency_probe(const bool n_enabled) {
 
-	human_inject[n_human_id].m_joints = n_joints;
+	m_latency.set_enabled(n_enabled);
 }
 
-void FDTrackPlugin::begin_injection() {
+void FDTrackPlugin::reset_latency() {
 
-	m_last_injection_time = m_current_injection_time;
-	m_current_injection_time = FPlatformTime::Cycles64();
+	m_latency.reset();
 }
 
-void FDTrackPlugin::end_injection() {
+FDTrackLatencyStats FDTrackPlugin::latency(const EDTrackLatencyStage n_stage) const {
 
-	// injection vector becomes front now, front becomes back and back becomes 
-	// the new injection data storage
-	FScopeLock lock(swapping_mutex());
-	std::swap(m_front, m_back);
-	std::swap(m_front, m_injected);
+	return m_latency.stats(n_stage);
 }
 
-// y = dst
-// y1 = last
-// y2 = current
-void FDTrackPlugin::extrapolate(FVector &y, const FVector &y1, const FVector &y2) const {
+void FDTrackPlugin::stream_command(const TArray<FString> &n_args) {
 
-	uint64 now = FPlatformTime::Cycles64();
-
-	// If the values we have are very recent I don't extrapolate and just return the latest
-	if (now < m_current_injection_time + 10) {
-		y = y2;
-		return;
-	}
-
-	// this should cover startup conditions
-	if (!m_current_injection_time || !m_last_injection_time) {		
-		y = y2;
+	if (m_sessions.empty()) {
+		UE_LOG(DTrackPluginLog, Display, TEXT("No DTrack session running"));
 		return;
 	}
 
-	// unlikely since we use cycles but we could run twice so close together
-	if (m_current_injection_time == m_last_injection_time) {
-		y = y2;
-		return;
+	for (const std::unique_ptr<FDTrackSession> &session : m_sessions) {
+		const FDTrackStreamStats stats = session->stream_stats();
+
+		UE_LOG(DTrackPluginLog, Display, TEXT("DTrack stream %s %s: %llu frames, %llu missing, %llu duplicate, %llu out of order, %llu restarts"),
+				*session->key(), *StaticEnum<EDTrackStreamState>()->GetNameStringByValue(static_cast<int64>(stats.m_state)),
+				stats.m_frames, stats.m_missing, stats.m_duplicates, stats.m_out_of_order, stats.m_restarts);
+		UE_LOG(DTrackPluginLog, Display, TEXT("DTrack stream %s rate %.1f Hz (controller %.1f Hz), jitter p50 %.0f us p99 %.0f us max %.0f us, last frame %.3f s ago"),
+				*session->key(), stats.m_receive_rate, stats.m_controller_rate, stats.m_jitter_p50, stats.m_jitter_p99, stats.m_jitter_max,
+				stats.m_seconds_since_last_frame);
+		if (stats.m_playout_delay > 0.0) {
+			UE_LOG(DTrackPluginLog, Display, TEXT("DTrack stream %s playout delay %.1f ms, %llu underruns"),
+					*session->key(), stats.m_playout_delay, stats.m_playout_underruns);
+		}
 	}
-
-
-	// f(x) = y1 + ((x - x1) / (x2 - x1)) * (y2 - y1)
-	//              ^-----factor--------^
-
-	float factor = ((now - m_last_injection_time) / (m_current_injection_time - m_last_injection_time));
-
-	y.X = y1.X + factor * (y2.X - y1.X);
-	y.Y = y1.Y + factor * (y2.Y - y1.Y);
-	y.Z = y1.Z + factor * (y2.Z - y1.Z);
 }
 
-void FDTrackPlugin::extrapolate(FRotator &n_y, const FRotator &n_y1, const FRotator &n_y2) const {
-
-	uint64 now = FPlatformTime::Cycles64();
+FDTrackStreamStats FDTrackPlugin::stream_stats() const {
 
-	// If the values we have are very recent I don't extrapolate and just return the latest
-	if (now < m_current_injection_time + 10) {
-		n_y = n_y2;
-		return;
-	}
-
-	// this should cover startup conditions
-	if (!m_current_injection_time || !m_last_injection_time) {
-		n_y = n_y2;
-		return;
-	}
-
-	// unlikely since we use cycles but we could run twice so close together
-	if (m_current_injection_time == m_last_injection_time) {
-		n_y = n_y2;
-		return;
-	}
-
-	// I will use quaternions of those because I have no idea what happens when 
-	// I extrapolate those Eulers
-	FQuat y1 = n_y1.Quaternion();
-	FQuat y2 = n_y2.Quaternion();
-	FQuat ret;
-
-	// f(x) = y1 + ((x - x1) / (x2 - x1)) * (y2 - y1)
-	//              ^-----factor--------^
-
-	float factor = ((now - m_last_injection_time) / (m_current_injection_time - m_last_injection_time));
-	ret.W = y1.W + factor * (y2.W - y1.W);
-	ret.X = y1.X + factor * (y2.X - y1.X);
-	ret.Y = y1.Y + factor * (y2.Y - y1.Y);
-	ret.Z = y1.Z + factor * (y2.Z - y1.Z);
-	n_y = ret.Rotator();
+	// sessions are kept in the order they started
+	return m_sessions.empty() ? FDTrackStreamStats() : m_sessions.front()->stream_stats();
 }
 
+FDTrackStreamStats FDTrackPlugin::stream_stats(const UDTrackComponent *n_client) const {
 
-/************************************************************************/
-/* Handler methods. Called in game thread tick                          */
-/* to relay information to components                                   */
-/************************************************************************/
-void FDTrackPlugin::handle_bodies(UDTrackComponent *n_component) {
-	
-	check(m_front);
-	check(m_back);
-
-	FScopeLock lock(swapping_mutex());
-	for (int32 i = 0; i < m_front->m_body_data.Num(); i++) {
-
-		const FDTrackBody &current_body = m_front->m_body_data[i];
-
-		// This should occur only once while starting up
-		// No extrapolation with one data set
-		if (m_back->m_body_data.Num() != m_front->m_body_data.Num()) {
-			n_component->body_tracking(i, current_body.m_location, current_body.m_rotation);
-		} else {
-			const FDTrackBody &last_body = m_back->m_body_data[i];
-
-			FVector extrapolated_location;
-			extrapolate(extrapolated_location, last_body.m_location, current_body.m_location);
+	const FDTrackSession *session = session_of(n_client);
+	return session ? session->stream_stats() : FDTrackStreamStats();
+}
 
-			FRotator extrapolated_rotation;
-			extrapolate(extrapolated_rotation, last_body.m_rotation, current_body.m_rotation);
+bool FDTrackPlugin::pose_at(const UDTrackComponent *n_client, const EDTrackTargetType n_type, const int32 n_id,
+		const double n_time, FVector &n_location, FRotator &n_rotation) const {
 
-			n_component->body_tracking(i, extrapolated_location, extrapolated_rotation);
-		}
-	}
+	const FDTrackSession *session = session_of(n_client);
+	return session && session->pose_at(n_type, n_id, n_time, n_location, n_rotation);
 }
 
-void FDTrackPlugin::handle_flysticks(UDTrackComponent *n_component) {
+double FDTrackPlugin::sample_time(const UDTrackComponent *n_client) const {
 
-	// treat all flysticks
-	FScopeLock lock(swapping_mutex());
-	for (int32 i = 0; i < m_front->m_flystick_data.Num(); i++) {
-
-		FDTrackFlystick &current_flystick = m_front->m_flystick_data[i];
+	const FDTrackSession *session = session_of(n_client);
+	return session ? session->sample_time() : 0.0;
+}
 
-		// tracking first, it's always called
-		n_component->flystick_tracking(i, current_flystick.m_location, current_flystick.m_rotation);
+bool FDTrackPlugin::target_status(const UDTrackComponent *n_client, const EDTrackTargetType n_type, const int32 n_id,
+		FDTrackTargetStatus &n_status) const {
 
-		if (current_flystick.m_button_states.Num()) {
-			// compare button states with the last seen state, calling button handlers if appropriate
+	FDTrackSession *session = session_of(n_client);
+	return session && session->target_status(n_type, n_id, n_status);
+}
 
-			// See if we have to resize our actual state vector to accommodate this.
-			if (m_last_button_states.size() < (i + 1)) {
-				// vector too small, insert new empties to pad
-				TArray<int> new_stick;
-				new_stick.SetNumZeroed(DTRACKSDK_FLYSTICK_MAX_BUTTON);
-				m_last_button_states.resize(i + 1, new_stick);
-			}
-			
-			const TArray<int> &current_states = current_flystick.m_button_states;
-			TArray<int> &last_states = m_last_button_states[i];
-
-			// have to go through all the button states now to figure out which ones have differed
-			for (int32 b = 0; b < current_states.Num(); b++) {
-				if (current_states[b] != last_states[b]) {
-					last_states[b] = current_states[b];
-					n_component->flystick_button(i, b, (current_states[b] == 1));
-				}
-			}
-		}
+void FDTrackPlugin::add_sink(const UDTrackComponent *n_client, const TSharedRef<IDTrackSink, ESPMode::ThreadSafe> &n_sink, const bool n_thread_safe) {
 
-		// Call joysticks if we have 'em
-		if (current_flystick.m_joystick_states.Num()) {
-			n_component->flystick_joystick(i, current_flystick.m_joystick_states);
-		}
+	FDTrackSession *session = session_of(n_client);
+	if (!session) {
+		UE_LOG(DTrackPluginLog, Warning, TEXT("DTrack sink not added, the component isn't started"));
+		return;
 	}
 
-	// that's it. Flystick all done.
+	session->add_sink(n_sink, n_thread_safe);
 }
 
-void FDTrackPlugin::handle_hands(UDTrackComponent *n_component) {
+void FDTrackPlugin::remove_sink(const TSharedRef<IDTrackSink, ESPMode::ThreadSafe> &n_sink) {
 
-	// treat all tracked hands
-	FScopeLock lock(swapping_mutex());
-	for (int32 i = 0; i < m_front->m_hand_data.Num(); i++) {
-		const FDTrackHand &hand = m_front->m_hand_data[i];
-		n_component->hand_tracking(i, hand.m_right, hand.m_location, hand.m_rotation, hand.m_fingers);
-	}
-}
-
-void FDTrackPlugin::handle_human_model(UDTrackComponent *n_component) {
-	
-	FScopeLock lock(swapping_mutex());
-	// treat all tracked hands
-	for (int32 i = 0; i < m_front->m_human_model_data.Num(); i++) {
-		const FDTrackHuman &human = m_front->m_human_model_data[i];
-		n_component->human_model(i, human.m_joints);
+	for (const std::unique_ptr<FDTrackSession> &session : m_sessions) {
+		session->remove_sink(n_sink);
 	}
 }
 
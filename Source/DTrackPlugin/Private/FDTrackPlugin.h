@@ -29,19 +29,29 @@
 #include "CoreMinimal.h"
 #include "IDTrackPlugin.h"
 #include "DTrackInterface.h"
+#include "DTrackLatencyProbe.h"
 
 #include <vector>
 #include <memory>
 
+#define PLUGIN_VERSION "0.3.0"
+
+class FDTrackSession;
+class FDTrackDataSource;
+class FDTrackReplaySource;
+
 class FDTrackPlugin : public IDTrackPlugin {
 
 	public:
+		/// defined where sessions are complete
+		~FDTrackPlugin();
+
 		/** IModuleInterface implementation */
 		void StartupModule() override;
 		void ShutdownModule() override;
 
 		/** Manual looping, currently called in main thread */
-		void tick(const float n_delta_time, const UDTrackComponent *n_component) override;
+		void tick(const float n_delta_time, const UDTrackComponent *n_component, const FGraphEventRef &n_completion = FGraphEventRef()) override;
 
 		/// register this component with the tracking system
 		void start_up(class UDTrackComponent *n_client) override;
@@ -49,72 +59,61 @@ class FDTrackPlugin : public IDTrackPlugin {
 		/// tell the plugin we're no longer interested in tracking data
 		void remove(class UDTrackComponent *n_client) override;
 
-		FCriticalSection *swapping_mutex();
-		
-	private:
-		
-		friend class FDTrackPollThread;
+		/**
+		 * Register a client with a session whose poll thread doesn't run on its own but is 
+		 * driven by the caller, reading from the given source. For benchmarks. Returns null if 
+		 * the client's endpoint is in use already. Remove the client to end it.
+		 */
+		FDTrackSession *start_inline(class UDTrackComponent *n_client, FDTrackDataSource *n_source);
 
-		/// polling thread injects body tracking data for later retrieval
-		/// call in game thread, not mutexed!
-		void inject_body_data(const int n_body_id, const FVector &n_translation, const FRotator &n_rotation);
+		void set_latency_probe(const bool n_enabled) override;
+		void reset_latency() override;
+		FDTrackLatencyStats latency(const EDTrackLatencyStage n_stage) const override;
+		FDTrackStreamStats stream_stats() const override;
+		FDTrackStreamStats stream_stats(const UDTrackComponent *n_client) const override;
 
-		/// polling thread injects flystick data for later retrieval
-		void inject_flystick_data(const int n_flystick_id, const FVector &n_translation, const FRotator &n_rotation,
-					const TArray<int> &n_button_state, const TArray<float> &n_joystick_state);
+		bool pose_at(const UDTrackComponent *n_client, const EDTrackTargetType n_type, const int32 n_id,
+				const double n_time, FVector &n_location, FRotator &n_rotation) const override;
 
-		/// polling thread injects hand tracking data for later retrieval
-		void inject_hand_data(const int n_hand_id, const bool &n_right, const FVector &n_translation, 
-					const FRotator &n_rotation, const TArray<FDTrackFinger> &n_fingers);
+		double sample_time(const UDTrackComponent *n_client) const override;
 
-		/// polling thread injects hand tracking data for later retrieval
-		void inject_human_model_data(const int n_human_id, const TArray<FDTrackJoint> &n_joints);
+		bool target_status(const UDTrackComponent *n_client, const EDTrackTargetType n_type, const int32 n_id,
+				FDTrackTargetStatus &n_status) const override;
 
-		/// begin enter values and measure time
-		void begin_injection();
-		void end_injection();
-
-		void extrapolate(FVector &y, const FVector &y1, const FVector &y2) const;
-		void extrapolate(FRotator &n_y, const FRotator &n_y1, const FRotator &n_y2) const;
-
-		/// For front and back buffer of data sent by polling thread
-		struct DataBuffer {
-			TArray<FDTrackBody>        m_body_data;          //!< cached body data being injected by thread
-			TArray<FDTrackFlystick>    m_flystick_data;      //!< cached flystick tracking info
-			TArray<FDTrackHand>  m_hand_data;          //!< cached hand tracking info
-			TArray<FDTrackHuman>       m_human_model_data;   //!< cached human model info
-		};
+		void add_sink(const UDTrackComponent *n_client, const TSharedRef<IDTrackSink, ESPMode::ThreadSafe> &n_sink, const bool n_thread_safe) override;
+		void remove_sink(const TSharedRef<IDTrackSink, ESPMode::ThreadSafe> &n_sink) override;
+		
+	private:
 
-		/// unreal doesn't seem to have condition variables
-		FCriticalSection         m_swapping_mutex;
-		uint64                   m_current_injection_time = 0;
-		uint64                   m_last_injection_time = 0;
+		/// console commands controlling a replay, if one is running
+		void replay_command(const TArray<FString> &n_args);
+		void replay_command(FDTrackReplaySource &n_replay, const FString &n_command, const FString &n_value);
 
+		/// console command for the latency probe
+		void latency_command(const TArray<FString> &n_args);
 
-		std::unique_ptr<DataBuffer> m_front;           //!< current data to read by game thread
-		std::unique_ptr<DataBuffer> m_back;            //!< last values 
-		std::unique_ptr<DataBuffer> m_injected;        //!< values being injected  
+		/// console command printing stream statistics
+		void stream_command(const TArray<FString> &n_args);
 
-		std::vector< TArray<int> > m_last_button_states;
+		/// registered console commands, unregistered on shutdown
+		TArray<class IConsoleObject *> m_console_commands;
 
-		class FDTrackPollThread *m_polling_thread = nullptr;
-			
-		/// consider the current frame's 6dof bodies and call the component if appropriate
-		void handle_bodies(UDTrackComponent *n_component);
+		/// the session for this endpoint, null if there is none
+		FDTrackSession *find_session(const FString &n_key);
 
-		/// consider the current frame's flystick tracking and button and call the component if appropriate
-		void handle_flysticks(UDTrackComponent *n_component);
-	
-		/// treat everything hand and finger tracking relevant
-		void handle_hands(UDTrackComponent *n_component);
+		/// the session this client is subscribed to, null if none
+		FDTrackSession *session_of(const UDTrackComponent *n_client) const;
 
-		/// extract and hand out human model (mocap?) data
-		void handle_human_model(UDTrackComponent *n_component);
+		/// measures frame latency from arrival to dispatch if enabled, for all sessions
+		FDTrackLatencyProbe        m_latency;
 
-		/// each DTrack component registers itself here and gets called every tick
-		TArray< TWeakObjectPtr<UDTrackComponent> > m_clients;
+		/// one for each endpoint any component is interested in
+		std::vector< std::unique_ptr<FDTrackSession> > m_sessions;
 
 		/// only one of the client components will cause us to tick, so we don't do unnecessary frame ticks
 		TWeakObjectPtr<UDTrackComponent>           m_ticker;
 
-};
\ No newline at end of file
+		/// DTrack.DispatchBudget, game thread time per frame for calling components. 0 for no limit
+		float                                      m_dispatch_budget_ms = 0.0f;
+
+};
@@ -0,0 +1,348 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackCapture.h"
+#include "DTrackDataSource.h"
+#include "DTrackLatencyProbe.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+using namespace DTrackCapture;
+
+namespace {
+
+/// fewer than the writer has slots, so none get dropped however slow the disk is
+const int32 CaptureFrames = 200;
+
+/// a datagram as it was handed to the writer
+struct Written {
+	TArray<char> m_data;
+	uint32       m_frame_counter = 0;
+	uint64       m_receive_cycles = 0;
+};
+
+FString test_file(const TCHAR *n_name) {
+
+	return FPaths::Combine(FPaths::AutomationTransientDir(), n_name);
+}
+
+/// bodies, a hand and a human, so datagrams come in different sizes
+FDTrackWorkload test_workload() {
+
+	FDTrackWorkload ret;
+	ret.m_bodies = 6;
+	ret.m_flysticks = 1;
+	ret.m_hands = 1;
+	ret.m_humans = 1;
+	return ret;
+}
+
+/// record synthetic frames a millisecond apart and close the capture
+bool write_capture(FAutomationTestBase &n_test, const FString &n_file_name, TArray<Written> &n_written) {
+
+	FDTrackSyntheticSource source(test_workload(), CaptureFrames);
+	source.start();
+
+	FDTrackCaptureWriter writer(n_file_name);
+	if (!writer.is_open()) {
+		n_test.AddError(FString::Printf(TEXT("Could not open '%s' for writing"), *n_file_name));
+		return false;
+	}
+
+	// after the writer's start, so no arrival lies before the capture
+	const uint64 first_cycles = FPlatformTime::Cycles64();
+	const uint64 millisecond = static_cast<uint64>(0.001 / FPlatformTime::GetSecondsPerCycle64());
+
+	n_written.SetNum(CaptureFrames);
+	for (int32 i = 0; i < CaptureFrames; i++) {
+		source.receive();
+
+		Written &written = n_written[i];
+		written.m_data.Append(source.datagram(), source.datagram_size());
+		written.m_frame_counter = source.frame_counter();
+		written.m_receive_cycles = first_cycles + i * millisecond;
+		writer.record(source.datagram(), source.datagram_size(), written.m_receive_cycles, written.m_frame_counter);
+	}
+
+	n_test.TestEqual(TEXT("Dropped datagrams"), writer.dropped(), 0);
+	return true;
+}
+
+/// where the record of each datagram has to start in the file
+TArray<uint64> expected_offsets(const TArray<Written> &n_written) {
+
+	TArray<uint64> ret;
+	uint64 offset = sizeof(FDTrackCaptureHeader);
+	for (const Written &written : n_written) {
+		ret.Add(offset);
+		offset += sizeof(FDTrackCaptureRecordHeader) + padded_size(written.m_data.Num());
+	}
+
+	return ret;
+}
+
+/// check what a reader finds against the first n_count datagrams written
+void check_records(FAutomationTestBase &n_test, const FString &n_what, const FDTrackCaptureReader &n_reader, 
+		const TArray<Written> &n_written, const int64 n_count) {
+
+	if (!n_test.TestEqual(n_what + TEXT(": records"), n_reader.num_records(), n_count)) {
+		return;
+	}
+
+	FString error;
+	if (!n_reader.validate(error)) {
+		n_test.AddError(n_what + TEXT(": ") + error);
+	}
+
+	const TArray<uint64> offsets = expected_offsets(n_written);
+	const double us_per_cycle = FPlatformTime::GetSecondsPerCycle64() * 1000000.0;
+
+	FDTrackCaptureRecord first;
+	n_reader.record(0, first);
+
+	for (int64 i = 0; i < n_count; i++) {
+		const Written &written = n_written[i];
+		const FString at = FString::Printf(TEXT("%s: record %lld"), *n_what, i);
+
+		FDTrackCaptureRecord record;
+		if (!n_test.TestTrue(at + TEXT(" exists"), n_reader.record(i, record))) {
+			return;
+		}
+
+		// records are mapped in place, so their distance is the distance of the offsets
+		n_test.TestEqual(at + TEXT(" offset"), static_cast<uint64>(record.m_data - first.m_data), offsets[i] - offsets[0]);
+		n_test.TestEqual(at + TEXT(" frame counter"), record.m_frame_counter, written.m_frame_counter);
+
+		// each time is truncated to whole microseconds, hence the tolerance
+		const double expected_us = (written.m_receive_cycles - n_written[0].m_receive_cycles) * us_per_cycle;
+		const double actual_us = static_cast<double>(record.m_receive_time_us - first.m_receive_time_us);
+		n_test.TestEqual(at + TEXT(" receive time"), actual_us, expected_us, 1.0);
+
+		if (n_test.TestEqual(at + TEXT(" size"), record.m_size, written.m_data.Num())) {
+			n_test.TestTrue(at + TEXT(" content"), !FMemory::Memcmp(record.m_data, written.m_data.GetData(), record.m_size));
+		}
+	}
+}
+
+/// the index as the writer left it in the file, read without the reader
+void check_index(FAutomationTestBase &n_test, const TArray<uint8> &n_file, const TArray<Written> &n_written) {
+
+	const FDTrackCaptureHeader *header = reinterpret_cast<const FDTrackCaptureHeader *>(n_file.GetData());
+	if (!n_test.TestEqual(TEXT("Index entries"), header->m_record_count, static_cast<uint64>(n_written.Num()))) {
+		return;
+	}
+
+	const TArray<uint64> offsets = expected_offsets(n_written);
+	const uint64 records_end = offsets.Last() + sizeof(FDTrackCaptureRecordHeader) + padded_size(n_written.Last().m_data.Num());
+	n_test.TestEqual(TEXT("Index offset"), header->m_index_offset, records_end);
+	if (header->m_index_offset + header->m_record_count * sizeof(FDTrackCaptureIndexEntry) != static_cast<uint64>(n_file.Num())) {
+		n_test.AddError(TEXT("Index does not end the file"));
+		return;
+	}
+
+	const FDTrackCaptureIndexEntry *index = reinterpret_cast<const FDTrackCaptureIndexEntry *>(n_file.GetData() + header->m_index_offset);
+	for (int32 i = 0; i < n_written.Num(); i++) {
+		const FString at = FString::Printf(TEXT("Index entry %d"), i);
+		n_test.TestEqual(at + TEXT(" offset"), index[i].m_offset, offsets[i]);
+		n_test.TestEqual(at + TEXT(" frame counter"), index[i].m_frame_counter, n_written[i].m_frame_counter);
+		n_test.TestEqual(at + TEXT(" size"), index[i].m_size, static_cast<uint32>(n_written[i].m_data.Num()));
+
+		const FDTrackCaptureRecordHeader *record = reinterpret_cast<const FDTrackCaptureRecordHeader *>(n_file.GetData() + offsets[i]);
+		n_test.TestEqual(at + TEXT(" receive time"), index[i].m_receive_time_us, record->m_receive_time_us);
+	}
+}
+
+}
+
+/************************************************************************/
+/* Round trip                                                           */
+/************************************************************************/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDTrackCaptureRoundTripTest, "DTrack.Capture.RoundTrip",
+		EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDTrackCaptureRoundTripTest::RunTest(const FString &Parameters) {
+
+	const FString file_name = test_file(TEXT("DTrackRoundTrip.capture"));
+	const FString truncated_name = test_file(TEXT("DTrackTruncated.capture"));
+	const FString unindexed_name = test_file(TEXT("DTrackUnindexed.capture"));
+
+	TArray<Written> written;
+	if (!write_capture(*this, file_name, written)) {
+		return false;
+	}
+
+	TArray<uint8> file;
+	if (!FFileHelper::LoadFileToArray(file, *file_name)) {
+		AddError(FString::Printf(TEXT("Could not load '%s'"), *file_name));
+		return false;
+	}
+
+	check_index(*this, file, written);
+
+	{
+		FDTrackCaptureReader reader;
+		if (TestTrue(TEXT("Closed capture opens"), reader.open(file_name))) {
+			check_records(*this, TEXT("Closed capture"), reader, written, written.Num());
+		}
+	}
+
+	// both of these come without a usable index and have it rebuilt
+	AddExpectedError(TEXT("was not closed properly"), EAutomationExpectedErrorFlags::Contains, 2);
+
+	const uint64 index_offset = reinterpret_cast<const FDTrackCaptureHeader *>(file.GetData())->m_index_offset;
+
+	// died before the index was written, the header never got patched
+	TArray<uint8> unindexed(file.GetData(), static_cast<int32>(index_offset));
+	FDTrackCaptureHeader *header = reinterpret_cast<FDTrackCaptureHeader *>(unindexed.GetData());
+	header->m_index_offset = 0;
+	header->m_record_count = 0;
+	FFileHelper::SaveArrayToFile(unindexed, *unindexed_name);
+	{
+		FDTrackCaptureReader reader;
+		if (TestTrue(TEXT("Capture without index opens"), reader.open(unindexed_name))) {
+			check_records(*this, TEXT("Capture without index"), reader, written, written.Num());
+		}
+	}
+
+	// died in the middle of the last record, which has to be left out
+	const uint64 last_offset = expected_offsets(written).Last();
+	TArray<uint8> truncated(file.GetData(), static_cast<int32>(last_offset + sizeof(FDTrackCaptureRecordHeader) + written.Last().m_data.Num() / 2));
+	FFileHelper::SaveArrayToFile(truncated, *truncated_name);
+	{
+		FDTrackCaptureReader reader;
+		if (TestTrue(TEXT("Truncated capture opens"), reader.open(truncated_name))) {
+			check_records(*this, TEXT("Truncated capture"), reader, written, written.Num() - 1);
+		}
+	}
+
+	// and replayed it's the same datagrams in the same order
+	{
+		FDTrackReplaySource replay(file_name, 0.0f, false, false);
+		if (TestTrue(TEXT("Replay starts"), replay.start())) {
+			for (int32 i = 0; i < written.Num(); i++) {
+				const FString at = FString::Printf(TEXT("Replayed frame %d"), i);
+				if (!TestTrue(at + TEXT(" received"), replay.receive())) {
+					break;
+				}
+
+				TestEqual(at + TEXT(" frame counter"), replay.frame_counter(), written[i].m_frame_counter);
+				if (TestEqual(at + TEXT(" size"), replay.datagram_size(), written[i].m_data.Num())) {
+					TestTrue(at + TEXT(" content"), !FMemory::Memcmp(replay.datagram(), written[i].m_data.GetData(), replay.datagram_size()));
+				}
+			}
+			replay.stop();
+		}
+	}
+
+	IFileManager::Get().Delete(*file_name);
+	IFileManager::Get().Delete(*unindexed_name);
+	IFileManager::Get().Delete(*truncated_name);
+
+	return true;
+}
+
+/************************************************************************/
+/* Receive latency                                                      */
+/************************************************************************/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDTrackCaptureLatencyTest, "DTrack.Capture.ReceiveLatency",
+		EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FDTrackCaptureLatencyTest::RunTest(const FString &Parameters) {
+
+	// Recording must not slow down the receive loop. It only copies the datagram into 
+	// a slot, so at the 99th percentile it may add a few microseconds and not more
+	static const int32 Frames = 2000;
+	static const double MaxAddedMicroseconds = 25.0;
+
+	const FString replay_name = test_file(TEXT("DTrackLatencyReplay.capture"));
+	const FString record_name = test_file(TEXT("DTrackLatencyRecord.capture"));
+
+	TArray<Written> written;
+	if (!write_capture(*this, replay_name, written)) {
+		return false;
+	}
+
+	FDTrackReplaySource replay(replay_name, 0.0f, false, true);
+	if (!TestTrue(TEXT("Replay starts"), replay.start())) {
+		return false;
+	}
+
+	// what the poll thread does for every datagram, timed
+	auto run = [&](FDTrackCaptureWriter *n_writer, FDTrackLatencyHistogram &n_histogram) {
+		for (int32 i = 0; i < Frames; i++) {
+			const uint64 start = FPlatformTime::Cycles64();
+			if (replay.receive() && n_writer) {
+				n_writer->record(replay.datagram(), replay.datagram_size(), replay.receive_cycles(), replay.frame_counter());
+			}
+			n_histogram.add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - start) * 1000.0);
+
+			// about the pace of a tracking system, so the writer keeps up and no datagram takes the cheap drop path
+			FPlatformProcess::Sleep(0.0002f);
+		}
+	};
+
+	// once around the capture so it's mapped and the parser has its buffers
+	FDTrackLatencyHistogram warm_up;
+	run(nullptr, warm_up);
+
+	FDTrackLatencyHistogram off;
+	run(nullptr, off);
+
+	FDTrackLatencyHistogram on;
+	{
+		FDTrackCaptureWriter writer(record_name);
+		if (!TestTrue(TEXT("Recording starts"), writer.is_open())) {
+			return false;
+		}
+
+		run(&writer, on);
+		TestEqual(TEXT("Dropped datagrams"), writer.dropped(), 0);
+	}
+
+	replay.stop();
+
+	AddInfo(FString::Printf(TEXT("Receive loop without recording: p50 %.1f us, p99 %.1f us, max %.1f us"), off.percentile(0.5), off.percentile(0.99), off.max()));
+	AddInfo(FString::Printf(TEXT("Receive loop with recording:    p50 %.1f us, p99 %.1f us, max %.1f us"), on.percentile(0.5), on.percentile(0.99), on.max()));
+
+	TestTrue(FString::Printf(TEXT("Recording adds at most %.0f us at p99"), MaxAddedMicroseconds),
+			on.percentile(0.99) <= off.percentile(0.99) + MaxAddedMicroseconds);
+
+	IFileManager::Get().Delete(*replay_name);
+	IFileManager::Get().Delete(*record_name);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
+
+#undef LOCTEXT_NAMESPACE
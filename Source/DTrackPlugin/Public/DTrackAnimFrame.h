@@ -0,0 +1,104 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+#include <atomic>
+
+/**
+ * Skeletal data of one tracking frame, laid out for animation nodes. Structure of arrays, 
+ * built by the polling thread and never changed once published.
+ */
+struct FDTrackAnimFrame {
+	uint32           m_frame_counter = 0;      //!< DTrack's frame counter
+	double           m_arrival = 0.0;          //!< FPlatformTime::Seconds()
+
+	/// Joints of human id h are [m_human_first_joint[h], m_human_first_joint[h + 1]). 
+	/// One more entry than humans
+	TArray<int32>    m_human_first_joint;
+	TArray<int32>    m_joint_ids;              //!< DTrack's joint id
+	TArray<FVector>  m_joint_locations;        //!< room, Unreal space
+	TArray<FQuat>    m_joint_rotations;
+
+	/// Hands by id, in a fixed layout. Each has FingersPerHand * JointsPerFinger transforms in 
+	/// m_finger_joints, thumb to pinky, each knuckle, middle, distal joint and tip. 
+	/// Relative to the hand, see FDTrackFingerJoints
+	static const int32 FingersPerHand = 5;
+	static const int32 JointsPerFinger = 4;
+	TArray<FTransform> m_hand_transforms;      //!< room, Unreal space
+	TArray<uint8>      m_hand_fingers;         //!< fingers each hand has, 0 if it's not valid
+	TArray<FTransform> m_finger_joints;
+
+	/// number of human models in this frame, ids are 0 to that
+	int32 num_humans() const {
+		return FMath::Max(m_human_first_joint.Num() - 1, 0);
+	}
+
+	/// number of hands in this frame
+	int32 num_hands() const {
+		return m_hand_transforms.Num();
+	}
+};
+
+/** @brief hands the newest FDTrackAnimFrame of a stream from the polling thread to animation threads
+ *
+ *	There's one per stream, found by its endpoint as DTrack.Stream prints it, plus one for 
+ *	whichever stream started first, found by an empty endpoint. Channels live until the 
+ *	plugin is unloaded, so readers can keep them. A stream only builds frames for channels
+ *	someone read from during the last second.
+ */
+class DTRACKPLUGIN_API FDTrackAnimChannel {
+
+	public:
+		/// the channel of that endpoint, made if there's none yet. Any thread
+		static TSharedRef<FDTrackAnimChannel, ESPMode::ThreadSafe> get(const FString &n_endpoint);
+
+		/// drop all channels, on shutdown
+		static void reset_all();
+
+		/// the newest frame, null if there's none yet. Any thread, it's a pointer copy under a lock
+		TSharedPtr<const FDTrackAnimFrame, ESPMode::ThreadSafe> latest() const;
+
+		/// true if anyone read lately, so the stream has to build frames
+		bool wanted() const;
+
+		/// make n_frame the newest. On the default channel only if the stream n_endpoint owns it,
+		/// which the first to publish does until it calls release()
+		void publish(const FString &n_endpoint, const TSharedRef<const FDTrackAnimFrame, ESPMode::ThreadSafe> &n_frame);
+
+		/// a stream that published here stops
+		void release(const FString &n_endpoint);
+
+	private:
+		mutable FCriticalSection  m_mutex;
+		TSharedPtr<const FDTrackAnimFrame, ESPMode::ThreadSafe> m_latest;
+		FString                   m_owner;             //!< the stream feeding the default channel
+		bool                      m_default = false;
+		mutable std::atomic<double> m_last_read{ -1.0 };
+};
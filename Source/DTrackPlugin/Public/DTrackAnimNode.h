@@ -0,0 +1,192 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimNodeBase.h"
+#include "BoneContainer.h"
+#include "BonePose.h"
+#include "DTrackAnimFrame.h"
+#include "DTrackInterface.h"
+#include "DTrackAnimNode.generated.h"
+
+/**
+ * Which bone a DTrack human model joint drives
+ */
+USTRUCT(BlueprintType)
+struct DTRACKPLUGIN_API FDTrackJointBinding {
+
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "Joint ID", ToolTip = "DTrack's id of the joint"))
+	int32          m_joint_id = 0;
+
+	UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "Bone"))
+	FBoneReference m_bone;
+
+	UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "Rotation Offset", ToolTip = "Turns the joint's orientation into the bone's, where they differ at rest"))
+	FRotator       m_rotation_offset = FRotator::ZeroRotator;
+
+	UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "Apply Location", ToolTip = "Move the bone to the joint's location as well. Usually just for the pelvis"))
+	bool           m_apply_location = false;
+};
+
+/**
+ * Which bones a finger of a DTrack hand drives
+ */
+USTRUCT(BlueprintType)
+struct DTRACKPLUGIN_API FDTrackFingerBinding {
+
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "Finger"))
+	EDTrackFingerType m_finger = EDTrackFingerType::FT_Index;
+
+	UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "Inner Bone", ToolTip = "The bone of the inner phalanx, turning at the knuckle"))
+	FBoneReference m_inner;
+
+	UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "Middle Bone"))
+	FBoneReference m_middle;
+
+	UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "Outer Bone", ToolTip = "The bone of the outer phalanx, the one with the tip"))
+	FBoneReference m_outer;
+
+	UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "Rotation Offset", ToolTip = "Turns the phalanges' orientation into the bones', where they differ at rest"))
+	FRotator       m_rotation_offset = FRotator::ZeroRotator;
+};
+
+/**
+ * Poses bones of a skeletal mesh from a DTrack human model. Reads the newest frame 
+ * on the animation thread, the game thread isn't involved.
+ */
+USTRUCT(BlueprintInternalUseOnly)
+struct DTRACKPLUGIN_API FAnimNode_DTrackHuman : public FAnimNode_Base {
+
+	GENERATED_BODY()
+
+	public:
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Links, meta = (DisplayName = "Source"))
+		FPoseLink      m_source;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = DTrack, meta = (DisplayName = "Human ID", PinShownByDefault))
+		int32          m_human_id = 0;
+
+		UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "DTrack Stream", ToolTip = "The endpoint as DTrack.Stream prints it, such as 127.0.0.1:50105. Empty for the stream started first"))
+		FString        m_endpoint;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = DTrack, meta = (DisplayName = "Tracking To Component", PinHiddenByDefault, ToolTip = "Where the tracking room is in the mesh's component space"))
+		FTransform     m_tracking_to_component;
+
+		UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "Joints"))
+		TArray<FDTrackJointBinding> m_joints;
+
+		// FAnimNode_Base interface
+		void Initialize_AnyThread(const FAnimationInitializeContext &Context) override;
+		void CacheBones_AnyThread(const FAnimationCacheBonesContext &Context) override;
+		void Update_AnyThread(const FAnimationUpdateContext &Context) override;
+		void Evaluate_AnyThread(FPoseContext &Output) override;
+		void GatherDebugData(FNodeDebugData &DebugData) override;
+
+	private:
+		/// a binding resolved against the required bones
+		struct Resolved {
+			FCompactPoseBoneIndex  m_bone = FCompactPoseBoneIndex(INDEX_NONE);
+			int32                  m_joint = INDEX_NONE;    //!< DTrack joint id, several bones may share one
+			FQuat                  m_offset = FQuat::Identity;
+			bool                   m_apply_location = false;
+		};
+
+		/// Resolved when bones are cached, sorted by bone index so parents come first. 
+		/// Nothing's allocated per frame after that
+		TArray<Resolved>       m_resolved;
+		TArray<int32>          m_slot_by_joint;       //!< by bound DTrack joint id, the joint's index in the frame or INDEX_NONE
+		TArray<FBoneTransform> m_bone_transforms;
+
+		TSharedPtr<FDTrackAnimChannel, ESPMode::ThreadSafe>     m_channel;
+		TSharedPtr<const FDTrackAnimFrame, ESPMode::ThreadSafe> m_frame;   //!< picked up in update, used in evaluate
+};
+
+/**
+ * Poses the wrist and finger bones of a hand mesh from a DTrack hand. Finger joints
+ * are worked out on the polling thread already, this only reads them on the animation thread.
+ */
+USTRUCT(BlueprintInternalUseOnly)
+struct DTRACKPLUGIN_API FAnimNode_DTrackHand : public FAnimNode_Base {
+
+	GENERATED_BODY()
+
+	public:
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Links, meta = (DisplayName = "Source"))
+		FPoseLink      m_source;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = DTrack, meta = (DisplayName = "Hand ID", PinShownByDefault))
+		int32          m_hand_id = 0;
+
+		UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "DTrack Stream", ToolTip = "The endpoint as DTrack.Stream prints it, such as 127.0.0.1:50105. Empty for the stream started first"))
+		FString        m_endpoint;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = DTrack, meta = (DisplayName = "Tracking To Component", PinHiddenByDefault, ToolTip = "Where the tracking room is in the mesh's component space"))
+		FTransform     m_tracking_to_component;
+
+		UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "Wrist Bone", ToolTip = "Follows the hand. Leave empty to only turn the fingers"))
+		FBoneReference m_wrist;
+
+		UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "Wrist Rotation Offset"))
+		FRotator       m_wrist_rotation_offset = FRotator::ZeroRotator;
+
+		UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "Apply Wrist Location", ToolTip = "Move the wrist bone to where the hand is, not only turn it"))
+		bool           m_apply_wrist_location = true;
+
+		UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "Fingers"))
+		TArray<FDTrackFingerBinding> m_fingers;
+
+		UPROPERTY(EditAnywhere, Category = DTrack, meta = (DisplayName = "Apply Finger Locations", ToolTip = "Move finger bones to the tracked joints. Off keeps the mesh's proportions and only turns them"))
+		bool           m_apply_finger_locations = false;
+
+		// FAnimNode_Base interface
+		void Initialize_AnyThread(const FAnimationInitializeContext &Context) override;
+		void CacheBones_AnyThread(const FAnimationCacheBonesContext &Context) override;
+		void Update_AnyThread(const FAnimationUpdateContext &Context) override;
+		void Evaluate_AnyThread(FPoseContext &Output) override;
+		void GatherDebugData(FNodeDebugData &DebugData) override;
+
+	private:
+		/// a bone resolved against the required bones
+		struct Resolved {
+			FCompactPoseBoneIndex  m_bone = FCompactPoseBoneIndex(INDEX_NONE);
+			int32                  m_joint = INDEX_NONE;   //!< in the hand's fixed layout, INDEX_NONE for the wrist
+			FQuat                  m_offset = FQuat::Identity;
+			bool                   m_apply_location = false;
+		};
+
+		/// sorted by bone index so parents come first, nothing's allocated per frame after caching
+		TArray<Resolved>       m_resolved;
+		TArray<FBoneTransform> m_bone_transforms;
+
+		TSharedPtr<FDTrackAnimChannel, ESPMode::ThreadSafe>     m_channel;
+		TSharedPtr<const FDTrackAnimFrame, ESPMode::ThreadSafe> m_frame;
+};
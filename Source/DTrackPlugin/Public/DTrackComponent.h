@@ -28,6 +28,7 @@
 
 #include "CoreMinimal.h"
 #include "DTrackInterface.h"
+#include "IDTrackPlugin.h"
 #include "Components/ActorComponent.h"
 #include "DTrackComponent.generated.h"
 
@@ -38,7 +39,7 @@ class DTRACKPLUGIN_API UDTrackComponent : public UActorComponent {
 
 	public:
 
-		UPROPERTY(EditAnywhere, meta = (DisplayName = "DTrack Server IP", ToolTip = "Enter the IP of your DTrack server host. Hostnames will not work."))
+		UPROPERTY(EditAnywhere, meta = (DisplayName = "DTrack Server IP", ToolTip = "Enter the IP of your DTrack server host. Hostnames will not work. Components with the same IP and port share one connection"))
 		FString m_dtrack_server_ip = "127.0.0.1";
 
 		UPROPERTY(EditAnywhere, meta = (DisplayName = "DTrack Server Port", ToolTip = "Enter the port your server uses"))
@@ -47,9 +48,105 @@ class DTRACKPLUGIN_API UDTrackComponent : public UActorComponent {
 		UPROPERTY(EditAnywhere, meta = (DisplayName = "DTrack2 Protocol", ToolTip = "Use the TCP command channel based DTrack2 protocol"))
 		bool    m_dtrack_2 = true;
 
-		UPROPERTY(EditAnywhere, meta = (DisplayName = "DTrack Room Calibration", ToolTip = "Set this according to your DTrack system's room calibration"))
+		UPROPERTY(EditAnywhere, meta = (DisplayName = "DTrack Multicast Group", ToolTip = "Receive tracking data sent to this multicast group on the server port instead of connecting to the server. Leave empty for unicast"))
+		FString m_multicast_group;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Multicast Interface", ToolTip = "IP of the local network interface to receive multicast on. Leave empty to let the system choose"))
+		FString m_multicast_interface;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Cluster Role", ToolTip = "A primary rebroadcasts converted frames to the cluster address, secondaries receive those instead of talking to DTrack"))
+		EDTrackClusterRole m_cluster_role = EDTrackClusterRole::CR_None;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Cluster Address", ToolTip = "Where the primary sends to. A multicast group, a broadcast address or, for one secondary only, its IP. Secondaries join it if it is a multicast group"))
+		FString m_cluster_address = "239.0.0.110";
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Cluster Port", ToolTip = "Port the primary sends to and secondaries receive on"))
+		uint32  m_cluster_port = 50110;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Cluster Frame Lock", ToolTip = "All nodes show the DTrack frame the primary picked for each engine frame, one engine frame later. Turns off extrapolation. Set on the primary and all secondaries"))
+		bool    m_cluster_frame_lock = false;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Shared Memory", ToolTip = "Publish every frame into a shared memory region of this name for other processes on this machine. Leave empty to not publish"))
+		FString m_shared_memory_name;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Pose History", ClampMin = "0", ToolTip = "Number of frames each target's pose is kept for queries of where it was in the past. 0 keeps none"))
+		int32   m_pose_history_size = 256;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Playout Buffer", ToolTip = "Deliver poses interpolated between received frames a little in the past instead of the latest frame extrapolated. Smooths out bursty networks at the cost of that delay. Needs the pose history"))
+		bool    m_playout = false;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Playout Adaptive", ToolTip = "Choose the playout delay from the frame rate and jitter measured. Otherwise the fixed delay is used"))
+		bool    m_playout_adaptive = true;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Playout Delay (ms)", ClampMin = "0.0", ToolTip = "Fixed playout delay if not adaptive"))
+		float   m_playout_delay_ms = 20.0f;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Resample To Display", ToolTip = "Deliver poses for the time each engine frame is displayed, interpolated from the pose history or predicted a little past the newest frame. Makes motion uniform when tracking and render rates differ. Needs the pose history, the playout buffer takes precedence"))
+		bool    m_resample = false;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Display Latency (ms)", ClampMin = "0.0", ToolTip = "Time from the start of an engine frame until it is displayed. 0 assumes one frame"))
+		float   m_display_latency_ms = 0.0f;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Coasting (ms)", ClampMin = "0.0", ToolTip = "When DTrack loses sight of a body, flystick or hand, continue its last motion for this long before it counts as lost and stays where it is. 0 turns coasting off"))
+		float   m_coasting_ms = 0.0f;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Coasting Decay (ms)", ClampMin = "1.0", ToolTip = "How quickly coasting targets slow down. Their speed falls to about a third after this long"))
+		float   m_coasting_decay_ms = 50.0f;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Dispatch Lost Targets", ToolTip = "Keep calling OnBodyData, OnFlystickData, OnHandTracking and OnHumanModel for targets that are lost, with the pose they were last seen at. Uncheck to only get calls for measured and coasted ones"))
+		bool    m_dispatch_lost_targets = true;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Position Threshold (cm)", ClampMin = "0.0", ToolTip = "Only call OnBodyData, OnFlystickData and OnHandTracking when a target moved further than this since the last call. 0 for both thresholds calls every tick, 0 next to a rotation threshold counts any movement"))
+		float   m_position_threshold_cm = 0.0f;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Rotation Threshold (deg)", ClampMin = "0.0", ToolTip = "Only call OnBodyData, OnFlystickData and OnHandTracking when a target turned further than this since the last call. 0 for both thresholds calls every tick, 0 next to a position threshold counts any rotation"))
+		float   m_rotation_threshold_deg = 0.0f;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Max Update Rate (Hz)", ClampMin = "0.0", ToolTip = "Call this component at most this often, for displays and loggers that don't need every frame. 0 calls it every tick"))
+		float   m_max_update_rate_hz = 0.0f;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Update Every Nth Frame", ClampMin = "1", ToolTip = "Call this component only every this many engine frames. Components that skip frames are spread out over them"))
+		int32   m_update_every_nth_frame = 1;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Dispatch Priority", ToolTip = "When DTrack.DispatchBudget is spent, Normal and Bulk components are deferred to the next frame, Bulk ones first. Always ones never are"))
+		EDTrackDispatchPriority m_dispatch_priority = EDTrackDispatchPriority::DP_Normal;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Body Filter", ToolTip = "Smoothing of body poses, done on the polling thread at tracking rate. The first component on a stream decides for all"))
+		FDTrackFilterSettings m_body_filter;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Body Filter By ID", ToolTip = "Smoothing of particular bodies, overriding the body filter"))
+		TMap<int32, FDTrackFilterSettings> m_body_filter_by_id;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Flystick Filter", ToolTip = "Smoothing of flystick poses"))
+		FDTrackFilterSettings m_flystick_filter;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Flystick Filter By ID", ToolTip = "Smoothing of particular flysticks, overriding the flystick filter"))
+		TMap<int32, FDTrackFilterSettings> m_flystick_filter_by_id;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Hand Filter", ToolTip = "Smoothing of hand poses. Fingers are relative to the hand and not filtered"))
+		FDTrackFilterSettings m_hand_filter;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Hand Filter By ID", ToolTip = "Smoothing of particular hands, overriding the hand filter"))
+		TMap<int32, FDTrackFilterSettings> m_hand_filter_by_id;
+
+		UPROPERTY(EditAnywhere, meta = (DisplayName = "DTrack Room Calibration", ToolTip = "Set this according to your DTrack system's room calibration. The first component connecting to a server decides for all others on it"))
 		EDTrackCoordinateSystemType m_coordinate_system = EDTrackCoordinateSystemType::CST_Normal;
 
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Capture File", ToolTip = "Record all received datagrams into this file. Relative paths go into the project's Saved folder. Leave empty to not record"))
+		FString m_capture_file;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Replay File", ToolTip = "Play back this capture instead of receiving from the DTrack server. Relative paths are looked up in the project's Saved folder"))
+		FString m_replay_file;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Replay Speed", ClampMin = "0.0", ToolTip = "Playback speed relative to the recording. 1 is real time, 0 plays as fast as possible"))
+		float   m_replay_speed = 1.0f;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Replay Stepped", ToolTip = "Deliver replayed frames only on \"DTrack.Replay Step [n]\" console commands"))
+		bool    m_replay_stepped = false;
+
+		UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (DisplayName = "DTrack Replay Loop", ToolTip = "Start over when the end of the capture is reached"))
+		bool    m_replay_loop = false;
+
 		virtual void TickComponent(float n_delta_time, enum ELevelTick n_tick_type, FActorComponentTickFunction *n_this_tick_function) override;
 		virtual void BeginPlay() override;
 		virtual void EndPlay(const EEndPlayReason::Type n_reason) override;
@@ -80,6 +177,16 @@ class DTRACKPLUGIN_API UDTrackComponent : public UActorComponent {
 		 */
 		void human_model(const int32 n_human_id, const TArray<FDTrackJoint> &n_joints);
 
+		/**
+		 * A body, flystick or hand was lost, found again or is coasting. 
+		 */
+		void target_state_changed(const EDTrackTargetType n_type, const int32 n_id, const EDTrackTrackingState n_state);
+
+		/**
+		 * The tracking stream changed health. Stalled also counts as the device being disabled.
+		 */
+		void stream_state_changed(const EDTrackStreamState n_state);
+
 	private:
 
 		class IDTrackPlugin *m_plugin = nullptr;   //!< will cache that to avoid calling Module getter in every tick
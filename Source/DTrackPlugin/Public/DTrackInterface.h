@@ -50,6 +50,114 @@ enum class EDTrackCoordinateSystemType : uint8 {
 	CST_Unreal_Adapted    UMETA(DisplayName = "DTrack Unreal Adapted")
 };
 
+/**
+ * Health of the tracking data stream as judged by the frame counter
+ * and the time between datagrams
+ */
+UENUM(BlueprintType, Category=DTrack)
+enum class EDTrackStreamState : uint8 {
+
+	/// frames come in without loss
+	SS_Ok        UMETA(DisplayName = "OK"),
+
+	/// frames are lost, duplicated or out of order
+	SS_Degraded  UMETA(DisplayName = "Degraded"),
+
+	/// no frames came in for a while
+	SS_Stalled   UMETA(DisplayName = "Stalled")
+};
+
+/**
+ * What this machine does in a cluster of render nodes
+ */
+UENUM(BlueprintType, Category=DTrack)
+enum class EDTrackClusterRole : uint8 {
+
+	/// no cluster, receive from DTrack
+	CR_None       UMETA(DisplayName = "None"),
+
+	/// receive from DTrack and rebroadcast the converted frames
+	CR_Primary    UMETA(DisplayName = "Primary"),
+
+	/// receive converted frames from the primary instead of DTrack
+	CR_Secondary  UMETA(DisplayName = "Secondary")
+};
+
+/**
+ * Where a target's pose comes from. Zero is lost, so targets never seen are
+ */
+UENUM(BlueprintType, Category=DTrack)
+enum class EDTrackTrackingState : uint8 {
+
+	/// not seen for longer than coasting lasts, or never. The pose is where it was last
+	TS_Lost      UMETA(DisplayName = "Lost"),
+
+	/// DTrack sees it, the pose is measured
+	TS_Measured  UMETA(DisplayName = "Measured"),
+
+	/// DTrack lost sight of it a moment ago, the pose continues its last motion
+	TS_Coasted   UMETA(DisplayName = "Coasted")
+};
+
+/**
+ * How poses are smoothed before they are handed out
+ */
+UENUM(BlueprintType, Category=DTrack)
+enum class EDTrackSmoothing : uint8 {
+
+	/// poses as DTrack sends them
+	SM_None      UMETA(DisplayName = "None"),
+
+	/// One Euro filter. Smooths a lot when still and little in fast motion
+	SM_OneEuro   UMETA(DisplayName = "One Euro"),
+
+	/// Kalman filter assuming targets move at constant speed
+	SM_Kalman    UMETA(DisplayName = "Kalman")
+};
+
+/**
+ * Which components get dispatched first when the game thread's DTrack time budget runs out
+ */
+UENUM(BlueprintType, Category=DTrack)
+enum class EDTrackDispatchPriority : uint8 {
+
+	/// every tick, whatever the budget. Heads and props
+	DP_Always    UMETA(DisplayName = "Always"),
+
+	/// before bulk ones, deferred when the budget is spent
+	DP_Normal    UMETA(DisplayName = "Normal"),
+
+	/// last. Human models, loggers and the like
+	DP_Bulk      UMETA(DisplayName = "Bulk")
+};
+
+/**
+ * Smoothing of one kind of target or a single target
+ */
+USTRUCT(BlueprintType)
+struct FDTrackFilterSettings {
+
+	GENERATED_BODY()
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (DisplayName = "Filter"))
+		EDTrackSmoothing m_type = EDTrackSmoothing::SM_None;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (DisplayName = "Min Cutoff (Hz)", ClampMin = "0.01", ToolTip = "One Euro: cutoff frequency when still. Lower is smoother but lags more"))
+		float m_min_cutoff = 1.0f;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (DisplayName = "Beta", ClampMin = "0.0", ToolTip = "One Euro: how much the cutoff rises per cm/s or degree/s of speed. Higher lags less in fast motion"))
+		float m_beta = 0.05f;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (DisplayName = "Derivative Cutoff (Hz)", ClampMin = "0.01", ToolTip = "One Euro: cutoff frequency for the speed estimate"))
+		float m_derivative_cutoff = 1.0f;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (DisplayName = "Measurement Noise", ClampMin = "0.0001", ToolTip = "Kalman: how much tracking jitters, as standard deviation in cm and degrees"))
+		float m_measurement_noise = 0.05f;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (DisplayName = "Process Noise", ClampMin = "0.0001", ToolTip = "Kalman: how abruptly targets change speed, as standard deviation in cm/s² and degrees/s². Higher follows faster"))
+		float m_process_noise = 500.0f;
+};
+
 UENUM(BlueprintType)
 enum class EDTrackFingerType : uint8 {
 	FT_Thumb    UMETA(DisplayName = "Thumb"),
@@ -72,6 +180,24 @@ struct FDTrackBody {
 
 		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Rotation"))
 		FRotator m_rotation;
+
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "State"))
+		EDTrackTrackingState m_state = EDTrackTrackingState::TS_Lost;
+
+		/// DTrack's quality of the measurement, 0 to 1. 0 while coasted or lost
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Quality"))
+		float    m_quality = 0.0f;
+
+		/// the pose is current, that is measured or coasted. Skip targets that aren't
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Valid"))
+		bool     m_valid = false;
+
+		/// DTrack frame counter of the last measurement, 0 if never measured
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Measured Frame"))
+		int32    m_measured_frame = 0;
+
+		/// arrival of the last measurement in FPlatformTime::Seconds() like IDTrackPlugin::pose_at(), 0 if never measured
+		double   m_measured_time = 0.0;
 };
 
 /**
@@ -88,6 +214,24 @@ struct FDTrackFlystick {
 		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Rotation"))
 		FRotator m_rotation;
 
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "State"))
+		EDTrackTrackingState m_state = EDTrackTrackingState::TS_Lost;
+
+		/// DTrack's quality of the measurement, 0 to 1. 0 while coasted or lost
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Quality"))
+		float    m_quality = 0.0f;
+
+		/// the pose is current, that is measured or coasted. Skip targets that aren't
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Valid"))
+		bool     m_valid = false;
+
+		/// DTrack frame counter of the last measurement, 0 if never measured
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Measured Frame"))
+		int32    m_measured_frame = 0;
+
+		/// arrival of the last measurement in FPlatformTime::Seconds() like IDTrackPlugin::pose_at(), 0 if never measured
+		double   m_measured_time = 0.0;
+
 		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "ButtonState"))
 		TArray<int> m_button_states;
 
@@ -95,6 +239,28 @@ struct FDTrackFlystick {
 		TArray<float> m_joystick_states;
 };
 
+/**
+ * Where a finger's joints are and how its phalanges are turned, relative to the hand.
+ * Each rotation is that of the phalanx starting at the joint, the tip has the outer one's
+ */
+USTRUCT(BlueprintType)
+struct FDTrackFingerJoints {
+
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Knuckle"))
+	FTransform m_knuckle;
+
+	UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Middle"))
+	FTransform m_middle;
+
+	UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Distal"))
+	FTransform m_distal;
+
+	UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Tip"))
+	FTransform m_tip;
+};
+
 /**
  * This represents one finger (guess which one) as tracked info come in
  */
@@ -132,6 +298,10 @@ struct FDTrackFinger {
 
 	UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Middle Outer Phalanx Angle"))
 	float    m_middle_outer_phalanx_angle;
+
+	/// all of the above worked out into joints once, by the plugin
+	UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Joints"))
+	FDTrackFingerJoints m_joints;
 };
 
 
@@ -153,6 +323,24 @@ struct FDTrackHand {
 		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Rotation"))
 		FRotator m_rotation;
 
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "State"))
+		EDTrackTrackingState m_state = EDTrackTrackingState::TS_Lost;
+
+		/// DTrack's quality of the measurement, 0 to 1. 0 while coasted or lost
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Quality"))
+		float    m_quality = 0.0f;
+
+		/// the pose is current, that is measured or coasted. Skip targets that aren't
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Valid"))
+		bool     m_valid = false;
+
+		/// DTrack frame counter of the last measurement, 0 if never measured
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Measured Frame"))
+		int32    m_measured_frame = 0;
+
+		/// arrival of the last measurement in FPlatformTime::Seconds() like IDTrackPlugin::pose_at(), 0 if never measured
+		double   m_measured_time = 0.0;
+
 		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Fingers"))
 		TArray<FDTrackFinger> m_fingers;
 };
@@ -194,6 +382,25 @@ struct FDTrackHuman {
 
 		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Joints"))
 		TArray<FDTrackJoint> m_joints;
+
+		/// measured or lost, human models aren't coasted
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "State"))
+		EDTrackTrackingState m_state = EDTrackTrackingState::TS_Lost;
+
+		/// DTrack's quality averaged over the tracked joints, 0 to 1. 0 while lost
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Quality"))
+		float    m_quality = 0.0f;
+
+		/// the joints are current. A lost model keeps its last joints but isn't valid
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Valid"))
+		bool     m_valid = false;
+
+		/// DTrack frame counter of the last measurement, 0 if never measured
+		UPROPERTY(BlueprintReadOnly, meta = (DisplayName = "Measured Frame"))
+		int32    m_measured_frame = 0;
+
+		/// arrival of the last measurement in FPlatformTime::Seconds(), 0 if never measured
+		double   m_measured_time = 0.0;
 };
 
 
@@ -217,10 +424,32 @@ class DTRACKPLUGIN_API IDTrackInterface {
 	GENERATED_IINTERFACE_BODY()
 
 	public:
-		/// never called yet
+		/// called when tracking data stop coming in
 		UFUNCTION(BlueprintImplementableEvent, Category = DTrackEvents)
 		void DeviceDisabled();
 
+		/**
+		 * Called when the health of the tracking stream changes. Degraded means frames
+		 * are lost or arrive out of order, Stalled means nothing arrives at all.
+		 */
+		UFUNCTION(BlueprintImplementableEvent, Category = DTrackEvents)
+		void OnStreamStateChanged(const EDTrackStreamState State);
+
+		/**
+		 * Called when DTrack loses sight of a body, sees it again or coasting it runs out.
+		 * Poses keep coming through OnBodyData either way.
+		 */
+		UFUNCTION(BlueprintImplementableEvent, Category = DTrackEvents)
+		void OnBodyStateChanged(const int32 BodyID, const EDTrackTrackingState State);
+
+		/// the same for flysticks
+		UFUNCTION(BlueprintImplementableEvent, Category = DTrackEvents)
+		void OnFlystickStateChanged(const int32 FlystickID, const EDTrackTrackingState State);
+
+		/// and for hands
+		UFUNCTION(BlueprintImplementableEvent, Category = DTrackEvents)
+		void OnHandStateChanged(const int32 HandID, const EDTrackTrackingState State);
+
 		/**
 		 * This is called for each new set of body tracking data received unless 
 		 * frame rate is lower than tracking data frequency.
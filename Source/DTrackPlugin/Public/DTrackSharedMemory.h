@@ -0,0 +1,148 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+// This is included by the plug-in and by processes reading what it publishes,
+// so it's plain C++ without engine types.
+#include <atomic>
+#include <cstdint>
+
+/** 
+ * The plug-in can publish each converted frame into a named shared memory region
+ * so other processes on the same machine get the data without a socket of their own.
+ * The region is one FDTrackSharedRegion. Use the reader in Tools/DTrackSharedMemory
+ * or follow the protocol described there.
+ *
+ * All poses are in Unreal space like the plug-in hands them to components:
+ * location in cm, rotation as quaternion x, y, z, w. Arrays are indexed by target id
+ * just like the component calls. Fixed size arrays take as many targets as fit,
+ * the rest are left out.
+ */
+namespace DTrackSharedMemory {
+	static const uint32_t Magic = 0x4D535444;      // "DTSM"
+	static const uint32_t Version = 4;
+
+	static const uint32_t MaxBodies = 64;
+	static const uint32_t MaxFlysticks = 8;
+	static const uint32_t MaxButtons = 16;
+	static const uint32_t MaxJoysticks = 8;
+	static const uint32_t MaxHands = 8;
+	static const uint32_t MaxFingers = 5;
+	static const uint32_t MaxHumans = 4;
+	static const uint32_t MaxJoints = 256;                     // DTrack human models go up to about 200
+}
+
+struct FDTrackSharedPose {
+	float    m_location[3];
+	float    m_rotation[4];
+};
+
+/// how current a target's pose is
+struct FDTrackSharedStatus {
+	uint32_t m_state;                                          //!< EDTrackTrackingState, 0 lost, 1 measured, 2 coasted
+	uint32_t m_valid;                                          //!< 1 if measured or coasted
+	float    m_quality;                                        //!< DTrack's, 0 to 1, 0 unless measured
+	uint32_t m_measured_frame;                                 //!< frame counter of the last measurement
+	float    m_age;                                            //!< seconds from the last measurement to this frame, -1 if never measured
+};
+
+struct FDTrackSharedFlystick {
+	FDTrackSharedPose m_pose;
+	FDTrackSharedStatus m_status;
+	uint32_t m_num_buttons;
+	uint32_t m_buttons;                                        //!< bit n is button n
+	uint32_t m_num_joysticks;
+	float    m_joysticks[DTrackSharedMemory::MaxJoysticks];
+};
+
+struct FDTrackSharedFinger {
+	FDTrackSharedPose m_pose;
+	uint32_t m_type;                                           //!< EDTrackFingerType
+	float    m_tip_radius;
+	float    m_phalanx_lengths[3];                             //!< inner, middle, outer
+	float    m_phalanx_angles[2];                              //!< inner to middle, middle to outer
+};
+
+struct FDTrackSharedHand {
+	FDTrackSharedPose m_pose;
+	FDTrackSharedStatus m_status;
+	uint32_t m_right;
+	uint32_t m_num_fingers;
+	FDTrackSharedFinger m_fingers[DTrackSharedMemory::MaxFingers];
+};
+
+struct FDTrackSharedJoint {
+	FDTrackSharedPose m_pose;
+	int32_t  m_id;
+};
+
+struct FDTrackSharedHuman {
+	FDTrackSharedStatus m_status;
+	uint32_t m_num_joints;
+	FDTrackSharedJoint m_joints[DTrackSharedMemory::MaxJoints];
+};
+
+/// one converted frame
+struct FDTrackSharedFrame {
+	uint32_t m_frame_counter;
+	uint32_t m_num_bodies;
+	double   m_timestamp;                                      //!< DTrack's, -1 if it sends none
+	uint32_t m_num_flysticks;
+	uint32_t m_num_hands;
+	uint32_t m_num_humans;
+	uint32_t m_reserved;
+
+	FDTrackSharedPose     m_bodies[DTrackSharedMemory::MaxBodies];
+	FDTrackSharedStatus   m_body_status[DTrackSharedMemory::MaxBodies];
+	FDTrackSharedFlystick m_flysticks[DTrackSharedMemory::MaxFlysticks];
+	FDTrackSharedHand     m_hands[DTrackSharedMemory::MaxHands];
+	FDTrackSharedHuman    m_humans[DTrackSharedMemory::MaxHumans];
+};
+
+/** 
+ * Two slots written in turns, each with its own version. A frame with sequence n
+ * goes into slot n % 2. While that's written its version is 2n + 1, afterwards 2n.
+ * Then m_latest becomes n. So a reader looks at the slot m_latest points to, takes 
+ * the frame and checks if the version is still 2n. If not, the writer came around
+ * in the meantime, which takes two frames, and the reader tries again.
+ */
+struct FDTrackSharedSlot {
+	std::atomic<uint64_t> m_version;
+	uint64_t              m_reserved;
+	FDTrackSharedFrame    m_frame;
+};
+
+struct FDTrackSharedRegion {
+	uint32_t              m_magic;
+	uint32_t              m_layout_version;             //!< DTrackSharedMemory::Version
+	uint32_t              m_size;                           //!< sizeof(FDTrackSharedRegion) of the writer
+	uint32_t              m_reserved;
+	std::atomic<uint64_t> m_latest;                         //!< sequence of the newest complete frame, 0 if none yet
+	FDTrackSharedSlot     m_slots[2];
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Shared memory publication needs lock free 64 bit atomics");
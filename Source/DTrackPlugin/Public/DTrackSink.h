@@ -0,0 +1,63 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DTrackInterface.h"
+
+/**
+ * One tick's tracking data of a stream, as the components get it. Poses are 
+ * extrapolated, played out or resampled the same way. Built once per tick and 
+ * shared by all sinks, it never changes after that.
+ */
+struct FDTrackFrameSnapshot {
+	uint32                   m_frame_counter = 0;      //!< DTrack's frame counter
+	double                   m_timestamp = -1.0;       //!< DTrack's timestamp, negative if it sends none
+	double                   m_sample_time = 0.0;      //!< what the poses are for, FPlatformTime::Seconds()
+	TArray<FDTrackBody>      m_bodies;
+	TArray<FDTrackFlystick>  m_flysticks;
+	TArray<FDTrackHand>      m_hands;
+	TArray<FDTrackHuman>     m_humans;
+};
+
+/**
+ * Native consumer of tracking data, for C++ code that doesn't need a component.
+ * Add it with IDTrackPlugin::add_sink(). 
+ */
+class IDTrackSink {
+
+	public:
+		virtual ~IDTrackSink() {}
+
+		/**
+		 * Called once per tick with the current frame. If the sink was added as thread safe, 
+		 * that's on a task graph worker, concurrently with other sinks and the components. 
+		 * It's done before the tick group of the ticking DTrack component ends. 
+		 * Otherwise it's on the game thread.
+		 */
+		virtual void frame(const FDTrackFrameSnapshot &n_frame) = 0;
+};
@@ -28,9 +28,67 @@
 
 #include "CoreMinimal.h"
 #include "ModuleManager.h"
+#include "DTrackInterface.h"
+#include "DTrackSink.h"
+#include "Async/TaskGraphInterfaces.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(DTrackPluginLog, Log, All);
 
+/// stages of the tracking pipeline the latency probe measures
+enum class EDTrackLatencyStage : uint8 {
+	Parse,       //!< datagram arrival until parsed
+	Convert,     //!< conversion to Unreal space and injection
+	Publish,     //!< swap to front buffer
+	Pickup,      //!< waiting for the game thread to tick
+	Dispatch,    //!< calling all components
+	Total,       //!< datagram arrival until dispatched
+	Count
+};
+
+/// kinds of targets. Human models have no pose of their own, only their status
+enum class EDTrackTargetType : uint8 {
+	Body,
+	Flystick,
+	Hand,
+	HumanModel,
+	Count
+};
+
+/// latency of one stage as measured by the probe, in microseconds
+struct FDTrackLatencyStats {
+	uint64 m_count = 0;   //!< frames measured
+	double m_p50 = 0.0;
+	double m_p99 = 0.0;
+	double m_max = 0.0;
+};
+
+/// frame continuity of the tracking stream since tracking started
+struct FDTrackStreamStats {
+	EDTrackStreamState m_state = EDTrackStreamState::SS_Ok;
+	uint64 m_frames = 0;                    //!< frames received
+	uint64 m_missing = 0;                   //!< frame counter values never seen
+	uint64 m_duplicates = 0;                //!< same frame counter twice
+	uint64 m_out_of_order = 0;              //!< frames arriving after a later one
+	uint64 m_restarts = 0;                  //!< frame counter jumped back, controller restarted
+	double m_controller_rate = 0.0;         //!< Hz, as the frame counter advances
+	double m_receive_rate = 0.0;            //!< Hz, as frames come in
+	double m_jitter_p50 = 0.0;              //!< deviation of arrival times from the rate, microseconds
+	double m_jitter_p99 = 0.0;
+	double m_jitter_max = 0.0;
+	double m_seconds_since_last_frame = -1.0;  //!< negative if no frame came in yet
+	double m_playout_delay = 0.0;           //!< ms the playout buffer currently delays by, 0 if off
+	uint64 m_playout_underruns = 0;         //!< ticks the playout buffer had no frame after the time it played
+};
+
+/// how current a target's pose is in the frame a component gets this tick
+struct FDTrackTargetStatus {
+	EDTrackTrackingState m_state = EDTrackTrackingState::TS_Lost;
+	bool   m_valid = false;                 //!< measured or coasted
+	float  m_quality = 0.0f;                //!< DTrack's, 0 unless measured
+	int32  m_measured_frame = 0;            //!< DTrack frame counter of the last measurement, 0 if never
+	double m_measured_time = 0.0;           //!< FPlatformTime::Seconds() of the last measurement, 0 if never
+};
+
 /**
  * The public interface to this module
  */
@@ -75,5 +133,69 @@ class DTRACKPLUGIN_API IDTrackPlugin : public IModuleInterface {
 
 		/// client components call this to HUP the plug-in and cause it to tick,
 		/// which it doesn't seem to be able to do on its own.
-		virtual void tick(const float n_delta_time, const UDTrackComponent *n_component) = 0;
+		/// Thread safe sinks run until n_completion, the caller's tick, completes. Without, tick() waits for them
+		virtual void tick(const float n_delta_time, const UDTrackComponent *n_component, const FGraphEventRef &n_completion = FGraphEventRef()) = 0;
+
+		/**
+		 * Switch the latency probe on or off. While on, each dispatched frame's path 
+		 * from datagram arrival to dispatch is measured. Also available as 
+		 * console command "DTrack.Latency On|Off|Reset|Print".
+		 */
+		virtual void set_latency_probe(const bool n_enabled) = 0;
+
+		/// reset all latency measurements
+		virtual void reset_latency() = 0;
+
+		/// latency measured for a pipeline stage since the probe was switched on or reset
+		virtual FDTrackLatencyStats latency(const EDTrackLatencyStage n_stage) const = 0;
+
+		/**
+		 * Frame loss, jitter and rate of the tracking stream started first, the
+		 * only one unless components use several endpoints. Also available 
+		 * as console command "DTrack.Stream".
+		 */
+		virtual FDTrackStreamStats stream_stats() const = 0;
+
+		/**
+		 * Frame loss, jitter and rate of the tracking stream the component is 
+		 * subscribed to.
+		 */
+		virtual FDTrackStreamStats stream_stats(const class UDTrackComponent *n_client) const = 0;
+
+		/**
+		 * Where a target of the component's stream was at n_time, given as FPlatformTime::Seconds()
+		 * of when the tracking data came in, with network jitter taken out if DTrack sends
+		 * timestamps. Interpolated between the frames around n_time.
+		 * False if that's longer ago than the component's "DTrack Pose History" covers or 
+		 * the target wasn't tracked then.
+		 */
+		virtual bool pose_at(const class UDTrackComponent *n_client, const EDTrackTargetType n_type, const int32 n_id, 
+				const double n_time, FVector &n_location, FRotator &n_rotation) const = 0;
+
+		/**
+		 * The time the poses handed to the component in this engine frame are for, in 
+		 * FPlatformTime::Seconds(). That's the expected display time when resampling, 
+		 * the playout time with the playout buffer and the newest frame's arrival otherwise.
+		 * 0 before the first frame.
+		 */
+		virtual double sample_time(const class UDTrackComponent *n_client) const = 0;
+
+		/**
+		 * Whether a target's pose handed to the component this engine frame is current, 
+		 * and since when. Compare m_measured_frame with the one you saw last to skip 
+		 * targets that haven't been measured since. False if the target isn't known at all.
+		 */
+		virtual bool target_status(const class UDTrackComponent *n_client, const EDTrackTargetType n_type, const int32 n_id,
+				FDTrackTargetStatus &n_status) const = 0;
+
+		/**
+		 * Hand every tick's frame of the component's stream to a native sink, until it's removed
+		 * or the stream stops. Thread safe sinks are all called in parallel on the task graph,
+		 * the others on the game thread one after the other. Game thread only.
+		 */
+		virtual void add_sink(const class UDTrackComponent *n_client, const TSharedRef<IDTrackSink, ESPMode::ThreadSafe> &n_sink, 
+				const bool n_thread_safe) = 0;
+
+		/// stop calling a sink. A thread safe one may still be running for the current tick
+		virtual void remove_sink(const TSharedRef<IDTrackSink, ESPMode::ThreadSafe> &n_sink) = 0;
 };
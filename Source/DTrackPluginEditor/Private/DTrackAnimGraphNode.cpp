@@ -0,0 +1,61 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "DTrackAnimGraphNode.h"
+
+#define LOCTEXT_NAMESPACE "DTrackPlugin"
+
+FText UAnimGraphNode_DTrackHuman::GetNodeTitle(ENodeTitleType::Type TitleType) const {
+
+	return LOCTEXT("DTrackHumanTitle", "DTrack Human Model");
+}
+
+FText UAnimGraphNode_DTrackHuman::GetTooltipText() const {
+
+	return LOCTEXT("DTrackHumanTooltip", "Poses bones from the joints of a DTrack human model, on the animation thread");
+}
+
+FString UAnimGraphNode_DTrackHuman::GetNodeCategory() const {
+
+	return TEXT("DTrack");
+}
+
+FText UAnimGraphNode_DTrackHand::GetNodeTitle(ENodeTitleType::Type TitleType) const {
+
+	return LOCTEXT("DTrackHandTitle", "DTrack Hand");
+}
+
+FText UAnimGraphNode_DTrackHand::GetTooltipText() const {
+
+	return LOCTEXT("DTrackHandTooltip", "Poses the wrist and finger bones from a DTrack hand, on the animation thread");
+}
+
+FString UAnimGraphNode_DTrackHand::GetNodeCategory() const {
+
+	return TEXT("DTrack");
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,72 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AnimGraphNode_Base.h"
+#include "DTrackAnimNode.h"
+#include "DTrackAnimGraphNode.generated.h"
+
+/**
+ * AnimGraph node posing bones from a DTrack human model
+ */
+UCLASS()
+class UAnimGraphNode_DTrackHuman : public UAnimGraphNode_Base {
+
+	GENERATED_BODY()
+
+	public:
+		UPROPERTY(EditAnywhere, Category = Settings)
+		FAnimNode_DTrackHuman m_node;
+
+		// UEdGraphNode interface
+		FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+		FText GetTooltipText() const override;
+
+		// UAnimGraphNode_Base interface
+		FString GetNodeCategory() const override;
+};
+
+/**
+ * AnimGraph node posing wrist and finger bones from a DTrack hand
+ */
+UCLASS()
+class UAnimGraphNode_DTrackHand : public UAnimGraphNode_Base {
+
+	GENERATED_BODY()
+
+	public:
+		UPROPERTY(EditAnywhere, Category = Settings)
+		FAnimNode_DTrackHand m_node;
+
+		// UEdGraphNode interface
+		FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+		FText GetTooltipText() const override;
+
+		// UAnimGraphNode_Base interface
+		FString GetNodeCategory() const override;
+};
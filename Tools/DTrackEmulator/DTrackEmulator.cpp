@@ -0,0 +1,981 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// DTrack controller emulator
+//
+// Stands in for an ARTtrack controller on the local machine. It answers the DTrack2 
+// TCP command channel as far as the SDK needs it for starting and stopping measurement
+// and setting parameters and streams synthetic frames in the DTrack ASCII format via UDP.
+//
+// Build on Linux with:
+//   g++ -std=c++14 -O2 -pthread DTrackEmulator.cpp -o dtrack_emulator
+//
+// Run with --help for options.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+/// largest payload a UDP datagram can carry
+const size_t max_datagram = 65507;
+
+/// the SDK receives into a buffer of this size by default. The plugin uses one for any datagram
+const size_t sdk_buffer = 32768;
+
+std::atomic<bool> s_quit(false);
+
+void on_signal(int) {
+
+	s_quit = true;
+}
+
+/************************************************************************/
+/* Options                                                              */
+/************************************************************************/
+enum class Motion {
+	Static,
+	Circle,
+	Lissajous,
+	Walk,
+	Script
+};
+
+struct Options {
+	unsigned short m_command_port = 50105;
+	std::string    m_data_host;              //!< empty means the command channel's peer
+	unsigned short m_data_port = 50105;
+	bool           m_dtrack1 = false;        //!< no command channel, stream right away
+	double         m_rate = 60.0;
+	int            m_bodies = 4;
+	int            m_flysticks = 1;
+	int            m_hands = 0;
+	int            m_humans = 0;
+	int            m_joints = 200;
+	Motion         m_motion = Motion::Circle;
+	double         m_radius = 1000.0;        //!< mm
+	double         m_period = 4.0;           //!< seconds per motion cycle
+	std::string    m_script;
+	double         m_drop = 0.0;             //!< probability to drop a frame
+	double         m_jitter = 0.0;           //!< max send jitter in ms
+	unsigned long  m_frames = 0;             //!< stop after that many, 0 is forever
+	unsigned int   m_seed = 1;
+	std::string    m_truth;                  //!< ground truth CSV
+};
+
+void usage() {
+
+	std::printf(
+		"dtrack_emulator - stand-in for an ARTtrack controller\n"
+		"\n"
+		"  --command-port <port>  DTrack2 TCP command port (50105)\n"
+		"  --data-host <ip>       where to stream to (peer of the command channel, 127.0.0.1 with --dtrack1)\n"
+		"  --data-port <port>     UDP port to stream to (50105)\n"
+		"  --dtrack1              no command channel, start streaming right away\n"
+		"  --rate <hz>            frames per second, up to 1000 (60)\n"
+		"  --bodies <n>           standard bodies (4)\n"
+		"  --flysticks <n>        flysticks (1)\n"
+		"  --hands <n>            fingertracking hands (0)\n"
+		"  --humans <n>           human models (0)\n"
+		"  --joints <n>           joints per human model, up to 200 (200)\n"
+		"  --motion <m>           static, circle, lissajous, walk or script (circle)\n"
+		"  --radius <mm>          motion amplitude (1000)\n"
+		"  --period <s>           motion cycle duration (4)\n"
+		"  --script <file>        keyframes for --motion script, one per line: t x y z rx ry rz (s, mm, deg)\n"
+		"  --drop <p>             probability of dropping a frame, to simulate packet loss (0)\n"
+		"  --jitter <ms>          random delay added when sending (0)\n"
+		"  --frames <n>           stop after n frames (0, never)\n"
+		"  --seed <n>             seed for walk, drops and jitter (1)\n"
+		"  --truth <file>         write ground truth poses of all bodies as CSV\n");
+}
+
+bool parse_options(int argc, char **argv, Options &n_options) {
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		const char *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+		auto need_value = [&]() -> bool {
+			if (!value) {
+				std::fprintf(stderr, "%s needs a value\n", arg.c_str());
+				return false;
+			}
+			i++;
+			return true;
+		};
+
+		if (arg == "--help" || arg == "-h") {
+			usage();
+			std::exit(0);
+		} else if (arg == "--dtrack1") {
+			n_options.m_dtrack1 = true;
+		} else if (arg == "--command-port") {
+			if (!need_value()) return false;
+			n_options.m_command_port = static_cast<unsigned short>(std::atoi(value));
+		} else if (arg == "--data-host") {
+			if (!need_value()) return false;
+			n_options.m_data_host = value;
+		} else if (arg == "--data-port") {
+			if (!need_value()) return false;
+			n_options.m_data_port = static_cast<unsigned short>(std::atoi(value));
+		} else if (arg == "--rate") {
+			if (!need_value()) return false;
+			n_options.m_rate = std::atof(value);
+		} else if (arg == "--bodies") {
+			if (!need_value()) return false;
+			n_options.m_bodies = std::atoi(value);
+		} else if (arg == "--flysticks") {
+			if (!need_value()) return false;
+			n_options.m_flysticks = std::atoi(value);
+		} else if (arg == "--hands") {
+			if (!need_value()) return false;
+			n_options.m_hands = std::atoi(value);
+		} else if (arg == "--humans") {
+			if (!need_value()) return false;
+			n_options.m_humans = std::atoi(value);
+		} else if (arg == "--joints") {
+			if (!need_value()) return false;
+			n_options.m_joints = std::atoi(value);
+		} else if (arg == "--motion") {
+			if (!need_value()) return false;
+			const std::string m = value;
+			if (m == "static") {
+				n_options.m_motion = Motion::Static;
+			} else if (m == "circle") {
+				n_options.m_motion = Motion::Circle;
+			} else if (m == "lissajous") {
+				n_options.m_motion = Motion::Lissajous;
+			} else if (m == "walk") {
+				n_options.m_motion = Motion::Walk;
+			} else if (m == "script") {
+				n_options.m_motion = Motion::Script;
+			} else {
+				std::fprintf(stderr, "unknown motion '%s'\n", value);
+				return false;
+			}
+		} else if (arg == "--radius") {
+			if (!need_value()) return false;
+			n_options.m_radius = std::atof(value);
+		} else if (arg == "--period") {
+			if (!need_value()) return false;
+			n_options.m_period = std::atof(value);
+		} else if (arg == "--script") {
+			if (!need_value()) return false;
+			n_options.m_script = value;
+		} else if (arg == "--drop") {
+			if (!need_value()) return false;
+			n_options.m_drop = std::atof(value);
+		} else if (arg == "--jitter") {
+			if (!need_value()) return false;
+			n_options.m_jitter = std::atof(value);
+		} else if (arg == "--frames") {
+			if (!need_value()) return false;
+			n_options.m_frames = std::strtoul(value, nullptr, 10);
+		} else if (arg == "--seed") {
+			if (!need_value()) return false;
+			n_options.m_seed = static_cast<unsigned int>(std::strtoul(value, nullptr, 10));
+		} else if (arg == "--truth") {
+			if (!need_value()) return false;
+			n_options.m_truth = value;
+		} else {
+			std::fprintf(stderr, "unknown option '%s', try --help\n", arg.c_str());
+			return false;
+		}
+	}
+
+	if ((n_options.m_rate <= 0.0) || (n_options.m_rate > 1000.0)) {
+		std::fprintf(stderr, "rate must be between 0 and 1000 Hz\n");
+		return false;
+	}
+
+	if ((n_options.m_joints < 1) || (n_options.m_joints > 200)) {
+		std::fprintf(stderr, "joints must be between 1 and 200\n");
+		return false;
+	}
+
+	if ((n_options.m_bodies < 0) || (n_options.m_flysticks < 0) || (n_options.m_hands < 0) || (n_options.m_humans < 0)) {
+		std::fprintf(stderr, "target counts cannot be negative\n");
+		return false;
+	}
+
+	if ((n_options.m_motion == Motion::Script) && n_options.m_script.empty()) {
+		std::fprintf(stderr, "--motion script needs --script\n");
+		return false;
+	}
+
+	if (n_options.m_period <= 0.0) {
+		n_options.m_period = 1.0;
+	}
+
+	return true;
+}
+
+/************************************************************************/
+/* Motion                                                               */
+/************************************************************************/
+
+/// location in mm and a column-wise rotation matrix as DTrack sends it
+struct Pose {
+	double m_loc[3];
+	double m_rot[9];
+};
+
+/// DTrack rotation from angles in degrees, R = Rx(eta) * Ry(theta) * Rz(phi)
+void rotation_from_angles(const double n_eta, const double n_theta, const double n_phi, double (&n_rot)[9]) {
+
+	const double a = n_eta * pi / 180.0;
+	const double b = n_theta * pi / 180.0;
+	const double c = n_phi * pi / 180.0;
+	const double sa = std::sin(a), ca = std::cos(a);
+	const double sb = std::sin(b), cb = std::cos(b);
+	const double sc = std::sin(c), cc = std::cos(c);
+
+	// row-major first, then stored column-wise
+	const double r[3][3] = {
+		{ cb * cc,                 -cb * sc,                 sb },
+		{ ca * sc + sa * sb * cc,  ca * cc - sa * sb * sc,  -sa * cb },
+		{ sa * sc - ca * sb * cc,  sa * cc + ca * sb * sc,   ca * cb }
+	};
+
+	for (int col = 0; col < 3; col++) {
+		for (int row = 0; row < 3; row++) {
+			n_rot[col * 3 + row] = r[row][col];
+		}
+	}
+}
+
+/// inverse of the above
+void angles_from_rotation(const double (&n_rot)[9], double &n_eta, double &n_theta, double &n_phi) {
+
+	// r[row][col] = n_rot[col * 3 + row]
+	const double r02 = n_rot[6];
+	const double r12 = n_rot[7];
+	const double r22 = n_rot[8];
+	const double r01 = n_rot[3];
+	const double r00 = n_rot[0];
+
+	n_theta = std::asin(std::max(-1.0, std::min(1.0, r02))) * 180.0 / pi;
+	n_eta = std::atan2(-r12, r22) * 180.0 / pi;
+	n_phi = std::atan2(-r01, r00) * 180.0 / pi;
+}
+
+struct Keyframe {
+	double m_time;
+	double m_loc[3];
+	double m_angles[3];
+};
+
+/** @brief produces the pose of each target at any time
+ *
+ *	Every target moves along the same pattern, phase shifted and offset by its index 
+ *	so they don't sit on top of each other. Motion is a pure function of time and 
+ *	index (walk uses a seeded table), so it can be reproduced for accuracy checks.
+ */
+class MotionScript {
+
+	public:
+		MotionScript(const Options &n_options)
+				: m_options(n_options) {
+
+			std::mt19937 random(n_options.m_seed);
+			std::uniform_real_distribution<double> dist(-1.0, 1.0);
+			for (auto &w : m_walk) {
+				for (double &v : w) {
+					v = dist(random);
+				}
+			}
+		}
+
+		bool load_script(const std::string &n_file) {
+
+			std::ifstream in(n_file);
+			if (!in) {
+				std::fprintf(stderr, "cannot open script '%s'\n", n_file.c_str());
+				return false;
+			}
+
+			std::string line;
+			while (std::getline(in, line)) {
+				if (line.empty() || (line[0] == '#')) {
+					continue;
+				}
+
+				std::istringstream ls(line);
+				Keyframe k;
+				if (ls >> k.m_time >> k.m_loc[0] >> k.m_loc[1] >> k.m_loc[2] >> k.m_angles[0] >> k.m_angles[1] >> k.m_angles[2]) {
+					m_keys.push_back(k);
+				}
+			}
+
+			if (m_keys.size() < 2) {
+				std::fprintf(stderr, "script '%s' needs at least two keyframes\n", n_file.c_str());
+				return false;
+			}
+
+			return true;
+		}
+
+		/// pose of the target with this index at time t (seconds)
+		Pose pose(const int n_index, const double n_time) const {
+
+			Pose ret;
+			const double phase = 2.0 * pi * (n_time / m_options.m_period) + n_index * 0.7;
+			const double r = m_options.m_radius;
+			
+			// spread the targets out on a grid so they're distinguishable
+			const double base[3] = { (n_index % 8) * 300.0, (n_index / 8) * 300.0, 1500.0 };
+			double angles[3] = { 0.0, 0.0, 0.0 };
+
+			switch (m_options.m_motion) {
+				case Motion::Static:
+					ret.m_loc[0] = base[0];
+					ret.m_loc[1] = base[1];
+					ret.m_loc[2] = base[2];
+					angles[2] = n_index * 10.0;
+					break;
+
+				case Motion::Circle:
+					ret.m_loc[0] = base[0] + r * std::cos(phase);
+					ret.m_loc[1] = base[1] + r * std::sin(phase);
+					ret.m_loc[2] = base[2];
+					// facing along the path
+					angles[2] = std::fmod(phase * 180.0 / pi + 90.0, 360.0) - 180.0;
+					break;
+
+				case Motion::Lissajous:
+					ret.m_loc[0] = base[0] + r * std::sin(phase);
+					ret.m_loc[1] = base[1] + r * std::sin(2.0 * phase);
+					ret.m_loc[2] = base[2] + 0.3 * r * std::sin(3.0 * phase);
+					angles[0] = 30.0 * std::sin(phase);
+					angles[1] = 20.0 * std::sin(2.0 * phase);
+					angles[2] = 90.0 * std::sin(0.5 * phase);
+					break;
+
+				case Motion::Walk: {
+					// sum of a few sines with seeded frequencies and phases, smooth but irregular
+					const auto &w = m_walk[n_index % m_walk.size()];
+					for (int axis = 0; axis < 3; axis++) {
+						double v = 0.0;
+						for (int k = 0; k < 3; k++) {
+							const double f = 0.5 + std::fabs(w[axis * 6 + k * 2]) * 1.5;
+							v += std::sin(phase * f + w[axis * 6 + k * 2 + 1] * pi) / 3.0;
+						}
+						ret.m_loc[axis] = base[axis] + r * v * ((axis == 2) ? 0.2 : 1.0);
+						angles[axis] = 45.0 * v;
+					}
+					break;
+				}
+
+				case Motion::Script:
+					script_pose(n_time, ret.m_loc, angles);
+					ret.m_loc[0] += base[0];
+					ret.m_loc[1] += base[1];
+					break;
+			}
+
+			rotation_from_angles(angles[0], angles[1], angles[2], ret.m_rot);
+			return ret;
+		}
+
+	private:
+		void script_pose(const double n_time, double (&n_loc)[3], double (&n_angles)[3]) const {
+
+			// keyframes loop
+			const double duration = m_keys.back().m_time - m_keys.front().m_time;
+			double t = m_keys.front().m_time;
+			if (duration > 0.0) {
+				t += std::fmod(n_time, duration);
+			}
+
+			size_t next = 1;
+			while ((next < m_keys.size() - 1) && (m_keys[next].m_time < t)) {
+				next++;
+			}
+
+			const Keyframe &k1 = m_keys[next - 1];
+			const Keyframe &k2 = m_keys[next];
+			const double span = k2.m_time - k1.m_time;
+			const double f = (span > 0.0) ? std::max(0.0, std::min(1.0, (t - k1.m_time) / span)) : 0.0;
+
+			for (int i = 0; i < 3; i++) {
+				n_loc[i] = k1.m_loc[i] + f * (k2.m_loc[i] - k1.m_loc[i]);
+				n_angles[i] = k1.m_angles[i] + f * (k2.m_angles[i] - k1.m_angles[i]);
+			}
+		}
+
+		const Options            &m_options;
+		std::vector<Keyframe>     m_keys;
+		std::vector< std::array<double, 18> > m_walk = std::vector< std::array<double, 18> >(16);
+};
+
+/************************************************************************/
+/* Frame formatting                                                     */
+/************************************************************************/
+
+/** @brief writes one frame in the DTrack ASCII format
+ *
+ *	The buffer is reused between frames so streaming doesn't allocate.
+ */
+class FrameWriter {
+
+	public:
+		FrameWriter() {
+
+			m_buffer.reserve(max_datagram);
+		}
+
+		const std::string &frame(const Options &n_options, const MotionScript &n_motion, 
+				const unsigned int n_frame_counter, const double n_time, const double n_timestamp) {
+
+			m_buffer.clear();
+			
+			append("fr %u\r\n", n_frame_counter);
+			append("ts %.6f\r\n", n_timestamp);
+
+			int index = 0;
+
+			// standard bodies
+			if (n_options.m_bodies) {
+				append("6dcal %d\r\n", n_options.m_bodies);
+				append("6d %d", n_options.m_bodies);
+				for (int id = 0; id < n_options.m_bodies; id++) {
+					const Pose p = n_motion.pose(index++, n_time);
+					append(" [%d 1.000]", id);
+					location_angles(p);
+					rotation(p.m_rot);
+				}
+				append("\r\n");
+			}
+
+			// flysticks with a button walking through and the joystick circling
+			if (n_options.m_flysticks) {
+				append("6df2 %d %d", n_options.m_flysticks, n_options.m_flysticks);
+				for (int id = 0; id < n_options.m_flysticks; id++) {
+					const Pose p = n_motion.pose(index++, n_time);
+					const int buttons = 1 << ((n_frame_counter / 60) % 6);
+					append(" [%d 1.000 6 2]", id);
+					location(p.m_loc);
+					rotation(p.m_rot);
+					append("[%d %.3f %.3f]", buttons, std::cos(n_time), std::sin(n_time));
+				}
+				append("\r\n");
+			}
+
+			// hands, fingers slowly opening and closing
+			if (n_options.m_hands) {
+				append("glcal %d\r\n", n_options.m_hands);
+				append("gl %d", n_options.m_hands);
+				for (int id = 0; id < n_options.m_hands; id++) {
+					const Pose p = n_motion.pose(index++, n_time);
+					append(" [%d 1.000 %d 5]", id, id % 2);
+					location(p.m_loc);
+					rotation(p.m_rot);
+
+					const double bend = 30.0 + 30.0 * std::sin(n_time * 2.0);
+					for (int f = 0; f < 5; f++) {
+						const double finger_loc[3] = { 80.0, -40.0 + f * 20.0, -10.0 };
+						double finger_rot[9];
+						rotation_from_angles(0.0, bend, 0.0, finger_rot);
+						append(" ");
+						location(finger_loc);
+						rotation(finger_rot);
+						// radius tip, outer length, outer-middle angle, middle length, middle-inner angle, inner length
+						append("[8.000 22.000 %.3f 28.000 %.3f 45.000]", bend, bend);
+					}
+				}
+				append("\r\n");
+			}
+
+			// human models, joints in a chain above the root
+			if (n_options.m_humans) {
+				append("6dj %d %d", n_options.m_humans, n_options.m_humans);
+				for (int id = 0; id < n_options.m_humans; id++) {
+					const Pose root = n_motion.pose(index++, n_time);
+					append(" [%d %d]", id, n_options.m_joints);
+					for (int j = 0; j < n_options.m_joints; j++) {
+						Pose joint = root;
+						joint.m_loc[2] = root.m_loc[2] - 1000.0 + j * (1800.0 / n_options.m_joints);
+						double wave[9];
+						rotation_from_angles(0.0, 0.0, 10.0 * std::sin(n_time * 3.0 + j * 0.1), wave);
+						multiply(root.m_rot, wave, joint.m_rot);
+						append("[%d 1.000]", j);
+						location_angles(joint);
+						rotation(joint.m_rot);
+					}
+				}
+				append("\r\n");
+			}
+
+			return m_buffer;
+		}
+
+	private:
+		template <typename... Args>
+		void append(const char *n_format, Args... n_args) {
+
+			char line[512];
+			const int len = std::snprintf(line, sizeof(line), n_format, n_args...);
+			if (len > 0) {
+				m_buffer.append(line, std::min(static_cast<size_t>(len), sizeof(line) - 1));
+			}
+		}
+
+		void location(const double (&n_loc)[3]) {
+
+			append("[%.3f %.3f %.3f]", n_loc[0], n_loc[1], n_loc[2]);
+		}
+
+		void location_angles(const Pose &n_pose) {
+
+			double eta, theta, phi;
+			angles_from_rotation(n_pose.m_rot, eta, theta, phi);
+			append("[%.3f %.3f %.3f %.4f %.4f %.4f]", n_pose.m_loc[0], n_pose.m_loc[1], n_pose.m_loc[2], eta, theta, phi);
+		}
+
+		void rotation(const double (&n_rot)[9]) {
+
+			append("[%.6f %.6f %.6f %.6f %.6f %.6f %.6f %.6f %.6f]", 
+					n_rot[0], n_rot[1], n_rot[2], n_rot[3], n_rot[4], n_rot[5], n_rot[6], n_rot[7], n_rot[8]);
+		}
+
+		/// column-wise 3x3 product
+		static void multiply(const double (&n_a)[9], const double (&n_b)[9], double (&n_out)[9]) {
+
+			for (int col = 0; col < 3; col++) {
+				for (int row = 0; row < 3; row++) {
+					double v = 0.0;
+					for (int k = 0; k < 3; k++) {
+						v += n_a[k * 3 + row] * n_b[col * 3 + k];
+					}
+					n_out[col * 3 + row] = v;
+				}
+			}
+		}
+
+		std::string m_buffer;
+};
+
+/************************************************************************/
+/* Emulator                                                             */
+/************************************************************************/
+class Emulator {
+
+	public:
+		Emulator(const Options &n_options)
+				: m_options(n_options)
+				, m_motion(n_options) {
+
+		}
+
+		~Emulator() {
+
+			if (m_udp >= 0) {
+				::close(m_udp);
+			}
+			if (m_listen >= 0) {
+				::close(m_listen);
+			}
+		}
+
+		bool init() {
+
+			if ((m_options.m_motion == Motion::Script) && !m_motion.load_script(m_options.m_script)) {
+				return false;
+			}
+
+			m_udp = ::socket(AF_INET, SOCK_DGRAM, 0);
+			if (m_udp < 0) {
+				std::perror("udp socket");
+				return false;
+			}
+
+			// large human frames need a send buffer that takes them in one go
+			int sndbuf = 4 * 1024 * 1024;
+			::setsockopt(m_udp, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+			if (!m_options.m_truth.empty()) {
+				m_truth = std::fopen(m_options.m_truth.c_str(), "w");
+				if (!m_truth) {
+					std::perror("truth file");
+					return false;
+				}
+				std::fprintf(m_truth, "frame,time,id,x,y,z,r0,r1,r2,r3,r4,r5,r6,r7,r8\n");
+			}
+
+			if (m_options.m_dtrack1) {
+				set_destination(m_options.m_data_host.empty() ? "127.0.0.1" : m_options.m_data_host, m_options.m_data_port);
+				m_streaming = true;
+				return true;
+			}
+
+			m_listen = ::socket(AF_INET, SOCK_STREAM, 0);
+			if (m_listen < 0) {
+				std::perror("tcp socket");
+				return false;
+			}
+
+			int yes = 1;
+			::setsockopt(m_listen, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+			sockaddr_in addr;
+			std::memset(&addr, 0, sizeof(addr));
+			addr.sin_family = AF_INET;
+			addr.sin_addr.s_addr = htonl(INADDR_ANY);
+			addr.sin_port = htons(m_options.m_command_port);
+
+			if (::bind(m_listen, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+				std::perror("bind command port");
+				return false;
+			}
+
+			if (::listen(m_listen, 1) < 0) {
+				std::perror("listen");
+				return false;
+			}
+
+			return true;
+		}
+
+		int run() {
+
+			std::thread commands;
+			if (!m_options.m_dtrack1) {
+				commands = std::thread([this]() { command_loop(); });
+				std::printf("waiting for DTrack2 commands on port %u\n", m_options.m_command_port);
+			} 
+
+			stream_loop();
+
+			s_quit = true;
+			if (m_listen >= 0) {
+				::shutdown(m_listen, SHUT_RDWR);
+			}
+			if (commands.joinable()) {
+				commands.join();
+			}
+
+			if (m_truth) {
+				std::fclose(m_truth);
+			}
+
+			return 0;
+		}
+
+	private:
+		void set_destination(const std::string &n_host, const unsigned short n_port) {
+
+			std::lock_guard<std::mutex> lock(m_destination_mutex);
+			std::memset(&m_destination, 0, sizeof(m_destination));
+			m_destination.sin_family = AF_INET;
+			m_destination.sin_port = htons(n_port);
+			::inet_pton(AF_INET, n_host.c_str(), &m_destination.sin_addr);
+			std::printf("streaming to %s:%u\n", n_host.c_str(), n_port);
+		}
+
+		/************************************************************************/
+		/* DTrack2 command channel                                              */
+		/************************************************************************/
+		void command_loop() {
+
+			while (!s_quit) {
+				sockaddr_in peer;
+				socklen_t peer_len = sizeof(peer);
+				const int client = ::accept(m_listen, reinterpret_cast<sockaddr *>(&peer), &peer_len);
+				if (client < 0) {
+					continue;
+				}
+
+				char peer_ip[INET_ADDRSTRLEN];
+				::inet_ntop(AF_INET, &peer.sin_addr, peer_ip, sizeof(peer_ip));
+				std::printf("command channel connected from %s\n", peer_ip);
+
+				// unless told otherwise, data goes where the commands come from
+				set_destination(m_options.m_data_host.empty() ? peer_ip : m_options.m_data_host, m_options.m_data_port);
+
+				serve(client);
+				::close(client);
+
+				// a client going away stops its measurement
+				m_streaming = false;
+				std::printf("command channel closed\n");
+			}
+		}
+
+		/// commands and answers are zero terminated strings
+		void serve(const int n_client) {
+
+			std::string command;
+			char buffer[1024];
+
+			while (!s_quit) {
+				const ssize_t len = ::recv(n_client, buffer, sizeof(buffer), 0);
+				if (len <= 0) {
+					return;
+				}
+
+				for (ssize_t i = 0; i < len; i++) {
+					if (buffer[i] != '\0') {
+						command.push_back(buffer[i]);
+						continue;
+					}
+
+					const std::string answer = execute(command);
+					command.clear();
+
+					if (!answer.empty()) {
+						::send(n_client, answer.c_str(), answer.size() + 1, MSG_NOSIGNAL);
+					}
+				}
+			}
+		}
+
+		std::string execute(const std::string &n_command) {
+
+			std::istringstream in(n_command);
+			std::string prefix, verb;
+			in >> prefix >> verb;
+
+			if (prefix != "dtrack2") {
+				// DTrack1 style commands get no answer
+				return std::string();
+			}
+
+			if (verb == "tracking") {
+				std::string what;
+				in >> what;
+				if (what == "start") {
+					m_streaming = true;
+					std::printf("measurement started\n");
+					return "dtrack2 ok";
+				}
+				if (what == "stop") {
+					m_streaming = false;
+					std::printf("measurement stopped\n");
+					return "dtrack2 ok";
+				}
+				return "dtrack2 err 2 \"unknown tracking command\"";
+			}
+
+			if (verb == "set") {
+				std::string category, name, value;
+				in >> category >> name;
+				std::getline(in, value);
+				value.erase(0, value.find_first_not_of(' '));
+
+				// output destination, i.e. "set output net ch01 udp <ip> <port>"
+				if ((category == "output") && (name == "net")) {
+					std::istringstream v(value);
+					std::string channel, protocol, ip;
+					unsigned int port = 0;
+					if ((v >> channel >> protocol >> ip >> port) && (protocol == "udp")) {
+						set_destination(ip, static_cast<unsigned short>(port));
+					}
+				}
+
+				m_params[category + " " + name] = value;
+				return "dtrack2 ok";
+			}
+
+			if (verb == "get") {
+				std::string category, name;
+				in >> category >> name;
+				const auto p = m_params.find(category + " " + name);
+				if (p == m_params.end()) {
+					return "dtrack2 err 7 \"parameter not found\"";
+				}
+				return "dtrack2 set " + category + " " + name + " " + p->second;
+			}
+
+			if (verb == "getmsg") {
+				// nothing to report
+				return "dtrack2 ok";
+			}
+
+			return "dtrack2 err 1 \"unknown command\"";
+		}
+
+		/************************************************************************/
+		/* Streaming                                                            */
+		/************************************************************************/
+		void stream_loop() {
+
+			std::mt19937 random(m_options.m_seed);
+			std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+			const long period_ns = static_cast<long>(1e9 / m_options.m_rate);
+			timespec next;
+			::clock_gettime(CLOCK_MONOTONIC, &next);
+			const timespec start = next;
+
+			unsigned int frame_counter = 0;
+			unsigned long sent = 0;
+			unsigned long dropped = 0;
+			unsigned long late = 0;
+			size_t bytes = 0;
+			double report = 1.0;
+			bool warned_size = false;
+
+			while (!s_quit) {
+				next.tv_nsec += period_ns;
+				while (next.tv_nsec >= 1000000000L) {
+					next.tv_nsec -= 1000000000L;
+					next.tv_sec++;
+				}
+				::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+
+				timespec now;
+				::clock_gettime(CLOCK_MONOTONIC, &now);
+				if (elapsed(next, now) > period_ns * 1e-9) {
+					late++;
+				}
+
+				if (!m_streaming) {
+					continue;
+				}
+
+				// the controller's frame counter runs with the cameras, lost frames leave gaps
+				frame_counter++;
+				const double time = elapsed(start, next);
+
+				const std::string &frame = m_writer.frame(m_options, m_motion, frame_counter, time, time);
+				if (frame.size() > max_datagram) {
+					std::fprintf(stderr, "frame has %zu bytes, more than a datagram can take. Use fewer targets\n", frame.size());
+					return;
+				}
+				
+				if (!warned_size && (frame.size() >= sdk_buffer)) {
+					std::fprintf(stderr, "note: frame has %zu bytes, receivers with the SDK's default buffer of %zu bytes cut it off\n", frame.size(), sdk_buffer);
+					warned_size = true;
+				}
+
+				write_truth(frame_counter, time);
+
+				if ((m_options.m_drop > 0.0) && (uniform(random) < m_options.m_drop)) {
+					dropped++;
+					continue;
+				}
+
+				if (m_options.m_jitter > 0.0) {
+					const long delay_us = static_cast<long>(uniform(random) * m_options.m_jitter * 1000.0);
+					::usleep(delay_us);
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(m_destination_mutex);
+					::sendto(m_udp, frame.data(), frame.size(), 0, reinterpret_cast<const sockaddr *>(&m_destination), sizeof(m_destination));
+				}
+
+				sent++;
+				bytes = frame.size();
+
+				if (time >= report) {
+					std::printf("frame %u, %lu sent, %lu dropped, %lu late, %zu bytes per frame\n", frame_counter, sent, dropped, late, bytes);
+					std::fflush(stdout);
+					report += 1.0;
+				}
+
+				if (m_options.m_frames && (frame_counter >= m_options.m_frames)) {
+					break;
+				}
+			}
+		}
+
+		void write_truth(const unsigned int n_frame_counter, const double n_time) {
+
+			if (!m_truth) {
+				return;
+			}
+
+			// bodies only, they are what prediction is measured on
+			for (int id = 0; id < m_options.m_bodies; id++) {
+				const Pose p = m_motion.pose(id, n_time);
+				std::fprintf(m_truth, "%u,%.6f,%d,%.3f,%.3f,%.3f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f\n", 
+						n_frame_counter, n_time, id, p.m_loc[0], p.m_loc[1], p.m_loc[2],
+						p.m_rot[0], p.m_rot[1], p.m_rot[2], p.m_rot[3], p.m_rot[4], p.m_rot[5], p.m_rot[6], p.m_rot[7], p.m_rot[8]);
+			}
+		}
+
+		static double elapsed(const timespec &n_from, const timespec &n_to) {
+
+			return (n_to.tv_sec - n_from.tv_sec) + (n_to.tv_nsec - n_from.tv_nsec) * 1e-9;
+		}
+
+		const Options          &m_options;
+		MotionScript            m_motion;
+		FrameWriter             m_writer;
+
+		int                     m_udp = -1;
+		int                     m_listen = -1;
+		std::atomic<bool>       m_streaming { false };
+
+		std::mutex              m_destination_mutex;
+		sockaddr_in             m_destination;
+
+		std::map<std::string, std::string> m_params;
+		FILE                   *m_truth = nullptr;
+};
+
+}
+
+int main(int argc, char **argv) {
+
+	Options options;
+	if (!parse_options(argc, argv, options)) {
+		return 1;
+	}
+
+	::signal(SIGINT, on_signal);
+	::signal(SIGTERM, on_signal);
+
+	Emulator emulator(options);
+	if (!emulator.init()) {
+		return 1;
+	}
+
+	return emulator.run();
+}
@@ -0,0 +1,88 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// DTrack shared memory dump
+//
+// Prints what the plug-in publishes into shared memory, as an example for 
+// DTrackSharedMemoryReader.h and to check it's working.
+//
+// Build on Linux with:
+//   g++ -std=c++14 -O2 -I../../Source/DTrackPlugin/Public DTrackSharedMemoryDump.cpp -o dtrack_shm_dump -lrt
+//
+// Run with the region name given in the component.
+
+#include "DTrackSharedMemoryReader.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+int main(int argc, char **argv) {
+
+	if (argc < 2) {
+		std::fprintf(stderr, "usage: %s <region name>\n", argv[0]);
+		return 1;
+	}
+
+	FDTrackSharedMemoryReader reader;
+	if (!reader.open(argv[1])) {
+		std::fprintf(stderr, "no DTrack shared memory region '%s'\n", argv[1]);
+		return 1;
+	}
+
+	FDTrackSharedFrame frame;
+	uint64_t last = 0;
+	while (reader.is_live()) {
+		uint64_t sequence = 0;
+		if (reader.read(frame, &sequence) && (sequence != last)) {
+			if (last && (sequence != last + 1)) {
+				std::printf("# missed %llu\n", static_cast<unsigned long long>(sequence - last - 1));
+			}
+			last = sequence;
+
+			std::printf("frame %u ts %.3f bodies %u flysticks %u hands %u humans %u\n", frame.m_frame_counter, frame.m_timestamp,
+					frame.m_num_bodies, frame.m_num_flysticks, frame.m_num_hands, frame.m_num_humans);
+			for (uint32_t i = 0; i < frame.m_num_bodies; i++) {
+				const FDTrackSharedPose &pose = frame.m_bodies[i];
+				const FDTrackSharedStatus &status = frame.m_body_status[i];
+				if (!status.m_valid && (status.m_age < 0.0f)) {
+					continue;       // never seen
+				}
+
+				static const char *const states[] = { "lost", "measured", "coasted" };
+				std::printf("  body %u  %9.2f %9.2f %9.2f  %7.4f %7.4f %7.4f %7.4f  %-8s q %.2f age %.3f\n", i, 
+						pose.m_location[0], pose.m_location[1], pose.m_location[2],
+						pose.m_rotation[0], pose.m_rotation[1], pose.m_rotation[2], pose.m_rotation[3],
+						(status.m_state < 3) ? states[status.m_state] : "?", status.m_quality, status.m_age);
+			}
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	std::printf("# publisher went away\n");
+	return 0;
+}
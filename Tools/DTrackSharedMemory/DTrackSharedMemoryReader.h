@@ -0,0 +1,220 @@
+// Copyright (c) 2017, Advanced Realtime Tracking GmbH
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+// 3. Neither the name of copyright holder nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// DTrack shared memory reader
+//
+// Reads what the plug-in publishes when a component has "DTrack Shared Memory" set.
+// Header only and without dependencies besides the layout in the plug-in's 
+// Public/DTrackSharedMemory.h. Add the plug-in's Source/DTrackPlugin/Public folder 
+// to your include path.
+//
+// Usage:
+//   FDTrackSharedMemoryReader reader;
+//   if (reader.open("DTrackFrames")) {
+//     FDTrackSharedFrame frame;
+//     if (reader.read(frame)) { ... }
+//   }
+//
+// read() copies the newest frame, which is about 9 KB. To avoid that, peek() at
+// it in place and check valid() when done. If that returns false, the plug-in 
+// wrote over what you looked at and you should drop it.
+
+#pragma once
+
+#include "DTrackSharedMemory.h"
+
+#include <atomic>
+#include <cstring>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class FDTrackSharedMemoryReader {
+
+	public:
+		FDTrackSharedMemoryReader() = default;
+		FDTrackSharedMemoryReader(const FDTrackSharedMemoryReader &) = delete;
+		FDTrackSharedMemoryReader &operator=(const FDTrackSharedMemoryReader &) = delete;
+
+		~FDTrackSharedMemoryReader() {
+
+			close();
+		}
+
+		/// map the region the plug-in created under this name. False if there's none or it doesn't match
+		bool open(const char *n_name) {
+
+			close();
+
+#if defined(_WIN32)
+			m_mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, n_name);
+			if (!m_mapping) {
+				return false;
+			}
+
+			m_region = static_cast<const FDTrackSharedRegion *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, sizeof(FDTrackSharedRegion)));
+#else
+			// the engine puts names into the root of /dev/shm
+			const std::string name = std::string("/") + n_name;
+			const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+			if (fd < 0) {
+				return false;
+			}
+
+			struct stat info;
+			if ((fstat(fd, &info) == 0) && (static_cast<size_t>(info.st_size) >= sizeof(FDTrackSharedRegion))) {
+				void *address = mmap(nullptr, sizeof(FDTrackSharedRegion), PROT_READ, MAP_SHARED, fd, 0);
+				if (address != MAP_FAILED) {
+					m_region = static_cast<const FDTrackSharedRegion *>(address);
+				}
+			}
+			::close(fd);
+#endif
+
+			if (!m_region) {
+				close();
+				return false;
+			}
+
+			if ((m_region->m_magic != DTrackSharedMemory::Magic) 
+					|| (m_region->m_layout_version != DTrackSharedMemory::Version)
+					|| (m_region->m_size != sizeof(FDTrackSharedRegion))) {
+				close();
+				return false;
+			}
+
+			return true;
+		}
+
+		void close() {
+
+#if defined(_WIN32)
+			if (m_region) {
+				UnmapViewOfFile(m_region);
+			}
+			if (m_mapping) {
+				CloseHandle(m_mapping);
+				m_mapping = nullptr;
+			}
+#else
+			if (m_region) {
+				munmap(const_cast<FDTrackSharedRegion *>(m_region), sizeof(FDTrackSharedRegion));
+			}
+#endif
+			m_region = nullptr;
+		}
+
+		bool is_open() const {
+
+			return m_region != nullptr;
+		}
+
+		/// false once the plug-in stopped publishing. Reopen to follow a new session
+		bool is_live() const {
+
+			return m_region && (m_region->m_magic == DTrackSharedMemory::Magic);
+		}
+
+		/// sequence number of the newest frame, counting up from 1. 0 if none yet
+		uint64_t latest() const {
+
+			return m_region ? m_region->m_latest.load(std::memory_order_acquire) : 0;
+		}
+
+		/**
+		 * Copy the newest frame. Returns false if there's none yet or the writer 
+		 * kept overwriting it, which only happens if we're slower than two frames.
+		 * n_sequence gets the frame's sequence number to tell new frames from old.
+		 */
+		bool read(FDTrackSharedFrame &n_frame, uint64_t *n_sequence = nullptr) const {
+
+			for (int attempt = 0; attempt < 16; attempt++) {
+				uint64_t sequence = 0;
+				const FDTrackSharedFrame *frame = peek(sequence);
+				if (!frame) {
+					if (!sequence) {
+						return false;
+					}
+					continue;
+				}
+
+				std::memcpy(&n_frame, frame, sizeof(FDTrackSharedFrame));
+
+				if (valid(sequence)) {
+					if (n_sequence) {
+						*n_sequence = sequence;
+					}
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		/**
+		 * Look at the newest frame in place. Null if there's none or it's being 
+		 * overwritten right now. Call valid() with n_sequence after reading from it 
+		 * and don't trust anything you read if that returns false.
+		 */
+		const FDTrackSharedFrame *peek(uint64_t &n_sequence) const {
+
+			n_sequence = latest();
+			if (!n_sequence) {
+				return nullptr;
+			}
+
+			const FDTrackSharedSlot &slot = m_region->m_slots[n_sequence % 2];
+			if (slot.m_version.load(std::memory_order_acquire) != 2 * n_sequence) {
+				return nullptr;
+			}
+
+			return &slot.m_frame;
+		}
+
+		/// true if the frame peek() returned with this sequence is still intact
+		bool valid(const uint64_t n_sequence) const {
+
+			// reads of the frame must not move behind this
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return m_region->m_slots[n_sequence % 2].m_version.load(std::memory_order_relaxed) == 2 * n_sequence;
+		}
+
+	private:
+		const FDTrackSharedRegion *m_region = nullptr;
+#if defined(_WIN32)
+		HANDLE                     m_mapping = nullptr;
+#endif
+};